@@ -0,0 +1,137 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_CHANGETRACKING_HPP_  // NOLINT
+#define CYCLES_DETAIL_CHANGETRACKING_HPP_  // NOLINT
+
+// C++
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//
+#include <cycles/detail/TNodeData.hpp>
+#include <cycles/detail/utils.hpp>
+#include <cycles/detail/v1/TArrowV1.hpp>
+
+// =====================================
+//   change tracking of a forest
+// =====================================
+// While tracking, relation_ptr marks objects touched by op1 to op4: new
+// objects, owners of created or dropped relations, and targets of dropped
+// ones (which may die). Each object is listed once until next checkpoint
+// (see relation_pool::checkpoint_delta), where expired ones are removals.
+// Every forest derives from ChangeTracking, which also numbers objects with
+// stable ids on snapshots. Ids and marks are kept on a side table, only for
+// saved or marked objects (objects themselves carry nothing).
+
+namespace cycles {
+
+namespace detail {
+
+class ChangeTracking {
+  using XArrow = TArrowV1<TNodeData>;
+
+  // side table entry of an object (entry of an expired object is stale: its
+  // address may be taken by a new object)
+  struct Entry {
+    wptr<TNodeData> data;
+    std::uint64_t id{0};
+    bool changed{false};
+  };
+
+ public:
+  void setTrackChanges(bool b) {
+    track_changes = b;
+    if (!b) takeChanges();
+  }
+
+  bool isTrackingChanges() const { return track_changes; }
+
+  // marks object of 'arrow' and its owner (if owned)
+  void markChanged(const XArrow& arrow) {
+    if (!track_changes) return;
+    if (auto node = arrow.remote_node.lock()) markChanged(node->value);
+    markOwnerChanged(arrow);
+  }
+
+  // marks owner of 'arrow' only (new relation to an existing object)
+  void markOwnerChanged(const XArrow& arrow) {
+    if (!track_changes || !arrow.is_owned()) return;
+    if (auto owner = arrow.owned_by_node.lock()) markChanged(owner->value);
+  }
+
+  void markChanged(const sptr<TNodeData>& data) {
+    if (!track_changes || !data) return;
+    Entry& e = entryOf(data);
+    if (e.changed) return;
+    e.changed = true;
+    changes.emplace_back(data, e.id);
+  }
+
+  // objects marked since last call, with their ids when marked (marks are
+  // cleared)
+  std::vector<std::pair<wptr<TNodeData>, std::uint64_t>> takeChanges() {
+    std::vector<std::pair<wptr<TNodeData>, std::uint64_t>> taken;
+    taken.swap(changes);
+    for (auto& change : taken) {
+      auto data = change.first.lock();
+      auto it = data ? entries.find(data.get()) : entries.end();
+      if (it == entries.end()) continue;
+      it->second.changed = false;
+      // entries of objects never saved are dropped
+      if (it->second.id == 0) entries.erase(it);
+    }
+    return taken;
+  }
+
+  // stable id of 'data' on snapshots (0: never saved)
+  std::uint64_t checkpointId(const TNodeData* data) const {
+    auto it = entries.find(data);
+    if ((it == entries.end()) || it->second.data.expired()) return 0;
+    return it->second.id;
+  }
+
+  // stable id of 'data', given now (next free id) if it has none
+  std::uint64_t assignCheckpointId(const sptr<TNodeData>& data) {
+    Entry& e = entryOf(data);
+    if (e.id == 0) e.id = next_checkpoint_id++;
+    return e.id;
+  }
+
+  // 'data' gets stable 'id' (e.g., loaded from a snapshot), and ids up to it
+  // are taken
+  void setCheckpointId(const sptr<TNodeData>& data, std::uint64_t id) {
+    entryOf(data).id = id;
+    if (id >= next_checkpoint_id) next_checkpoint_id = id + 1;
+  }
+
+ private:
+  // entry of 'data', new if missing or stale (stale entries are pruned
+  // when table doubles)
+  Entry& entryOf(const sptr<TNodeData>& data) {
+    if (entries.size() >= prune_at) {
+      for (auto it = entries.begin(); it != entries.end();)
+        it = it->second.data.expired() ? entries.erase(it) : std::next(it);
+      prune_at = std::max(prune_at, 2 * entries.size());
+    }
+    Entry& e = entries[data.get()];
+    if (e.data.expired()) e = Entry{data};
+    return e;
+  }
+
+  bool track_changes{false};
+  std::vector<std::pair<wptr<TNodeData>, std::uint64_t>> changes;
+  std::uint64_t next_checkpoint_id{1};
+  std::unordered_map<const TNodeData*, Entry> entries;
+  std::size_t prune_at{1024};
+};
+
+}  // namespace detail
+
+}  // namespace cycles
+
+#endif  // CYCLES_DETAIL_CHANGETRACKING_HPP_ // NOLINT
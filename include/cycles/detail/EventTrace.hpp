@@ -0,0 +1,189 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_EVENTTRACE_HPP_  // NOLINT
+#define CYCLES_DETAIL_EVENTTRACE_HPP_  // NOLINT
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ====================================================
+// EventTrace: timestamped spans of forest operations
+// ====================================================
+// Opt-in: only compiled when CYCLES_TRACE_EVENTS is defined. Otherwise,
+// CYCLES_TRACE_SPAN(...) macros expand to nothing and hot paths are
+// unaffected.
+// - spans are recorded on a fixed-size ring buffer (oldest are overwritten)
+// - writers are lock-free: a slot is claimed by an atomic increment
+// - dump_json() writes Chrome trace format (chrome://tracing or Perfetto)
+//-----------------------------------------------
+
+namespace cycles {
+
+namespace detail {
+
+// one complete span ("X" event on Chrome trace format)
+struct TraceEvent {
+  const char* name{nullptr};  // static string
+  std::uint64_t begin_ns{0};  // since trace buffer creation
+  std::uint64_t duration_ns{0};
+  unsigned tid{0};
+  long arg{0};  // optional count (e.g., destroyed nodes)
+};
+
+class EventTraceBuffer {
+ private:
+  struct Slot {
+    // index+1 of event stored here (0 while empty or being written)
+    std::atomic<std::uint64_t> seq{0};
+    TraceEvent event;
+  };
+  std::unique_ptr<Slot[]> slots;
+  std::size_t capacity;
+  std::atomic<std::uint64_t> head{0};
+  std::atomic<bool> enabled{true};
+  std::chrono::steady_clock::time_point start;
+
+ public:
+  explicit EventTraceBuffer(std::size_t _capacity = (1u << 16))
+      : slots{new Slot[_capacity]},
+        capacity{_capacity},
+        start{std::chrono::steady_clock::now()} {}
+
+  // buffer shared by every forest
+  static EventTraceBuffer& global() {
+    static EventTraceBuffer buffer;
+    return buffer;
+  }
+
+  void setEnabled(bool e) { enabled.store(e, std::memory_order_relaxed); }
+  bool getEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+  std::size_t getCapacity() const { return capacity; }
+
+  // number of recorded events (including overwritten ones)
+  std::uint64_t getRecorded() const {
+    return head.load(std::memory_order_acquire);
+  }
+
+  std::uint64_t now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  }
+
+  // small sequential id of calling thread
+  static unsigned threadId() {
+    static std::atomic<unsigned> next{1};
+    thread_local unsigned tid = next.fetch_add(1, std::memory_order_relaxed);
+    return tid;
+  }
+
+  void record(const char* name, std::uint64_t begin_ns, std::uint64_t end_ns,
+              long arg = 0) {
+    if (!getEnabled()) return;
+    std::uint64_t idx = head.fetch_add(1, std::memory_order_acq_rel);
+    Slot& slot = slots[idx % capacity];
+    slot.seq.store(0, std::memory_order_release);
+    slot.event.name = name;
+    slot.event.begin_ns = begin_ns;
+    slot.event.duration_ns = end_ns - begin_ns;
+    slot.event.tid = threadId();
+    slot.event.arg = arg;
+    slot.seq.store(idx + 1, std::memory_order_release);
+  }
+
+  // completed events still on buffer, oldest first.
+  // Should be invoked when no span is being recorded (in-flight slots are
+  // skipped).
+  std::vector<TraceEvent> snapshot() const {
+    std::vector<TraceEvent> events;
+    std::uint64_t last = head.load(std::memory_order_acquire);
+    std::uint64_t first = (last > capacity) ? (last - capacity) : 0;
+    events.reserve(last - first);
+    for (std::uint64_t idx = first; idx < last; idx++) {
+      const Slot& slot = slots[idx % capacity];
+      if (slot.seq.load(std::memory_order_acquire) != idx + 1) continue;
+      events.push_back(slot.event);
+    }
+    return events;
+  }
+
+  // drop all events (not thread-safe with concurrent writers)
+  void clear() {
+    for (std::size_t i = 0; i < capacity; i++)
+      slots[i].seq.store(0, std::memory_order_relaxed);
+    head.store(0, std::memory_order_release);
+  }
+
+  // Chrome trace JSON ("traceEvents" array, timestamps in microseconds)
+  void dump_json(std::ostream& os) const {
+    auto events = snapshot();
+    os << "{\"traceEvents\":[";
+    for (std::size_t i = 0; i < events.size(); i++) {
+      const auto& e = events[i];
+      if (i > 0) os << ",";
+      os << "\n{\"name\":\"" << e.name << "\",\"cat\":\"cycles\",\"ph\":\"X\""
+         << ",\"ts\":" << (e.begin_ns / 1000) << "." << pad3(e.begin_ns % 1000)
+         << ",\"dur\":" << (e.duration_ns / 1000) << "."
+         << pad3(e.duration_ns % 1000) << ",\"pid\":1,\"tid\":" << e.tid
+         << ",\"args\":{\"n\":" << e.arg << "}}";
+    }
+    os << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+  }
+
+  bool dump_json(const std::string& path) const {
+    std::ofstream fout(path);
+    if (!fout) return false;
+    dump_json(fout);
+    return static_cast<bool>(fout);
+  }
+
+ private:
+  static std::string pad3(std::uint64_t v) {
+    std::string s = std::to_string(v);
+    return std::string(3 - s.size(), '0') + s;
+  }
+};
+
+// records span from construction to destruction (see CYCLES_TRACE_SPAN)
+class TraceSpan {
+ public:
+  const char* name;
+  std::uint64_t begin_ns;
+  long arg{0};
+
+  explicit TraceSpan(const char* _name)
+      : name{_name}, begin_ns{EventTraceBuffer::global().now()} {}
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  ~TraceSpan() {
+    auto& buffer = EventTraceBuffer::global();
+    buffer.record(name, begin_ns, buffer.now(), arg);
+  }
+};
+
+}  // namespace detail
+
+}  // namespace cycles
+
+// CYCLES_TRACE_SPAN(var, name): span named 'name' until end of scope
+// CYCLES_TRACE_ARG(var, value): sets count argument of span 'var'
+#ifdef CYCLES_TRACE_EVENTS
+#define CYCLES_TRACE_SPAN(var, name) ::cycles::detail::TraceSpan var{name}
+#define CYCLES_TRACE_ARG(var, value) var.arg = static_cast<long>(value)
+#else
+#define CYCLES_TRACE_SPAN(var, name)
+#define CYCLES_TRACE_ARG(var, value)
+#endif
+
+#endif  // CYCLES_DETAIL_EVENTTRACE_HPP_ // NOLINT
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_EXTERNALRELATIONS_HPP_  // NOLINT
+#define CYCLES_DETAIL_EXTERNALRELATIONS_HPP_  // NOLINT
+
+// C++
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//
+#include <cycles/detail/TNodeData.hpp>
+#include <cycles/detail/v1/TArrowV1.hpp>
+
+// =====================================
+//   cross-pool relations of a forest
+// =====================================
+// A relation owned by an object of another pool (see relation_ptr::
+// get_owned_external) holds its target through 'external_anchor', a hidden
+// root of this forest owning every node referenced from other pools. So
+// each pool is still collected on its own (cycles across pools are never
+// reclaimed). Such a relation may be dropped by the thread of the other
+// pool: it is queued, and removed by this forest on its next operation or
+// collection. Creating one changes this forest, so it must run on the
+// thread of its last operation (asserted on debug builds).
+// Every forest derives from ExternalRelations<Forest>, which creates and
+// removes relations with op1, op3 and op4 of Forest.
+
+namespace cycles {
+
+namespace detail {
+
+template <class Forest>
+class ExternalRelations {
+  using XArrow = TArrowV1<TNodeData>;
+
+ public:
+  // cross-pool relation to node of 'target' (thread of this forest only)
+  XArrow addExternal(const XArrow& target) {
+    assert(isUserThread());
+    drainExternal();
+    if (external_anchor.is_null()) {
+      external_anchor = forest().op1_addNodeToNewTree(sptr<TNodeData>{});
+      has_external.store(true, std::memory_order_release);
+    }
+    external_count++;
+    return forest().op3_weakSetOwnedBy(target, external_anchor);
+  }
+
+  // whether 'arrow' is a cross-pool relation (any thread)
+  bool isExternal(const XArrow& arrow) const {
+    if (!has_external.load(std::memory_order_acquire) || !arrow.is_owned())
+      return false;
+    const auto& a = arrow.owned_by_node;
+    const auto& b = external_anchor.remote_node;
+    return !a.owner_before(b) && !b.owner_before(a);
+  }
+
+  // queues removal of cross-pool relation 'arrow' (any thread)
+  void releaseExternal(XArrow&& arrow) {
+    std::lock_guard<std::mutex> lock{external_mutex};
+    external_released.push_back(std::move(arrow));
+    has_released.store(true, std::memory_order_release);
+  }
+
+  // removes queued cross-pool relations (thread of this forest only)
+  void drainExternal() {
+#ifndef NDEBUG
+    user_thread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+#endif
+    if (!has_released.load(std::memory_order_acquire)) return;
+    std::vector<XArrow> batch;
+    {
+      std::lock_guard<std::mutex> lock{external_mutex};
+      batch.swap(external_released);
+      has_released.store(false, std::memory_order_relaxed);
+    }
+    external_count -= static_cast<long>(batch.size());
+    for (auto& arrow : batch) forest().op4_remove(arrow);
+  }
+
+  // number of live cross-pool relations into this forest (after queued
+  // removals are drained)
+  long getExternalCount() const { return external_count; }
+
+  // hidden roots of this forest (0 or 1), left out of getForestSize
+  int externalAnchors() const {
+    return has_external.load(std::memory_order_acquire) ? 1 : 0;
+  }
+
+  // removes external anchor, if no cross-pool relation points into this
+  // forest (e.g., before it is absorbed, see relation_pool::absorb).
+  // Returns false if some relation still does. Thread of this forest only,
+  // with no relation of other pools being dropped meanwhile.
+  bool dropExternalAnchor() {
+    drainExternal();
+    if (external_count > 0) return false;
+    if (!external_anchor.is_null()) {
+      has_external.store(false, std::memory_order_release);
+      forest().op4_remove(external_anchor);
+      external_anchor = XArrow{};
+    }
+    return true;
+  }
+
+ private:
+  Forest& forest() { return static_cast<Forest&>(*this); }
+
+  // whether caller runs on thread of last operation (see drainExternal),
+  // or no operation happened yet
+  bool isUserThread() const {
+#ifndef NDEBUG
+    auto id = user_thread.load(std::memory_order_relaxed);
+    return (id == std::thread::id{}) || (id == std::this_thread::get_id());
+#else
+    return true;
+#endif
+  }
+
+  XArrow external_anchor;
+  // live relations owned by anchor (thread of this forest only)
+  long external_count{0};
+#ifndef NDEBUG
+  // thread of last operation (debug builds only)
+  std::atomic<std::thread::id> user_thread{};
+#endif
+  std::atomic<bool> has_external{false};
+  std::mutex external_mutex;
+  std::vector<XArrow> external_released;
+  std::atomic<bool> has_released{false};
+};
+
+}  // namespace detail
+
+}  // namespace cycles
+
+#endif  // CYCLES_DETAIL_EXTERNALRELATIONS_HPP_ // NOLINT
@@ -5,6 +5,7 @@
 #define CYCLES_DETAIL_IDYNOWFOREST_HPP_  // NOLINT
 
 // C++
+#include <atomic>
 #include <iostream>
 #include <map>
 #include <utility>
@@ -101,6 +102,15 @@ class IDynowForest {
   virtual DynowArrowType op5_copyNodeToNewTree(const DynowArrowType& arrow) = 0;
   // cleanup method (for pool)
   virtual void destroyAll() = 0;
+
+  // while frozen (e.g., parallel traversal of pool), operations op1 to op5
+  // are not allowed (checked by relation_ptr on debug builds)
+  std::atomic<int> frozen{0};
+  bool isFrozen() const { return frozen.load(std::memory_order_relaxed) > 0; }
+
+  // set when this forest is absorbed by another one (see
+  // relation_pool::absorb): its relations now belong to 'absorbed_by'
+  sptr<IDynowForest> absorbed_by;
 };
 
 }  // namespace detail
@@ -0,0 +1,527 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_OPTRACE_HPP_  // NOLINT
+#define CYCLES_DETAIL_OPTRACE_HPP_  // NOLINT
+
+// C++
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//
+#include <cycles/detail/TNodeData.hpp>
+#include <cycles/detail/utils.hpp>
+
+// ====================================================
+// OpTrace: record and replay of forest operations
+// ====================================================
+// RecordingForest<DOF> logs op1-op5 and collect of any forest into a compact
+// binary file (see relation_pool::start_recording), and OpTraceReplayer<DOF>
+// executes a recorded trace on any forest.
+// - nodes are numbered in order of creation (op1/op2): no user data is kept,
+//   only object size, so traces can be shared as anonymous bug reports
+// - ids of dead objects are dropped when the id map doubles, so a long
+//   recording keeps ids of about twice the live objects
+// - operations invoked during another operation (e.g., removals from
+//   destructors of collected objects) are flagged as 'nested'. Replay skips
+//   them, since replayed objects repeat them when destroyed.
+//
+// File format: magic "CYCLTRC1", followed by records with a tag byte (opcode,
+// plus 0x80 when nested) and unsigned LEB128 fields:
+//   op1: node, size          op2: node, owner, size
+//   op3: node, owner         op4: node, owner (0 is root, 1 is unknown)
+//   op5: node                collect: -
+// where node and owner ids are stored plus one (plus two for op4 owner).
+//-----------------------------------------------
+
+namespace cycles {
+
+namespace detail {
+
+enum class OpCode : std::uint8_t {
+  OP1 = 1,  // op1_addNodeToNewTree
+  OP2 = 2,  // op2_addChildStrong
+  OP3 = 3,  // op3_weakSetOwnedBy
+  OP4 = 4,  // op4_remove
+  OP5 = 5,  // op5_copyNodeToNewTree
+  COLLECT = 6
+};
+
+struct OpRecord {
+  static constexpr long ROOT = -1;     // op4 owner of unowned arrow
+  static constexpr long UNKNOWN = -2;  // node not (or no longer) identified
+
+  OpCode op{OpCode::COLLECT};
+  bool nested{false};
+  long node{UNKNOWN};
+  long owner{UNKNOWN};
+  long size{0};  // bytes of object (op1/op2)
+};
+
+class OpTraceWriter {
+ private:
+  std::ofstream out;
+
+  void putVarint(std::uint64_t v) {
+    while (v >= 0x80) {
+      out.put(static_cast<char>((v & 0x7f) | 0x80));
+      v >>= 7;
+    }
+    out.put(static_cast<char>(v));
+  }
+
+ public:
+  static constexpr const char* MAGIC = "CYCLTRC1";
+
+  bool open(const std::string& path) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write(MAGIC, 8);
+    return static_cast<bool>(out);
+  }
+
+  bool isOpen() const { return out.is_open(); }
+
+  void close() {
+    if (out.is_open()) out.close();
+  }
+
+  void write(const OpRecord& r) {
+    if (!out.is_open()) return;
+    out.put(static_cast<char>(static_cast<std::uint8_t>(r.op) |
+                              (r.nested ? 0x80 : 0)));
+    switch (r.op) {
+      case OpCode::OP1:
+        putVarint(r.node + 1);
+        putVarint(r.size);
+        break;
+      case OpCode::OP2:
+        putVarint(r.node + 1);
+        putVarint(r.owner + 1);
+        putVarint(r.size);
+        break;
+      case OpCode::OP3:
+        putVarint(r.node + 1);
+        putVarint(r.owner + 1);
+        break;
+      case OpCode::OP4:
+        putVarint(r.node + 1);
+        putVarint(r.owner + 2);
+        break;
+      case OpCode::OP5:
+        putVarint(r.node + 1);
+        break;
+      case OpCode::COLLECT:
+        break;
+    }
+  }
+};
+
+class OpTraceReader {
+ private:
+  static bool getVarint(std::istream& in, long& v) {
+    std::uint64_t result = 0;
+    int shift = 0;
+    int c = 0;
+    do {
+      c = in.get();
+      if (c == EOF || shift > 63) return false;
+      result |= static_cast<std::uint64_t>(c & 0x7f) << shift;
+      shift += 7;
+    } while (c & 0x80);
+    v = static_cast<long>(result);
+    return true;
+  }
+
+ public:
+  // reads every record of trace file. Returns false on invalid file.
+  static bool read(const std::string& path, std::vector<OpRecord>& records) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    char magic[8];
+    if (!in.read(magic, 8) ||
+        std::string(magic, 8) != std::string(OpTraceWriter::MAGIC))
+      return false;
+    int tag = 0;
+    while ((tag = in.get()) != EOF) {
+      OpRecord r;
+      r.op = static_cast<OpCode>(tag & 0x7f);
+      r.nested = (tag & 0x80) != 0;
+      bool ok = true;
+      switch (r.op) {
+        case OpCode::OP1:
+          ok = getVarint(in, r.node) && getVarint(in, r.size);
+          r.node--;
+          break;
+        case OpCode::OP2:
+          ok = getVarint(in, r.node) && getVarint(in, r.owner) &&
+               getVarint(in, r.size);
+          r.node--;
+          r.owner--;
+          break;
+        case OpCode::OP3:
+          ok = getVarint(in, r.node) && getVarint(in, r.owner);
+          r.node--;
+          r.owner--;
+          break;
+        case OpCode::OP4:
+          ok = getVarint(in, r.node) && getVarint(in, r.owner);
+          r.node--;
+          r.owner -= 2;
+          break;
+        case OpCode::OP5:
+          ok = getVarint(in, r.node);
+          r.node--;
+          break;
+        case OpCode::COLLECT:
+          break;
+        default:
+          return false;
+      }
+      if (!ok) return false;
+      records.push_back(r);
+    }
+    return true;
+  }
+};
+
+// forest that logs every operation of DOF (see relation_pool::start_recording)
+template <class DOF>
+class RecordingForest : public DOF {
+ public:
+  using Arrow = typename DOF::DynowArrowType;
+  using Data = typename DOF::DynowDataType;
+
+ private:
+  OpTraceWriter writer;
+  struct IdEntry {
+    long id;
+    wptr<TNodeData> data;  // expired when object dies
+  };
+  // node ids by object (data is shared by every node copy of an object)
+  std::unordered_map<const TNodeData*, IdEntry> ids;
+  long next_id{0};
+  // size of 'ids' that triggers removal of dead objects
+  std::size_t prune_at{1024};
+  // operations in progress (records inside others are nested)
+  int depth{0};
+
+  long newId(const Data& data) {
+    ids[data.get()] = IdEntry{next_id, data};
+    if (ids.size() >= prune_at) {
+      for (auto it = ids.begin(); it != ids.end();) {
+        if (it->second.data.expired())
+          it = ids.erase(it);
+        else
+          ++it;
+      }
+      prune_at = std::max(prune_at, 2 * ids.size());
+    }
+    return next_id++;
+  }
+
+  long idOf(const TNodeData* data) const {
+    auto it = ids.find(data);
+    return (it == ids.end()) ? OpRecord::UNKNOWN : it->second.id;
+  }
+
+  long idOf(const Arrow& arc) {
+    auto data = DOF::op0_getSharedData(arc);
+    return data ? idOf(data.get()) : OpRecord::UNKNOWN;
+  }
+
+  long ownerOf(const Arrow& arc) const {
+    if (!arc.is_owned()) return OpRecord::ROOT;
+    auto owner = arc.owned_by_node.lock();
+    return owner ? idOf(owner->value.get()) : OpRecord::UNKNOWN;
+  }
+
+  static long sizeOf(const TNodeData* data) {
+    return (data && data->type) ? static_cast<long>(data->type->size) : 0;
+  }
+
+  void record(OpCode op, long node, long owner = OpRecord::UNKNOWN,
+              long size = 0) {
+    OpRecord r;
+    r.op = op;
+    r.nested = (depth > 0);
+    r.node = node;
+    r.owner = owner;
+    r.size = size;
+    writer.write(r);
+  }
+
+ public:
+  bool open(const std::string& path) { return writer.open(path); }
+
+  void close() { writer.close(); }
+
+  bool isRecording() const { return writer.isOpen(); }
+
+  // number of objects with an id (live ones, and dead ones not yet dropped)
+  std::size_t getIdCount() const { return ids.size(); }
+
+  Arrow op1_addNodeToNewTree(Data ref) override {
+    Data data = ref;
+    depth++;
+    Arrow arc = DOF::op1_addNodeToNewTree(std::move(ref));
+    depth--;
+    if (!arc.is_null())
+      record(OpCode::OP1, newId(data), OpRecord::UNKNOWN,
+             sizeOf(data.get()));
+    return arc;
+  }
+
+  Arrow op2_addChildStrong(const Arrow& parent, Data ref) override {
+    Data data = ref;
+    long owner = idOf(parent);
+    depth++;
+    Arrow arc = DOF::op2_addChildStrong(parent, std::move(ref));
+    depth--;
+    if (!arc.is_null())
+      record(OpCode::OP2, newId(data), owner, sizeOf(data.get()));
+    return arc;
+  }
+
+  Arrow op3_weakSetOwnedBy(const Arrow& owned, const Arrow& owner) override {
+    long node = idOf(owned);
+    long owner_id = idOf(owner);
+    depth++;
+    Arrow arc = DOF::op3_weakSetOwnedBy(owned, owner);
+    depth--;
+    if (!arc.is_null()) record(OpCode::OP3, node, owner_id);
+    return arc;
+  }
+
+  // NOLINTNEXTLINE
+  void op4_remove(Arrow& arc) override {
+    // recorded before removal, so removals it causes come next
+    record(OpCode::OP4, idOf(arc), ownerOf(arc));
+    depth++;
+    DOF::op4_remove(arc);
+    depth--;
+  }
+
+  Arrow op5_copyNodeToNewTree(const Arrow& arrow) override {
+    long node = idOf(arrow);
+    depth++;
+    Arrow arc = DOF::op5_copyNodeToNewTree(arrow);
+    depth--;
+    if (!arc.is_null()) record(OpCode::OP5, node);
+    return arc;
+  }
+
+  void collect() override {
+    // automatic collections (inside other operations) are not recorded
+    if (depth == 0) record(OpCode::COLLECT, OpRecord::UNKNOWN);
+    depth++;
+    DOF::collect();
+    depth--;
+  }
+
+  // removals from destroyed objects are nested on pool cleanup
+  void destroyAll() override {
+    depth++;
+    DOF::destroyAll();
+    depth--;
+  }
+};
+
+struct ReplayStats {
+  long ops{0};         // replayed records (nested ones are not counted)
+  long skipped{0};     // removals of links not found on replay
+  long mismatches{0};  // operations that returned null arrow on replay
+};
+
+// executes recorded operations on a forest of type DOF.
+// Objects keep their outgoing links (as relation_ptr members would), and
+// release them when destroyed by forest.
+template <class DOF>
+class OpTraceReplayer {
+ public:
+  using Arrow = typename DOF::DynowArrowType;
+
+ private:
+  struct ReplayObject {
+    OpTraceReplayer* replayer;
+    long id;
+    std::vector<char> payload;
+    // links owned by this object: (node id, arrow)
+    std::vector<std::pair<long, Arrow>> out;
+
+    ReplayObject(OpTraceReplayer* _replayer, long _id, long size)
+        : replayer{_replayer}, id{_id}, payload(size) {}
+
+    ~ReplayObject() { replayer->release(this); }
+
+    friend std::ostream& operator<<(std::ostream& os,
+                                    const ReplayObject& me) {
+      os << "ReplayObject(" << me.id << ")";
+      return os;
+    }
+  };
+
+  sptr<DOF> forest;
+  std::unordered_map<long, ReplayObject*> objects;
+  // some arrow of each node (copy, only used as locator)
+  std::unordered_map<long, Arrow> locator;
+  std::unordered_map<long, Arrow> owned_locator;
+  // unowned arrows (as local variables of recorded program)
+  std::unordered_map<long, std::vector<Arrow>> roots;
+  bool closing{false};
+
+  void release(ReplayObject* obj) {
+    if (!closing) {
+      for (auto& [id, arc] : obj->out)
+        if (!arc.is_null()) forest->op4_remove(arc);
+    }
+    obj->out.clear();
+    objects.erase(obj->id);
+    locator.erase(obj->id);
+    owned_locator.erase(obj->id);
+  }
+
+  const Arrow* find(long id, bool prefer_owned = false) const {
+    if (prefer_owned) {
+      auto it = owned_locator.find(id);
+      if (it != owned_locator.end() && !it->second.is_null())
+        return &it->second;
+    }
+    auto it = locator.find(id);
+    if (it != locator.end() && !it->second.is_null()) return &it->second;
+    auto rit = roots.find(id);
+    if (rit != roots.end())
+      for (const auto& arc : rit->second)
+        if (!arc.is_null()) return &arc;
+    return nullptr;
+  }
+
+  sptr<TNodeData> makeData(long id, long size) {
+    auto* obj = new ReplayObject{this, id, size};  // NOLINT
+    objects[id] = obj;
+    return TNodeData::make_sptr(obj);
+  }
+
+ public:
+  explicit OpTraceReplayer(sptr<DOF> _forest) : forest{std::move(_forest)} {}
+
+  ~OpTraceReplayer() {
+    finish();
+    closing = true;
+    forest->destroyAll();
+  }
+
+  // number of replayed objects still alive
+  long getLiveObjects() const { return static_cast<long>(objects.size()); }
+
+  ReplayStats replay(const std::vector<OpRecord>& records) {
+    ReplayStats stats;
+    for (const auto& r : records) {
+      if (r.nested) continue;
+      stats.ops++;
+      switch (r.op) {
+        case OpCode::OP1: {
+          Arrow arc = forest->op1_addNodeToNewTree(makeData(r.node, r.size));
+          locator[r.node] = arc;
+          roots[r.node].push_back(std::move(arc));
+          break;
+        }
+        case OpCode::OP2: {
+          const Arrow* parent = find(r.owner);
+          auto obj = objects.find(r.owner);
+          if (!parent || obj == objects.end()) {
+            stats.mismatches++;
+            break;
+          }
+          Arrow arc = forest->op2_addChildStrong(*parent,
+                                                 makeData(r.node, r.size));
+          locator[r.node] = arc;
+          owned_locator[r.node] = arc;
+          obj->second->out.emplace_back(r.node, std::move(arc));
+          break;
+        }
+        case OpCode::OP3: {
+          const Arrow* owned = find(r.node);
+          const Arrow* owner = find(r.owner);
+          auto obj = objects.find(r.owner);
+          Arrow arc;
+          if (owned && owner && obj != objects.end())
+            arc = forest->op3_weakSetOwnedBy(*owned, *owner);
+          if (arc.is_null()) {
+            stats.mismatches++;
+            break;
+          }
+          owned_locator[r.node] = arc;
+          obj->second->out.emplace_back(r.node, std::move(arc));
+          break;
+        }
+        case OpCode::OP4:
+          if (!remove(r.node, r.owner)) stats.skipped++;
+          break;
+        case OpCode::OP5: {
+          const Arrow* source = find(r.node, true);
+          Arrow arc;
+          if (source) arc = forest->op5_copyNodeToNewTree(*source);
+          if (arc.is_null()) {
+            stats.mismatches++;
+            break;
+          }
+          roots[r.node].push_back(std::move(arc));
+          break;
+        }
+        case OpCode::COLLECT:
+          forest->collect();
+          break;
+      }
+    }
+    return stats;
+  }
+
+  // drops remaining unowned arrows and collects
+  void finish() {
+    auto pending = std::move(roots);
+    roots.clear();
+    for (auto& [id, arrows] : pending)
+      for (auto& arc : arrows)
+        if (!arc.is_null()) forest->op4_remove(arc);
+    forest->collect();
+  }
+
+ private:
+  bool remove(long node, long owner) {
+    if (owner == OpRecord::ROOT) {
+      auto it = roots.find(node);
+      if (it == roots.end() || it->second.empty()) return false;
+      Arrow arc = std::move(it->second.back());
+      it->second.pop_back();
+      if (it->second.empty()) roots.erase(it);
+      if (!arc.is_null()) forest->op4_remove(arc);
+      return true;
+    }
+    auto obj = objects.find(owner);
+    if (obj == objects.end()) return false;
+    auto& out = obj->second->out;
+    for (std::size_t i = 0; i < out.size(); i++) {
+      if (out[i].first != node) continue;
+      Arrow arc = std::move(out[i].second);
+      out[i] = std::move(out.back());
+      out.pop_back();
+      if (!arc.is_null()) forest->op4_remove(arc);
+      return true;
+    }
+    return false;
+  }
+};
+
+}  // namespace detail
+
+}  // namespace cycles
+
+#endif  // CYCLES_DETAIL_OPTRACE_HPP_ // NOLINT
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_PAUSEHISTOGRAM_HPP_  // NOLINT
+#define CYCLES_DETAIL_PAUSEHISTOGRAM_HPP_  // NOLINT
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// ====================================================
+// PauseHistogram: log-bucketed histogram of pauses
+// ====================================================
+// Durations (nanoseconds) are counted on buckets of 8 linear steps per power
+// of two, so a percentile is known within 12.5% of its value, with constant
+// memory (buckets are only allocated on first sample). Exact count, total,
+// min and max are also kept.
+//-----------------------------------------------
+
+namespace cycles {
+
+namespace detail {
+
+class PauseHistogram {
+ public:
+  static constexpr int SUB_BITS = 3;
+  static constexpr long SUB = 1L << SUB_BITS;
+  static constexpr int BUCKETS = 64 * SUB;
+
+ private:
+  std::vector<long> counts;
+  long samples{0};
+  long total_ns{0};
+  long min_ns{0};
+  long max_ns{0};
+
+ public:
+  void record(long ns) {
+    if (ns < 0) ns = 0;
+    if (counts.empty()) counts.resize(BUCKETS, 0);
+    counts[bucketOf(ns)]++;
+    min_ns = (samples == 0) ? ns : std::min(min_ns, ns);
+    max_ns = std::max(max_ns, ns);
+    samples++;
+    total_ns += ns;
+  }
+
+  // records time elapsed since 'begin'
+  void recordSince(std::chrono::steady_clock::time_point begin) {
+    record(static_cast<long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin)
+            .count()));
+  }
+
+  long count() const { return samples; }
+  long totalNs() const { return total_ns; }
+  long minNs() const { return min_ns; }
+  long maxNs() const { return max_ns; }
+  double meanNs() const {
+    return samples > 0 ? static_cast<double>(total_ns) / samples : 0.0;
+  }
+
+  // smallest recorded bound with at least fraction 'q' of samples below it
+  // (upper bound of bucket, never above max). Zero if empty.
+  long percentileNs(double q) const {
+    if (samples == 0) return 0;
+    long rank = static_cast<long>(q * samples);
+    if (rank >= samples) rank = samples - 1;
+    long seen = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+      seen += counts[b];
+      if (seen > rank) return std::min(upperBound(b), max_ns);
+    }
+    return max_ns;
+  }
+
+  long p50Ns() const { return percentileNs(0.50); }
+  long p99Ns() const { return percentileNs(0.99); }
+  long p999Ns() const { return percentileNs(0.999); }
+
+  void merge(const PauseHistogram& other) {
+    if (other.samples == 0) return;
+    if (counts.empty()) counts.resize(BUCKETS, 0);
+    for (int b = 0; b < BUCKETS; b++) counts[b] += other.counts[b];
+    min_ns = (samples == 0) ? other.min_ns : std::min(min_ns, other.min_ns);
+    max_ns = std::max(max_ns, other.max_ns);
+    samples += other.samples;
+    total_ns += other.total_ns;
+  }
+
+  // starts a new interval (buckets are kept allocated)
+  void reset() {
+    std::fill(counts.begin(), counts.end(), 0);
+    samples = 0;
+    total_ns = 0;
+    min_ns = 0;
+    max_ns = 0;
+  }
+
+  // bucket of 'v': exact below SUB, then SUB steps per power of two
+  static int bucketOf(long v) {
+    if (v < SUB) return static_cast<int>(v);
+    int e = SUB_BITS;
+    while ((v >> (e + 1)) != 0) e++;
+    long sub = (v >> (e - SUB_BITS)) & (SUB - 1);
+    return static_cast<int>((e - SUB_BITS + 1) * SUB + sub);
+  }
+
+  static long lowerBound(int b) {
+    if (b < SUB) return b;
+    int e = static_cast<int>(b / SUB) + SUB_BITS - 1;
+    return (SUB + b % SUB) << (e - SUB_BITS);
+  }
+
+  static long upperBound(int b) {
+    if (b < SUB) return b;
+    int e = static_cast<int>(b / SUB) + SUB_BITS - 1;
+    return lowerBound(b) + (1L << (e - SUB_BITS)) - 1;
+  }
+};
+
+// pause histograms of a forest (see DynowForestV1::getPauseStats)
+struct PauseStats {
+  // every collection run: collect(), or destroy_pending and trace_deferred
+  // started by forest itself (nested runs are part of outermost one)
+  PauseHistogram collect;
+  // every op4_remove that triggered auto collect (sum of its collection
+  // runs; removals that collect nothing are not timed)
+  PauseHistogram remove;
+};
+
+}  // namespace detail
+
+}  // namespace cycles
+
+#endif  // CYCLES_DETAIL_PAUSEHISTOGRAM_HPP_ // NOLINT
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_REACHABLEFOREST_HPP_  // NOLINT
+#define CYCLES_DETAIL_REACHABLEFOREST_HPP_  // NOLINT
+
+// C++
+#include <utility>
+#include <vector>
+
+//
+#include <cycles/detail/TNodeData.hpp>
+#include <cycles/detail/WorkStealing.hpp>
+#include <cycles/detail/v1/TArrowV1.hpp>
+#include <cycles/detail/v1/TNodeV1.hpp>
+
+// =====================================
+//   traversals shared by every forest
+// =====================================
+// Every forest derives from ReachableForest (besides IDynowForest), so
+// traversals over owned relations of its nodes are written once. Forests
+// take their own marks from visit_epoch too, so marks never collide.
+// Parallel traversal lives here (not on TNodeHelper), so only forests need
+// threads.
+
+namespace cycles {
+
+namespace detail {
+
+class ReachableForest {
+ protected:
+  // epoch of last traversal or mark of this forest
+  unsigned visit_epoch{0};
+  // stack of traversals (kept, so traversals do not allocate)
+  TNodeHelper<>::VisitStack visit_stack;
+
+ public:
+  // calls f(node) once for every node reachable from node of 'arrow' (see
+  // TNodeHelper::visitReachable). f must not change relations, nor start
+  // another traversal on this forest.
+  template <class F>
+  void forEachReachable(const TArrowV1<TNodeData>& arrow, F&& f) {
+    auto root = arrow.remote_node.lock();
+    TNodeHelper<>::visitReachable(root.get(), ++visit_epoch, visit_stack, f);
+  }
+
+  // forEachReachable on 'threads' workers (see parallelVisitReachable): f is
+  // called concurrently.
+  template <class F>
+  void parallelForEachReachable(const TArrowV1<TNodeData>& arrow, int threads,
+                                const F& f) {
+    auto root = arrow.remote_node.lock();
+    parallelVisitReachable(root.get(), ++visit_epoch, threads, f);
+  }
+
+  // whether node of 'from' reaches node of 'to' over owned relations (see
+  // TNodeHelper::findOwner)
+  Reachability getReachability(const TArrowV1<TNodeData>& from,
+                               const TArrowV1<TNodeData>& to,
+                               long max_visits = 0) {
+    auto source = from.remote_node.lock();
+    auto target = to.remote_node.lock();
+    if (!source || !target) return Reachability::UNREACHABLE;
+    return TNodeHelper<>::findOwner(target.get(), source->value.get(),
+                                    ++visit_epoch, visit_stack, max_visits);
+  }
+
+ private:
+  // Same as TNodeHelper::visitReachable, on 'threads' workers (see
+  // workStealingRun): f is called concurrently, and nodes are claimed by an
+  // atomic exchange of 'claim' to 'epoch'. Forest must not be changed during
+  // the traversal.
+  template <class F>
+  static void parallelVisitReachable(TNode<TNodeData>* root, unsigned epoch,
+                                     int threads, const F& f) {
+    using Item = std::pair<TNode<TNodeData>*, const TNodeData*>;
+    if (!root) return;
+    root->claim.store(epoch, std::memory_order_relaxed);
+    auto claimed = [epoch](TNode<TNodeData>* node) {
+      return node->claim.exchange(epoch, std::memory_order_relaxed) != epoch;
+    };
+    auto expand = [&](const Item& item, std::vector<Item>& out) {
+      auto [node, from] = item;
+      const TNodeData* value = node->value.get();
+      if (value != from) f(*node);
+      for (auto it = node->owns.rbegin(); it != node->owns.rend(); ++it) {
+        TNode<TNodeData>* owned = it->lock().get();
+        if (owned && claimed(owned)) out.emplace_back(owned, nullptr);
+      }
+      for (auto it = node->children.rbegin(); it != node->children.rend();
+           ++it) {
+        TNode<TNodeData>* child = it->get();
+        if (claimed(child)) out.emplace_back(child, value);
+      }
+    };
+    workStealingRun<Item>({Item{root, nullptr}}, threads, expand);
+  }
+};
+
+}  // namespace detail
+
+}  // namespace cycles
+
+#endif  // CYCLES_DETAIL_REACHABLEFOREST_HPP_ // NOLINT
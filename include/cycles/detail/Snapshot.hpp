@@ -0,0 +1,419 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_SNAPSHOT_HPP_  // NOLINT
+#define CYCLES_DETAIL_SNAPSHOT_HPP_  // NOLINT
+
+// C++
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CYCLES_SNAPSHOT_MMAP 1
+#endif
+
+// ====================================================
+// Snapshot: binary image of an object graph
+// ====================================================
+// SnapshotWriter stores objects numbered 0..n-1 (0 is root), the relations
+// held by each of them (in user order), their stable ids and one fixed-size
+// payload per object (see relation_pool::save_snapshot). SnapshotImage maps
+// the file in memory (read-only mmap on POSIX, or a plain read elsewhere)
+// and exposes every section in place, so loading does not copy or parse
+// anything after validation (see relation_pool::load_snapshot).
+// SnapshotDelta holds changes since a snapshot, by stable id (see
+// relation_pool::checkpoint_delta), and compactSnapshot folds deltas into a
+// new snapshot.
+//
+// File format (native byte order, checked on load), sections are aligned to
+// 64 bytes and addressed by offsets from file start:
+//   header: SnapshotHeader
+//   offsets: uint64 [nodes + 1], relations of object i are targets
+//            [offsets[i], offsets[i+1])
+//   targets: uint32 [links], index of owned object of each relation
+//   ids: uint64 [nodes], stable id of each object (never 0)
+//   payload: payload_size bytes [nodes]
+//-----------------------------------------------
+
+namespace cycles {
+
+namespace detail {
+
+struct SnapshotHeader {
+  static constexpr const char* MAGIC = "CYCLSNP2";
+  static constexpr std::uint32_t ENDIAN_MARK = 0x01020304;
+
+  char magic[8];
+  std::uint32_t byte_order;
+  std::uint32_t payload_size;
+  std::uint64_t payload_align;
+  std::uint64_t nodes;
+  std::uint64_t links;
+  std::uint64_t offsets_at;
+  std::uint64_t targets_at;
+  std::uint64_t ids_at;
+  std::uint64_t payload_at;
+  std::uint64_t file_size;
+};
+
+class SnapshotWriter {
+ public:
+  static constexpr std::uint64_t ALIGN = 64;
+
+  static std::uint64_t alignUp(std::uint64_t at) {
+    return (at + ALIGN - 1) / ALIGN * ALIGN;
+  }
+
+  // writes snapshot file at 'path' ('ids' and 'payload' have one entry per
+  // object, payload of 'payload_size' bytes). Returns false if file cannot
+  // be written.
+  static bool write(const std::string& path,
+                    const std::vector<std::uint64_t>& offsets,
+                    const std::vector<std::uint32_t>& targets,
+                    const std::vector<std::uint64_t>& ids,
+                    const void* payload, std::size_t payload_size,
+                    std::size_t payload_align) {
+    SnapshotHeader h{};
+    std::memcpy(h.magic, SnapshotHeader::MAGIC, 8);
+    h.byte_order = SnapshotHeader::ENDIAN_MARK;
+    h.payload_size = static_cast<std::uint32_t>(payload_size);
+    h.payload_align = payload_align;
+    h.nodes = offsets.size() - 1;
+    h.links = targets.size();
+    h.offsets_at = alignUp(sizeof(SnapshotHeader));
+    h.targets_at = alignUp(h.offsets_at + offsets.size() * 8);
+    h.ids_at = alignUp(h.targets_at + targets.size() * 4);
+    h.payload_at = alignUp(h.ids_at + ids.size() * 8);
+    h.file_size = h.payload_at + h.nodes * payload_size;
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    std::uint64_t at = 0;
+    auto put = [&](std::uint64_t section, const void* data, std::size_t n) {
+      static const char zeros[ALIGN] = {};
+      out.write(zeros, static_cast<std::streamsize>(section - at));
+      out.write(static_cast<const char*>(data),
+                static_cast<std::streamsize>(n));
+      at = section + n;
+    };
+    put(0, &h, sizeof(h));
+    put(h.offsets_at, offsets.data(), offsets.size() * 8);
+    put(h.targets_at, targets.data(), targets.size() * 4);
+    put(h.ids_at, ids.data(), ids.size() * 8);
+    put(h.payload_at, payload, h.nodes * payload_size);
+    out.close();
+    return static_cast<bool>(out);
+  }
+};
+
+// read-only view of a snapshot file (not copyable)
+class SnapshotImage {
+ private:
+  const char* base{nullptr};
+  std::size_t length{0};
+  bool mapped{false};
+  std::vector<std::uint64_t> buffer;  // file contents, when not mapped
+
+  // sections are in file, relations refer to existing objects, and each
+  // object has its own stable id
+  bool validate() const {
+    if (length < sizeof(SnapshotHeader)) return false;
+    const SnapshotHeader& h = header();
+    if ((std::memcmp(h.magic, SnapshotHeader::MAGIC, 8) != 0) ||
+        (h.byte_order != SnapshotHeader::ENDIAN_MARK) ||
+        (h.file_size != length) || (h.nodes == 0) ||
+        (h.nodes >= UINT32_MAX))
+      return false;
+    auto fits = [&](std::uint64_t at, std::uint64_t count, std::uint64_t n) {
+      return (at % SnapshotWriter::ALIGN == 0) && (at <= length) &&
+             (count <= (length - at) / (n ? n : 1));
+    };
+    if (!fits(h.offsets_at, h.nodes + 1, 8) ||
+        !fits(h.targets_at, h.links, 4) || !fits(h.ids_at, h.nodes, 8) ||
+        !fits(h.payload_at, h.nodes, h.payload_size))
+      return false;
+    const std::uint64_t* first = offsets();
+    if ((first[0] != 0) || (first[h.nodes] != h.links)) return false;
+    for (std::uint64_t i = 0; i < h.nodes; i++)
+      if (first[i] > first[i + 1]) return false;
+    // objects are numbered in breadth-first order from object 0 (so each
+    // one is reachable from it): a relation may only target a known object
+    // or the next one, and relations of unknown objects are invalid
+    const std::uint32_t* t = targets();
+    std::uint64_t known = 1;
+    for (std::uint64_t i = 0; i < h.nodes; i++) {
+      if (i >= known) return false;
+      for (std::uint64_t k = first[i]; k < first[i + 1]; k++) {
+        if (t[k] > known) return false;
+        if (t[k] == known) known++;
+      }
+    }
+    if (known != h.nodes) return false;
+    // ids are never 0, and are distinct (deltas refer to objects by id)
+    const std::uint64_t* id = ids();
+    std::unordered_set<std::uint64_t> seen;
+    seen.reserve(h.nodes);
+    for (std::uint64_t i = 0; i < h.nodes; i++)
+      if ((id[i] == 0) || !seen.insert(id[i]).second) return false;
+    return true;
+  }
+
+ public:
+  SnapshotImage() = default;
+
+  SnapshotImage(const SnapshotImage&) = delete;
+
+  SnapshotImage& operator=(const SnapshotImage&) = delete;
+
+  ~SnapshotImage() { close(); }
+
+  // maps file at 'path'. Returns false if file cannot be read or is not a
+  // valid snapshot.
+  bool open(const std::string& path) {
+    close();
+#ifdef CYCLES_SNAPSHOT_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if ((::fstat(fd, &st) == 0) && (st.st_size > 0)) {
+      void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                       PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        base = static_cast<const char*>(p);
+        length = static_cast<std::size_t>(st.st_size);
+        mapped = true;
+      }
+    }
+    ::close(fd);
+    if (!mapped) return false;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    length = static_cast<std::size_t>(in.tellg());
+    buffer.resize((length + 7) / 8);
+    in.seekg(0);
+    if (!in.read(reinterpret_cast<char*>(buffer.data()),  // NOLINT
+                 static_cast<std::streamsize>(length)))
+      return false;
+    base = reinterpret_cast<const char*>(buffer.data());  // NOLINT
+#endif
+    if (validate()) return true;
+    close();
+    return false;
+  }
+
+  void close() {
+#ifdef CYCLES_SNAPSHOT_MMAP
+    if (mapped) ::munmap(const_cast<char*>(base), length);  // NOLINT
+#endif
+    mapped = false;
+    base = nullptr;
+    length = 0;
+    buffer.clear();
+  }
+
+  bool isOpen() const { return base != nullptr; }
+
+  const SnapshotHeader& header() const {
+    return *reinterpret_cast<const SnapshotHeader*>(base);  // NOLINT
+  }
+
+  const std::uint64_t* offsets() const {
+    return reinterpret_cast<const std::uint64_t*>(  // NOLINT
+        base + header().offsets_at);
+  }
+
+  const std::uint32_t* targets() const {
+    return reinterpret_cast<const std::uint32_t*>(  // NOLINT
+        base + header().targets_at);
+  }
+
+  const std::uint64_t* ids() const {
+    return reinterpret_cast<const std::uint64_t*>(  // NOLINT
+        base + header().ids_at);
+  }
+
+  const void* payload(std::uint64_t i) const {
+    return base + header().payload_at + i * header().payload_size;
+  }
+};
+
+// Changes since a snapshot or a previous delta: objects gone, and records
+// (relations and payload) of new or changed objects, all by stable id.
+// Stream format (native byte order, checked on read):
+//   magic "CYCLDLT1", then uint32 endian mark and payload size, then uint64
+//   payload align, root id and number of removed, records and links
+//   removed: uint64 [removed], ids of objects gone
+//   ids: uint64 [records], id of each recorded object
+//   offsets: uint64 [records + 1], relations of record r are targets
+//            [offsets[r], offsets[r+1])
+//   targets: uint64 [links], id of owned object of each relation
+//   payload: payload_size bytes [records]
+struct SnapshotDelta {
+  static constexpr const char* MAGIC = "CYCLDLT1";
+
+  std::uint32_t payload_size{0};
+  std::uint64_t payload_align{0};
+  std::uint64_t root{0};
+  std::vector<std::uint64_t> removed;
+  std::vector<std::uint64_t> ids;
+  std::vector<std::uint64_t> offsets{0};
+  std::vector<std::uint64_t> targets;
+  std::vector<char> payload;
+
+  bool write(std::ostream& out) const {
+    auto put = [&out](const void* data, std::size_t n) {
+      out.write(static_cast<const char*>(data),
+                static_cast<std::streamsize>(n));
+    };
+    std::uint32_t mark = SnapshotHeader::ENDIAN_MARK;
+    std::uint64_t counts[4] = {payload_align, root, removed.size(),
+                               ids.size()};
+    std::uint64_t links = targets.size();
+    put(MAGIC, 8);
+    put(&mark, 4);
+    put(&payload_size, 4);
+    put(counts, sizeof(counts));
+    put(&links, 8);
+    put(removed.data(), removed.size() * 8);
+    put(ids.data(), ids.size() * 8);
+    put(offsets.data(), offsets.size() * 8);
+    put(targets.data(), targets.size() * 8);
+    put(payload.data(), payload.size());
+    return static_cast<bool>(out);
+  }
+
+  // reads a delta written by 'write'. Returns false on invalid stream.
+  // Counts are not trusted: sections are read in bounded chunks, so a
+  // corrupt count fails at end of stream instead of allocating it upfront.
+  bool read(std::istream& in) {
+    auto get = [&in](void* data, std::size_t n) {
+      return static_cast<bool>(in.read(static_cast<char*>(data),
+                                       static_cast<std::streamsize>(n)));
+    };
+    // reads 'count' items into 'v' (at most CHUNK bytes allocated ahead)
+    auto get_items = [&get](auto& v, std::uint64_t count) {
+      constexpr std::uint64_t CHUNK = 1 << 20;
+      constexpr std::uint64_t SIZE = sizeof(v[0]);
+      v.clear();
+      while (v.size() < count) {
+        std::size_t at = v.size();
+        auto n = static_cast<std::size_t>(
+            std::min<std::uint64_t>(CHUNK / SIZE, count - at));
+        v.resize(at + n);
+        if (!get(&v[at], n * SIZE)) return false;
+      }
+      return true;
+    };
+    char magic[8];
+    std::uint32_t mark = 0;
+    std::uint64_t counts[4];
+    std::uint64_t links = 0;
+    if (!get(magic, 8) || (std::memcmp(magic, MAGIC, 8) != 0) ||
+        !get(&mark, 4) || (mark != SnapshotHeader::ENDIAN_MARK) ||
+        !get(&payload_size, 4) || !get(counts, sizeof(counts)) ||
+        !get(&links, 8))
+      return false;
+    payload_align = counts[0];
+    root = counts[1];
+    std::uint64_t records = counts[3];
+    if ((records == UINT64_MAX) ||
+        (payload_size && (records > UINT64_MAX / payload_size)))
+      return false;
+    if (!get_items(removed, counts[2]) || !get_items(ids, records) ||
+        !get_items(offsets, records + 1) || !get_items(targets, links) ||
+        !get_items(payload, records * payload_size))
+      return false;
+    if ((offsets[0] != 0) || (offsets.back() != links)) return false;
+    for (std::size_t r = 0; r < ids.size(); r++)
+      if (offsets[r] > offsets[r + 1]) return false;
+    return true;
+  }
+};
+
+// Folds 'deltas' (in order) into snapshot 'base', writing a new snapshot at
+// 'path': last record of each id wins, removed ids are dropped, and only
+// objects reachable from last root are kept (numbered again in
+// breadth-first order, with same stable ids). Returns false if payload type
+// differs, root is gone, a relation targets an unknown id, or file cannot
+// be written.
+inline bool compactSnapshot(const SnapshotImage& base,
+                            const std::vector<SnapshotDelta>& deltas,
+                            const std::string& path) {
+  const SnapshotHeader& h = base.header();
+  for (const auto& d : deltas)
+    if ((d.payload_size != h.payload_size) ||
+        (d.payload_align != h.payload_align))
+      return false;
+  // latest version of each object: on base (delta -1) or on a delta
+  struct Version {
+    long delta;
+    std::uint64_t index;
+  };
+  std::unordered_map<std::uint64_t, Version> current;
+  current.reserve(h.nodes);
+  const std::uint64_t* ids = base.ids();
+  for (std::uint64_t i = 0; i < h.nodes; i++) current[ids[i]] = {-1, i};
+  std::uint64_t root = ids[0];
+  for (std::size_t k = 0; k < deltas.size(); k++) {
+    for (std::uint64_t id : deltas[k].removed) current.erase(id);
+    for (std::uint64_t r = 0; r < deltas[k].ids.size(); r++)
+      current[deltas[k].ids[r]] = {static_cast<long>(k), r};
+    root = deltas[k].root;
+  }
+  if (current.find(root) == current.end()) return false;
+  // breadth-first from root
+  std::unordered_map<std::uint64_t, std::uint32_t> index;
+  std::vector<std::uint64_t> order{root};
+  index[root] = 0;
+  std::vector<std::uint64_t> offsets{0};
+  std::vector<std::uint32_t> targets;
+  std::vector<char> payload;
+  payload.reserve(h.nodes * h.payload_size);
+  auto add_target = [&](std::uint64_t id) {
+    if (current.find(id) == current.end()) return false;
+    auto id_index = static_cast<std::uint32_t>(order.size());
+    auto it = index.emplace(id, id_index).first;
+    if (it->second == id_index) order.push_back(id);
+    targets.push_back(it->second);
+    return true;
+  };
+  for (std::size_t i = 0; i < order.size(); i++) {
+    if (order.size() >= UINT32_MAX) return false;
+    Version v = current.at(order[i]);
+    const char* bytes = nullptr;
+    if (v.delta < 0) {
+      const std::uint64_t* first = base.offsets();
+      const std::uint32_t* t = base.targets();
+      for (std::uint64_t k = first[v.index]; k < first[v.index + 1]; k++)
+        if (!add_target(ids[t[k]])) return false;
+      bytes = static_cast<const char*>(base.payload(v.index));
+    } else {
+      const SnapshotDelta& d = deltas[v.delta];
+      for (std::uint64_t k = d.offsets[v.index]; k < d.offsets[v.index + 1];
+           k++)
+        if (!add_target(d.targets[k])) return false;
+      bytes = d.payload.data() + v.index * d.payload_size;
+    }
+    payload.insert(payload.end(), bytes, bytes + h.payload_size);
+    offsets.push_back(targets.size());
+  }
+  return SnapshotWriter::write(path, offsets, targets, order, payload.data(),
+                               h.payload_size, h.payload_align);
+}
+
+}  // namespace detail
+
+}  // namespace cycles
+
+#endif  // CYCLES_DETAIL_SNAPSHOT_HPP_ // NOLINT
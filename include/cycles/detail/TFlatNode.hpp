@@ -0,0 +1,49 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_TFLATNODE_HPP_  // NOLINT
+#define CYCLES_DETAIL_TFLATNODE_HPP_  // NOLINT
+
+// C++
+#include <cstddef>
+
+//
+#include <cycles/detail/TNodeData.hpp>
+#include <cycles/detail/utils.hpp>
+#include <cycles/detail/v1/TNodeV1.hpp>
+
+// =====================================
+//   node of a flat forest
+// =====================================
+// Flat forests (DynowForestTrace, DynowForestRC) keep every node on a pool
+// vector, and need its position there. Every node they create is a
+// TFlatNode, so a TNode of such forest may be downcast with flatSlot().
+
+namespace cycles {
+
+namespace detail {
+
+template <typename T = TNodeData>
+class TFlatNode : public TNode<T> {
+ public:
+  using TNode<T>::TNode;
+  // position of this node on the pool of its flat forest
+  std::size_t slot{0};
+};
+
+// position of 'node' on pool of its flat forest (node must be a TFlatNode)
+template <typename T>
+std::size_t& flatSlot(TNode<T>* node) {
+  return static_cast<TFlatNode<T>*>(node)->slot;
+}
+
+template <typename T>
+std::size_t& flatSlot(const sptr<TNode<T>>& node) {
+  return flatSlot(node.get());
+}
+
+}  // namespace detail
+
+}  // namespace cycles
+
+#endif  // CYCLES_DETAIL_TFLATNODE_HPP_ // NOLINT
@@ -5,9 +5,15 @@
 #define CYCLES_TNODEDATA_HPP_  // NOLINT
 
 // C++
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
+#include <typeinfo>
 #include <utility>
 #include <vector>
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
 // C++ HELPER ONLY
 #include <memory>   // JUST FOR HELPER is_shared_ptr??
 #include <sstream>  // just for value_to_string ??
@@ -36,6 +42,56 @@ namespace cycles {
 
 namespace detail {
 
+// TypeDescriptor: one per type T stored on TNodeData (registered on first
+// use), counting live objects of T in all pools.
+struct TypeDescriptor {
+  std::string name;
+  std::size_t size{0};
+  mutable std::atomic<long> live{0};
+  // next registered descriptor
+  const TypeDescriptor* next{nullptr};
+
+  TypeDescriptor(std::string _name, std::size_t _size)
+      : name{std::move(_name)}, size{_size} {
+    // lock-free push on registry list
+    next = head().load(std::memory_order_relaxed);
+    while (!head().compare_exchange_weak(next, this, std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+    }
+  }
+
+  TypeDescriptor(const TypeDescriptor&) = delete;
+  TypeDescriptor& operator=(const TypeDescriptor&) = delete;
+
+  long getLive() const { return live.load(std::memory_order_relaxed); }
+  long getBytes() const { return getLive() * static_cast<long>(size); }
+
+  template <class T>
+  static const TypeDescriptor* of() {
+    static TypeDescriptor desc{demangle(typeid(T).name()), sizeof(T)};
+    return &desc;
+  }
+
+  // first registered descriptor (others follow 'next')
+  static std::atomic<const TypeDescriptor*>& head() {
+    static std::atomic<const TypeDescriptor*> first{nullptr};
+    return first;
+  }
+
+  static std::string demangle(const char* mangled) {
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    char* real = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    if (status == 0 && real) {
+      std::string name{real};
+      std::free(real);  // NOLINT
+      return name;
+    }
+#endif
+    return std::string{mangled};
+  }
+};
+
 // TNodeData is inspired by Herb Sutter's gcpp 'struct destructor{...}'
 // It uses lambda functions to perform type erasure
 
@@ -45,6 +101,8 @@ class TNodeData {
   const void* p;
   // raw pointer to a type-erased destructor function
   void (*destroy)(const void*);
+  // descriptor of type (live counts), if known
+  const TypeDescriptor* type{nullptr};
 
 #ifdef CYCLES_TOSTRING
   // debug only: raw pointer to a type-erased toString function
@@ -66,18 +124,34 @@ class TNodeData {
   // move is allowed
 #ifdef CYCLES_TOSTRING
   TNodeData(TNodeData&& corpse) noexcept
-      : p{corpse.p}, destroy{corpse.destroy}, toString{corpse.toString} {}
+      : p{corpse.p},
+        destroy{corpse.destroy},
+        type{corpse.type},
+        toString{corpse.toString} {
+    corpse.p = nullptr;
+  }
 #else
   TNodeData(TNodeData&& corpse) noexcept
-      : p{corpse.p}, destroy{corpse.destroy} {}
+      : p{corpse.p}, destroy{corpse.destroy}, type{corpse.type} {
+    corpse.p = nullptr;
+  }
 #endif
 
   ~TNodeData() {
     // std::cout << "~TNodeData(" << toString(p) << ")" << std::endl;
+    if (p && type)
+      type->live.fetch_sub(1, std::memory_order_relaxed);
     destroy(p);
     p = 0;
   }
 
+  template <class T>
+  void setType() {
+    type = TypeDescriptor::of<T>();
+    if (p)
+      type->live.fetch_add(1, std::memory_order_relaxed);
+  }
+
   friend std::ostream& operator<<(std::ostream& os, const TNodeData& me) {
 #ifdef CYCLES_TOSTRING
     os << "TNodeData(" << me.toString(me.p) << ")";
@@ -113,6 +187,7 @@ class TNodeData {
                    }
 #endif
     };
+    data.template setType<T>();
     return data;
   }
 
@@ -152,7 +227,7 @@ class TNodeData {
                                  }
 #endif
       };
-
+      data->template setType<T>();
       return sptr<TNodeData>{data};
     }
   }
@@ -0,0 +1,217 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_WORKSTEALING_HPP_  // NOLINT
+#define CYCLES_DETAIL_WORKSTEALING_HPP_  // NOLINT
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ====================================================
+// work stealing: depth-first work list on many threads
+// ====================================================
+// Each worker processes items from a private stack. When its stack grows and
+// its shared deque is empty, older half of stack (closer to where traversal
+// started, so usually more work) is moved to that deque. An idle worker first
+// takes a batch from its own deque, then steals half of the deque of another
+// worker. Deques are locked, but only once per batch of items.
+//-----------------------------------------------
+
+namespace cycles {
+
+namespace detail {
+
+// shared part of work of a worker: owner takes from back, thieves from front
+template <class Item>
+class WorkStealingDeque {
+ public:
+  void pushBatch(Item* first, std::size_t n) {
+    std::lock_guard<std::mutex> lock{mutex};
+    for (std::size_t i = 0; i < n; i++) items.push_back(std::move(first[i]));
+    count.store(items.size(), std::memory_order_relaxed);
+  }
+
+  // owner: moves up to 'max' items from back to 'out'. Returns moved items.
+  std::size_t popBatch(std::vector<Item>& out, std::size_t max) {
+    if (size() == 0) return 0;
+    std::lock_guard<std::mutex> lock{mutex};
+    std::size_t n = std::min(max, items.size());
+    for (std::size_t i = 0; i < n; i++) {
+      out.push_back(std::move(items.back()));
+      items.pop_back();
+    }
+    count.store(items.size(), std::memory_order_relaxed);
+    return n;
+  }
+
+  // thief: moves half (at least one) of items from front to 'out'
+  std::size_t steal(std::vector<Item>& out) {
+    if (size() == 0) return 0;
+    std::lock_guard<std::mutex> lock{mutex};
+    std::size_t n = (items.size() + 1) / 2;
+    for (std::size_t i = 0; i < n; i++) {
+      out.push_back(std::move(items.front()));
+      items.pop_front();
+    }
+    count.store(items.size(), std::memory_order_relaxed);
+    return n;
+  }
+
+  // number of items (may be outdated when read without lock)
+  std::size_t size() const { return count.load(std::memory_order_relaxed); }
+
+ private:
+  std::mutex mutex;
+  std::deque<Item> items;
+  std::atomic<std::size_t> count{0};
+};
+
+// Threads kept between runs (e.g., one mark phase per collection), so a run
+// does not pay for thread creation. The calling thread is worker 0, and
+// runs must not overlap.
+class WorkerPool {
+ public:
+  explicit WorkerPool(int threads) {
+    for (int t = 1; t < threads; t++)
+      workers.emplace_back([this, t]() { loop(t); });
+  }
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      stop = true;
+    }
+    wake.notify_all();
+    for (auto& w : workers) w.join();
+  }
+
+  // number of workers (including calling thread)
+  int size() const { return static_cast<int>(workers.size()) + 1; }
+
+  // calls job(id) once on every worker 'id', returning when all are done
+  void run(const std::function<void(int)>& job) {
+    if (workers.empty()) {
+      job(0);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      current = &job;
+      pending = static_cast<int>(workers.size());
+      generation++;
+    }
+    wake.notify_all();
+    job(0);
+    std::unique_lock<std::mutex> lock{mutex};
+    done.wait(lock, [this]() { return pending == 0; });
+    current = nullptr;
+  }
+
+ private:
+  void loop(int id) {
+    unsigned seen = 0;
+    while (true) {
+      const std::function<void(int)>* job = nullptr;
+      {
+        std::unique_lock<std::mutex> lock{mutex};
+        wake.wait(lock, [&]() { return stop || (generation != seen); });
+        if (stop) return;
+        seen = generation;
+        job = current;
+      }
+      (*job)(id);
+      std::lock_guard<std::mutex> lock{mutex};
+      if (--pending == 0) done.notify_one();
+    }
+  }
+
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  const std::function<void(int)>* current{nullptr};
+  int pending{0};
+  unsigned generation{0};
+  bool stop{false};
+};
+
+// Processes 'roots', and every item they discover, on workers of 'pool'.
+// expand(item, out) processes 'item' and appends new items to 'out' (it must
+// be safe to call concurrently, and each item must be appended once, e.g.,
+// after claiming it with an atomic mark). Returns when all workers are idle
+// and all deques are empty.
+template <class Item, class Expand>
+void workStealingRun(std::vector<Item> roots, WorkerPool& pool,
+                     const Expand& expand) {
+  constexpr std::size_t GRAIN = 64;
+  int threads = pool.size();
+  std::unique_ptr<WorkStealingDeque<Item>[]> deques{
+      new WorkStealingDeque<Item>[threads]};
+  for (std::size_t i = 0; i < roots.size(); i++)
+    deques[i % threads].pushBatch(&roots[i], 1);
+  // a worker is idle only when its stack and its deque are empty, and only
+  // the owner fills a deque: when all are idle, no work is left
+  std::atomic<int> idle{0};
+  auto worker = [&](int id) {
+    std::vector<Item> local;
+    auto& own = deques[id];
+    while (true) {
+      if (local.empty() && (own.popBatch(local, GRAIN) == 0)) {
+        bool found = false;
+        for (int k = 1; (k < threads) && !found; k++)
+          found = deques[(id + k) % threads].steal(local) > 0;
+        if (!found) {
+          idle.fetch_add(1, std::memory_order_acq_rel);
+          while (true) {
+            if (idle.load(std::memory_order_acquire) == threads) return;
+            bool any = false;
+            for (int k = 0; (k < threads) && !any; k++)
+              any = deques[k].size() > 0;
+            if (any) {
+              idle.fetch_sub(1, std::memory_order_acq_rel);
+              break;
+            }
+            std::this_thread::yield();
+          }
+          continue;
+        }
+      }
+      Item item = std::move(local.back());
+      local.pop_back();
+      expand(item, local);
+      if ((threads > 1) && (local.size() > 2 * GRAIN) && (own.size() == 0)) {
+        std::size_t half = local.size() / 2;
+        own.pushBatch(local.data(), half);
+        local.erase(local.begin(), local.begin() + half);
+      }
+    }
+  };
+  pool.run(worker);
+}
+
+// workStealingRun on 'threads' new workers (the calling thread is one of
+// them)
+template <class Item, class Expand>
+void workStealingRun(std::vector<Item> roots, int threads,
+                     const Expand& expand) {
+  WorkerPool pool{std::max(1, threads)};
+  workStealingRun(std::move(roots), pool, expand);
+}
+
+}  // namespace detail
+
+}  // namespace cycles
+
+#endif  // CYCLES_DETAIL_WORKSTEALING_HPP_ // NOLINT
@@ -0,0 +1,619 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_RC_DYNOWFORESTRC_HPP_  // NOLINT
+#define CYCLES_DETAIL_RC_DYNOWFORESTRC_HPP_  // NOLINT
+
+// C++
+#include <algorithm>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+//
+#include <cycles/detail/ChangeTracking.hpp>
+#include <cycles/detail/ExternalRelations.hpp>
+#include <cycles/detail/IDynowForest.hpp>
+#include <cycles/detail/ReachableForest.hpp>
+#include <cycles/detail/TFlatNode.hpp>
+//
+#include <cycles/detail/utils.hpp>
+#include <cycles/detail/v1/TArrowV1.hpp>
+#include <cycles/detail/v1/TNodeV1.hpp>
+
+using std::vector, std::ostream;  // NOLINT
+
+// ====================================================
+// DynowForestRC: reference counting + trial deletion
+// ====================================================
+// Alternative to tree repair on DynowForestV1 (Bacon-Rajan cycle collector):
+// - every node is kept on a flat pool (no tree structure)
+// - every owned relation is a link on 'owns'/'owned_by' lists
+// - each node counts its strong references: roots (op1) + owned relations
+// - a node is freed when its count reaches zero
+// - a decrement that does not reach zero buffers node as possible cycle root
+// - collect() runs trial deletion (mark gray, scan, collect white) from
+//   buffered candidates, reclaiming garbage cycles
+// - with auto collect, trial deletion runs when buffer reaches threshold
+//-----------------------------------------------
+
+namespace cycles {
+
+namespace detail {
+
+// colors of synchronous cycle collection (Bacon and Rajan, 2001)
+enum class RCColor : unsigned char {
+  BLACK,  // in use or free
+  GRAY,   // possible member of cycle
+  WHITE,  // member of garbage cycle
+  PURPLE  // possible root of cycle
+};
+
+// reference counting state of a node (indexed by TFlatNode::slot)
+struct RCEntry {
+  int rc{0};         // roots + owned relations (including self links)
+  int root_refs{0};  // unowned arrows (op1/op5)
+  RCColor color{RCColor::BLACK};
+  bool buffered{false};
+};
+
+// NOLINTNEXTLINE
+class DynowForestRC : public IDynowForest<TArrowV1<TNodeData>>,
+                      public ReachableForest,
+                      public ExternalRelations<DynowForestRC>,
+                      public ChangeTracking {
+  // DynowForestRC is type-erased by means of TNodeData
+ public:
+  // collect strategy parameters
+  //
+  bool _auto_collect{true};
+  bool getAutoCollect() override { return _auto_collect; }
+  bool setAutoCollect(bool ac) override {
+    _auto_collect = ac;
+    // if true, collect() now!
+    if (ac) collect();
+    // return 'true' if setAutoCollect(...) is supported
+    return true;
+  }
+  //
+  bool _debug{false};
+  bool debug() override { return _debug; }
+  void setDebug(bool d) override { _debug = d; }
+
+  // number of possible cycle roots that triggers trial deletion (auto
+  // collect). Trial deletion visits everything reachable from candidates,
+  // so it is batched by default; '1' reclaims cycles synchronously, as
+  // DynowForestV1 (at that cost on every decrement that does not free).
+  int cycle_buffer_threshold{1024};
+
+ private:
+  // flat pool: every node lives here (TFlatNode::slot is index on pool)
+  vector<sptr<TNode<TNodeData>>> nodes;
+  // reference counting state, same index as 'nodes'
+  vector<RCEntry> entries;
+  // possible cycle roots (may expire, if freed meanwhile)
+  vector<wptr<TNode<TNodeData>>> buffer;
+  // nodes whose count reached zero, waiting to be freed
+  vector<sptr<TNode<TNodeData>>> zero;
+  // data of freed nodes (destroyed after structure is consistent)
+  vector<sptr<TNodeData>> vdata;
+  // number of nodes with unowned arrows (similar to number of trees in V1)
+  int root_count{0};
+  bool is_releasing{false};
+
+ public:
+  DynowForestRC() {
+    if (debug()) std::cout << "DynowForestRC created!" << std::endl;
+  }
+
+  // nodes with unowned arrows, but external anchor (see ExternalRelations)
+  int getForestSize() override { return root_count - externalAnchors(); }
+
+  // number of nodes in pool
+  int getPoolSize() const { return static_cast<int>(nodes.size()); }
+
+  // number of buffered possible cycle roots
+  int getBufferSize() const { return static_cast<int>(buffer.size()); }
+
+  // Adds 'n' nodes (values are set later by caller) and 'links' (owner,
+  // owned) among them in bulk, without op1 to op3: node 'root' is held by
+  // returned unowned arrow. Counts are set directly (one per incoming link,
+  // plus root), so nothing is buffered. New nodes go to 'out', by index.
+  TArrowV1<TNodeData> addSubgraph(
+      std::size_t n, const vector<std::pair<std::size_t, std::size_t>>& links,
+      std::size_t root, vector<sptr<TNode<TNodeData>>>& out) {
+    out.clear();
+    out.reserve(n);
+    nodes.reserve(nodes.size() + n);
+    entries.reserve(entries.size() + n);
+    for (std::size_t i = 0; i < n; i++) out.push_back(add_node(nullptr));
+    for (const auto& [u, t] : links) {
+      TNode<TNodeData>::add_weak_link_owned(out[t], out[u]);
+      entries[flatSlot(out[t])].rc++;
+    }
+    RCEntry& e = entries[flatSlot(out[root])];
+    e.rc++;
+    e.root_refs = 1;
+    root_count++;
+    //
+    TArrowV1<TNodeData> arrow;
+    arrow.owned_by_node = wptr<TNode<TNodeData>>{};
+    arrow.remote_node = out[root];
+    return arrow;
+  }
+
+  // Moves every node (with its counts) and buffered cycle root of 'other'
+  // into this forest (nodes get new slots on this pool, links are not
+  // touched). Epoch counter is advanced past 'other', so old node marks are
+  // never current.
+  void absorb(DynowForestRC& other) {
+    assert(!is_releasing && !other.is_releasing);
+    nodes.reserve(nodes.size() + other.nodes.size());
+    entries.reserve(entries.size() + other.entries.size());
+    for (std::size_t i = 0; i < other.nodes.size(); i++) {
+      flatSlot(other.nodes[i]) = nodes.size();
+      nodes.push_back(std::move(other.nodes[i]));
+      entries.push_back(other.entries[i]);
+    }
+    other.nodes.clear();
+    other.entries.clear();
+    for (auto& w : other.buffer) buffer.push_back(std::move(w));
+    other.buffer.clear();
+    root_count += other.root_count;
+    other.root_count = 0;
+    visit_epoch = std::max(visit_epoch, other.visit_epoch);
+  }
+
+  // Moves node of unowned arrow 'root' and every node reachable from it
+  // (with their counts) to 'dest' (nodes get new slots, links are not
+  // touched), when nothing else points into them: no owner out of them, nor
+  // other unowned arrow. Since garbage cycles not yet collected may point
+  // into them, a collection is tried before giving up. Returns number of
+  // such incoming relations (nothing is moved unless it is zero).
+  long moveReachable(const TArrowV1<TNodeData>& root, DynowForestRC& dest) {
+    assert(root.is_root());
+    auto sroot = root.remote_node.lock();
+    vector<TNode<TNodeData>*> moved;
+    unsigned mark = 0;
+    auto count_incoming = [&]() {
+      mark = ++visit_epoch;
+      TNodeHelper<>::collectReachable(sroot.get(), mark, moved);
+      long incoming = TNodeHelper<>::countIncoming(moved, mark);
+      for (TNode<TNodeData>* node : moved)
+        incoming += entries[flatSlot(node)].root_refs - (node == sroot.get());
+      return incoming;
+    };
+    long incoming = count_incoming();
+    if ((incoming > 0) && !is_releasing) {
+      collect();
+      incoming = count_incoming();
+    }
+    if (incoming > 0) return incoming;
+    // buffered candidates go along with their nodes
+    buffer.erase(std::remove_if(buffer.begin(), buffer.end(),
+                                [mark](const wptr<TNode<TNodeData>>& w) {
+                                  auto node = w.lock();
+                                  return node && (node->epoch == mark);
+                                }),
+                 buffer.end());
+    for (TNode<TNodeData>* node : moved) {
+      std::size_t i = flatSlot(node);
+      RCEntry e = entries[i];
+      std::swap(nodes[i], nodes.back());
+      std::swap(entries[i], entries.back());
+      flatSlot(nodes[i]) = i;
+      flatSlot(node) = dest.nodes.size();
+      if (e.buffered) dest.buffer.push_back(nodes.back());
+      dest.nodes.push_back(std::move(nodes.back()));
+      dest.entries.push_back(e);
+      nodes.pop_back();
+      entries.pop_back();
+    }
+    root_count--;
+    dest.root_count++;
+    dest.visit_epoch = std::max(dest.visit_epoch, visit_epoch);
+    return 0;
+  }
+
+  // reference count of node (testing only)
+  int getRefCount(const sptr<TNode<TNodeData>>& node) {
+    return entries[flatSlot(node)].rc;
+  }
+
+ public:
+  // main operations
+
+  sptr<TNodeData> op0_getSharedData(const TArrowV1<TNodeData>& arrow) override {
+    sptr<TNode<TNodeData>> sremote_node = arrow.remote_node.lock();
+    if (!sremote_node)
+      return nullptr;
+    else
+      return sremote_node->value;
+  }
+
+  TArrowV1<TNodeData> op1_addNodeToNewTree(sptr<TNodeData> ref) override {
+    auto sptr_remote_node = add_node(ref);
+    RCEntry& e = entries[flatSlot(sptr_remote_node)];
+    e.rc = 1;
+    e.root_refs = 1;
+    root_count++;
+    //
+    TArrowV1<TNodeData> arrow;
+    arrow.owned_by_node = wptr<TNode<TNodeData>>{};
+    arrow.remote_node = sptr_remote_node;
+    return arrow;
+  }
+
+  TArrowV1<TNodeData> op2_addChildStrong(
+      const TArrowV1<TNodeData>& arrowToParent, sptr<TNodeData> ref) override {
+    auto owner = arrowToParent.remote_node.lock();
+    assert(owner);  // TODO: remove // NOLINT
+    auto sptr_mynode = add_node(ref);
+    // every relation is a counted link on RC forest (no 'children' here)
+    TNode<TNodeData>::add_weak_link_owned(sptr_mynode, owner);
+    entries[flatSlot(sptr_mynode)].rc = 1;
+    //
+    TArrowV1<TNodeData> arrow;
+    arrow.owned_by_node = owner;
+    arrow.remote_node = sptr_mynode;
+    arrow.is_owned_by_node = true;
+    return arrow;
+  }
+
+  TArrowV1<TNodeData> op3_weakSetOwnedBy(
+      const TArrowV1<TNodeData>& arrowToOwned,
+      const TArrowV1<TNodeData>& arrowToOwner) override {
+    auto this_remote_node = arrowToOwned.remote_node.lock();
+    auto owner_remote_node = arrowToOwner.remote_node.lock();
+    assert(this_remote_node);   // TODO: remove // NOLINT
+    assert(owner_remote_node);  // TODO: remove // NOLINT
+    TNode<TNodeData>::add_weak_link_owned(this_remote_node, owner_remote_node);
+    increment(this_remote_node.get());
+    //
+    TArrowV1<TNodeData> arrow;
+    arrow.owned_by_node = owner_remote_node;
+    arrow.remote_node = this_remote_node;
+    arrow.is_owned_by_node = true;
+    return arrow;
+  }
+
+  // NOLINTNEXTLINE
+  void op4_remove(TArrowV1<TNodeData>& arc) override {
+    bool isRoot = arc.is_root();
+    bool isOwned = arc.is_owned();
+    sptr<TNode<TNodeData>> owner_node = arc.owned_by_node.lock();
+    sptr<TNode<TNodeData>> sptr_mynode = arc.remote_node.lock();
+    arc.owned_by_node.reset();
+    arc.remote_node.reset();
+    // node already freed: nothing to do
+    if (!sptr_mynode) return;
+    //
+    if (isRoot) {
+      RCEntry& e = entries[flatSlot(sptr_mynode)];
+      assert(e.root_refs > 0);
+      if (--e.root_refs == 0) root_count--;
+      decrement(sptr_mynode);
+    }
+    if (isOwned && owner_node) {
+      bool r0 = TNodeHelper<>::removeFromOwnsList(owner_node, sptr_mynode);
+      assert(r0);
+      bool r1 = TNodeHelper<>::removeFromOwnedByList(owner_node, sptr_mynode);
+      assert(r1);
+      decrement(sptr_mynode);
+    }
+    // NOTE: owner already freed means link was already dropped (and counted)
+    // drop local references, so freed nodes are gone before data destruction
+    owner_node = nullptr;
+    sptr_mynode = nullptr;
+    release();
+  }
+
+  // op5: receive 'arc' and make 'unowned' link
+  // NOTE: as in V1, a single unowned arrow per node is allowed
+  TArrowV1<TNodeData> op5_copyNodeToNewTree(
+      const TArrowV1<TNodeData>& arrow) override {
+    // cannot get pointer from null or copy unowned
+    if (arrow.is_null() || arrow.is_root()) {
+      TArrowV1<TNodeData> arr;
+      assert(arr.is_null());
+      return arr;
+    }
+    assert(arrow.is_owned());
+    auto sptr_mynode = arrow.remote_node.lock();
+    assert(sptr_mynode);
+    RCEntry& e = entries[flatSlot(sptr_mynode)];
+    if (e.root_refs > 0) {
+      // already has unowned arrow: return null
+      TArrowV1<TNodeData> arr;
+      assert(arr.is_null());
+      return arr;
+    }
+    e.root_refs = 1;
+    root_count++;
+    increment(sptr_mynode.get());
+    //
+    TArrowV1<TNodeData> arr;
+    arr.is_owned_by_node = false;
+    arr.remote_node = sptr_mynode;
+    assert(arr.is_root());
+    return arr;
+  }
+
+ public:
+  // public method to manually invoke collection, if 'auto_collect' is not
+  // true
+  void collect() override {
+    if (is_releasing) {
+      if (debug())
+        std::cout << "WARNING: collect() already executing!" << std::endl;
+      return;
+    }
+    drainExternal();
+    collect_cycles();
+    release();
+  }
+
+ private:
+  sptr<TNode<TNodeData>> add_node(const sptr<TNodeData>& ref) {
+    sptr<TNode<TNodeData>> node{new TFlatNode<TNodeData>{ref}};
+    flatSlot(node) = nodes.size();
+    nodes.push_back(node);
+    entries.push_back(RCEntry{});
+    return node;
+  }
+
+  void increment(TNode<TNodeData>* node) {
+    RCEntry& e = entries[flatSlot(node)];
+    e.rc++;
+    e.color = RCColor::BLACK;
+  }
+
+  void decrement(const sptr<TNode<TNodeData>>& node) {
+    RCEntry& e = entries[flatSlot(node)];
+    assert(e.rc > 0);
+    if (--e.rc == 0) {
+      e.color = RCColor::BLACK;
+      zero.push_back(node);
+      return;
+    }
+    // possible root of garbage cycle
+    if (e.color != RCColor::PURPLE) {
+      e.color = RCColor::PURPLE;
+      if (!e.buffered) {
+        e.buffered = true;
+        buffer.push_back(node);
+      }
+    }
+  }
+
+  // frees nodes with zero count, runs auto collection and destroys data.
+  // User destructors may call op4 again: nested calls only register work.
+  void release() {
+    if (is_releasing) return;
+    is_releasing = true;
+    while (true) {
+      while (!zero.empty()) {
+        auto node = std::move(zero.back());
+        zero.pop_back();
+        free_node(node, false);
+      }
+      if (_auto_collect &&
+          (static_cast<int>(buffer.size()) >= cycle_buffer_threshold)) {
+        collect_cycles();
+        continue;
+      }
+      if (vdata.empty()) break;
+      auto local = std::move(vdata);
+      vdata.clear();
+      local.clear();
+    }
+    is_releasing = false;
+  }
+
+  // drop outgoing links and data of node, and remove it from pool.
+  // 'white' nodes (garbage cycle) do not decrement other members.
+  void free_node(const sptr<TNode<TNodeData>>& node, bool white) {
+    if (debug())
+      std::cout << "DynowForestRC: free " << node->value_to_string()
+                << std::endl;
+    for (auto& w : node->owns) {
+      auto target = w.lock();
+      assert(target);
+      if (target == node) {
+        // self link: drop it only once (owned_by side)
+        bool r = TNodeHelper<>::removeFromOwnedByList(node, node);
+        assert(r);
+        continue;
+      }
+      bool r = TNodeHelper<>::removeFromOwnedByList(node, target);
+      assert(r);
+      // NOTE: links from white nodes were already discounted by mark_gray
+      if (!white) decrement(target);
+    }
+    node->owns.clear();
+    // white nodes may still be owned by other white nodes (cleaned later)
+    for (auto& w : node->owned_by) {
+      auto owner = w.lock();
+      if (owner && owner != node)
+        TNodeHelper<>::removeFromOwnsList(owner, node);
+    }
+    node->owned_by.clear();
+    vdata.push_back(std::move(node->value));
+    remove_from_pool(node.get());
+  }
+
+  // swap with last (O(1)), keeping 'slot' updated
+  void remove_from_pool(TNode<TNodeData>* node) {
+    std::size_t i = flatSlot(node);
+    std::size_t last = nodes.size() - 1;
+    if (i != last) {
+      nodes[i] = std::move(nodes[last]);
+      entries[i] = entries[last];
+      flatSlot(nodes[i]) = i;
+    }
+    nodes.pop_back();
+    entries.pop_back();
+  }
+
+  // ======================================
+  // synchronous cycle collection (Bacon and Rajan, 2001)
+  // ======================================
+
+  void collect_cycles() {
+    if (buffer.empty()) return;
+    if (debug())
+      std::cout << "DynowForestRC: collect_cycles |buffer|=" << buffer.size()
+                << std::endl;
+    // mark roots
+    vector<sptr<TNode<TNodeData>>> vroots;
+    vroots.reserve(buffer.size());
+    for (auto& w : buffer) {
+      auto node = w.lock();
+      if (!node) continue;  // already freed
+      RCEntry& e = entries[flatSlot(node)];
+      if (e.color == RCColor::PURPLE && e.rc > 0) {
+        mark_gray(node.get());
+        vroots.push_back(std::move(node));
+      } else {
+        e.buffered = false;
+      }
+    }
+    buffer.clear();
+    // scan roots
+    for (auto& node : vroots) scan(node.get());
+    // collect roots
+    vector<sptr<TNode<TNodeData>>> white;
+    for (auto& node : vroots) {
+      entries[flatSlot(node)].buffered = false;
+      collect_white(node, white);
+    }
+    vroots.clear();
+    if (debug())
+      std::cout << "DynowForestRC: collect_cycles |white|=" << white.size()
+                << std::endl;
+    for (auto& node : white) free_node(node, true);
+  }
+
+  // subtract internal references (from gray nodes)
+  void mark_gray(TNode<TNodeData>* s) {
+    if (entries[flatSlot(s)].color == RCColor::GRAY) return;
+    entries[flatSlot(s)].color = RCColor::GRAY;
+    vector<TNode<TNodeData>*> stack{s};
+    while (!stack.empty()) {
+      TNode<TNodeData>* node = stack.back();
+      stack.pop_back();
+      for (auto& w : node->owns) {
+        TNode<TNodeData>* t = w.lock().get();
+        RCEntry& e = entries[flatSlot(t)];
+        e.rc--;
+        if (e.color != RCColor::GRAY) {
+          e.color = RCColor::GRAY;
+          stack.push_back(t);
+        }
+      }
+    }
+  }
+
+  // gray nodes with external references are restored (black), others white
+  void scan(TNode<TNodeData>* s) {
+    vector<TNode<TNodeData>*> stack{s};
+    while (!stack.empty()) {
+      TNode<TNodeData>* node = stack.back();
+      stack.pop_back();
+      RCEntry& e = entries[flatSlot(node)];
+      if (e.color != RCColor::GRAY) continue;
+      if (e.rc > 0) {
+        scan_black(node);
+      } else {
+        e.color = RCColor::WHITE;
+        for (auto& w : node->owns) stack.push_back(w.lock().get());
+      }
+    }
+  }
+
+  // restore internal references
+  void scan_black(TNode<TNodeData>* s) {
+    entries[flatSlot(s)].color = RCColor::BLACK;
+    vector<TNode<TNodeData>*> stack{s};
+    while (!stack.empty()) {
+      TNode<TNodeData>* node = stack.back();
+      stack.pop_back();
+      for (auto& w : node->owns) {
+        TNode<TNodeData>* t = w.lock().get();
+        RCEntry& e = entries[flatSlot(t)];
+        e.rc++;
+        if (e.color != RCColor::BLACK) {
+          e.color = RCColor::BLACK;
+          stack.push_back(t);
+        }
+      }
+    }
+  }
+
+  // gather white nodes (garbage cycle), not yet buffered
+  void collect_white(const sptr<TNode<TNodeData>>& s,
+                     vector<sptr<TNode<TNodeData>>>& white) {
+    vector<sptr<TNode<TNodeData>>> stack{s};
+    while (!stack.empty()) {
+      auto node = std::move(stack.back());
+      stack.pop_back();
+      RCEntry& e = entries[flatSlot(node)];
+      if (e.color != RCColor::WHITE || e.buffered) continue;
+      e.color = RCColor::BLACK;
+      for (auto& w : node->owns) stack.push_back(w.lock());
+      white.push_back(std::move(node));
+    }
+  }
+
+ public:
+  void destroyAll() override {
+    if (debug())
+      std::cout << "DynowForestRC destroy() |nodes|=" << nodes.size()
+                << std::endl;
+    assert(!is_releasing);
+    is_releasing = true;
+    buffer.clear();
+    zero.clear();
+    for (auto& node : nodes) {
+      // force clean both lists: owned_by and owns (UNCHECKED/FASTER)
+      TNodeHelper<TNodeData>::cleanOwnsAndOwnedByLists(node, true);
+      vdata.push_back(std::move(node->value));
+    }
+    nodes.clear();
+    entries.clear();
+    root_count = 0;
+    // user destructors may still call op4 (on dead nodes: no effect)
+    while (!vdata.empty()) {
+      auto local = std::move(vdata);
+      vdata.clear();
+      local.clear();
+    }
+    is_releasing = false;
+  }
+
+  ~DynowForestRC() override {
+    if (debug())
+      std::cout << "~DynowForestRC() |nodes|=" << nodes.size() << std::endl;
+    destroyAll();
+  }
+
+ public:
+  void print() override {
+    std::cout << "print DynowForestRC: (|nodes|=" << nodes.size()
+              << " |buffer|=" << buffer.size() << ") [" << std::endl;
+    for (const auto& node : nodes) {
+      const RCEntry& e = entries[flatSlot(node)];
+      std::cout << " ~> NODE " << node << " as '" << (*node) << "' rc=" << e.rc
+                << " |owns|=" << node->owns.size()
+                << " |owned_by|=" << node->owned_by.size()
+                << (e.root_refs > 0 ? " ROOT" : "") << std::endl;
+    }
+    std::cout << "]" << std::endl;
+  }
+};
+
+}  // namespace detail
+
+}  // namespace cycles
+
+#endif  // CYCLES_DETAIL_RC_DYNOWFORESTRC_HPP_ // NOLINT
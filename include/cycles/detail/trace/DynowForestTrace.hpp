@@ -0,0 +1,465 @@
+// SPDX-License-Identifier:  MIT
+// Copyright (C) 2021-2022 - Cycles - https://github.com/igormcoelho/cycles
+
+#ifndef CYCLES_DETAIL_TRACE_DYNOWFORESTTRACE_HPP_  // NOLINT
+#define CYCLES_DETAIL_TRACE_DYNOWFORESTTRACE_HPP_  // NOLINT
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//
+#include <cycles/detail/ChangeTracking.hpp>
+#include <cycles/detail/ExternalRelations.hpp>
+#include <cycles/detail/IDynowForest.hpp>
+#include <cycles/detail/ReachableForest.hpp>
+#include <cycles/detail/TFlatNode.hpp>
+#include <cycles/detail/WorkStealing.hpp>
+//
+#include <cycles/detail/utils.hpp>
+#include <cycles/detail/v1/TArrowV1.hpp>
+#include <cycles/detail/v1/TNodeV1.hpp>
+
+using std::vector, std::ostream;  // NOLINT
+
+// ==============================================
+// DynowForestTrace: mark-sweep (tracing) forest
+// ==============================================
+// Alternative to tree repair on DynowForestV1:
+// - every node is kept on a flat pool (no tree structure)
+// - every owned relation is a link on 'owns'/'owned_by' lists
+// - roots are counted per node (op1 and op5)
+// - op4_remove only drops the link (no re-parenting, no isDescendent)
+// - collect() marks from roots (optionally with work stealing over 'owns'
+//   links, on a worker pool kept by the forest) and sweeps the pool
+// - auto collection is triggered by allocation volume (op1/op2)
+//-----------------------------------------------
+
+namespace cycles {
+
+namespace detail {
+
+// NOLINTNEXTLINE
+class DynowForestTrace : public IDynowForest<TArrowV1<TNodeData>>,
+                         public ReachableForest,
+                         public ExternalRelations<DynowForestTrace>,
+                         public ChangeTracking {
+  // DynowForestTrace is type-erased by means of TNodeData
+ public:
+  // collect strategy parameters
+  //
+  bool _auto_collect{true};
+  bool getAutoCollect() override { return _auto_collect; }
+  bool setAutoCollect(bool ac) override {
+    _auto_collect = ac;
+    // if true, collect() now!
+    if (ac) collect();
+    // return 'true' if setAutoCollect(...) is supported
+    return true;
+  }
+  //
+  bool _debug{false};
+  bool debug() override { return _debug; }
+  void setDebug(bool d) override { _debug = d; }
+
+  // minimum number of allocations (op1/op2) between automatic collections
+  int min_collect_threshold{1024};
+  // automatic collection happens after 'growth * live' allocations
+  double collect_growth{1.0};
+  // minimum number of nodes on pool to justify a parallel mark
+  int min_parallel_nodes{256};
+
+  // number of threads on mark phase (1 means sequential mark). Workers are
+  // created here and kept until next call (or forest destruction).
+  void setMarkThreads(int n) {
+    n = std::max(1, n);
+    if (n == getMarkThreads()) return;
+    mark_pool.reset(n > 1 ? new WorkerPool{n} : nullptr);
+  }
+
+  int getMarkThreads() const { return mark_pool ? mark_pool->size() : 1; }
+
+ private:
+  // flat pool: every node lives here (TFlatNode::slot is index on pool)
+  vector<sptr<TNode<TNodeData>>> nodes;
+  // number of root references (op1/op5 arrows) per node
+  std::unordered_map<TNode<TNodeData>*, int> roots;
+  // allocations since last collect
+  int alloc_count{0};
+  // next collection happens when alloc_count reaches this
+  int next_collect{1024};
+  bool is_collecting{false};
+  // workers of parallel mark (null on sequential mark)
+  std::unique_ptr<WorkerPool> mark_pool;
+
+ public:
+  DynowForestTrace() {
+    if (debug()) std::cout << "DynowForestTrace created!" << std::endl;
+  }
+
+  // number of distinct root nodes (similar to number of trees in V1), but
+  // external anchor (see ExternalRelations)
+  int getForestSize() override {
+    return static_cast<int>(roots.size()) - externalAnchors();
+  }
+
+  // number of nodes in pool (live or not yet collected)
+  int getPoolSize() const { return static_cast<int>(nodes.size()); }
+
+  // Adds 'n' nodes (values are set later by caller) and 'links' (owner,
+  // owned) among them in bulk, without op1 to op3: node 'root' is held by
+  // returned unowned arrow. New nodes go to 'out', by index. No collection
+  // happens here (it is counted as 'n' allocations).
+  TArrowV1<TNodeData> addSubgraph(
+      std::size_t n, const vector<std::pair<std::size_t, std::size_t>>& links,
+      std::size_t root, vector<sptr<TNode<TNodeData>>>& out) {
+    out.clear();
+    out.reserve(n);
+    nodes.reserve(nodes.size() + n);
+    for (std::size_t i = 0; i < n; i++) out.push_back(add_node(nullptr));
+    for (const auto& [u, t] : links)
+      TNode<TNodeData>::add_weak_link_owned(out[t], out[u]);
+    roots[out[root].get()]++;
+    //
+    TArrowV1<TNodeData> arrow;
+    arrow.owned_by_node = wptr<TNode<TNodeData>>{};
+    arrow.remote_node = out[root];
+    return arrow;
+  }
+
+  // Moves every node and root of 'other' into this forest (nodes get new
+  // slots on this pool, links are not touched). Epoch counter is advanced
+  // past 'other', so old node marks are never current.
+  void absorb(DynowForestTrace& other) {
+    assert(!is_collecting && !other.is_collecting);
+    nodes.reserve(nodes.size() + other.nodes.size());
+    for (auto& node : other.nodes) {
+      flatSlot(node) = nodes.size();
+      nodes.push_back(std::move(node));
+    }
+    other.nodes.clear();
+    for (auto& [node, count] : other.roots) roots[node] += count;
+    other.roots.clear();
+    alloc_count += other.alloc_count;
+    other.alloc_count = 0;
+    visit_epoch = std::max(visit_epoch, other.visit_epoch);
+  }
+
+  // Moves node of unowned arrow 'root' and every node reachable from it to
+  // 'dest' (nodes get new slots, links are not touched), when nothing else
+  // points into them: no owner out of them, nor other root reference. Since
+  // garbage not yet swept may point into them, a collection is tried before
+  // giving up. Returns number of such incoming relations (nothing is moved
+  // unless it is zero).
+  long moveReachable(const TArrowV1<TNodeData>& root, DynowForestTrace& dest) {
+    assert(root.is_root());
+    auto sroot = root.remote_node.lock();
+    vector<TNode<TNodeData>*> moved;
+    auto count_incoming = [&]() {
+      unsigned mark = ++visit_epoch;
+      TNodeHelper<>::collectReachable(sroot.get(), mark, moved);
+      long incoming = TNodeHelper<>::countIncoming(moved, mark);
+      for (TNode<TNodeData>* node : moved) {
+        auto it = roots.find(node);
+        if (it != roots.end()) incoming += it->second - (node == sroot.get());
+      }
+      return incoming;
+    };
+    long incoming = count_incoming();
+    if ((incoming > 0) && !is_collecting) {
+      collect();
+      incoming = count_incoming();
+    }
+    if (incoming > 0) return incoming;
+    for (TNode<TNodeData>* node : moved) {
+      std::size_t i = flatSlot(node);
+      std::swap(nodes[i], nodes.back());
+      flatSlot(nodes[i]) = i;
+      flatSlot(node) = dest.nodes.size();
+      dest.nodes.push_back(std::move(nodes.back()));
+      nodes.pop_back();
+    }
+    roots.erase(sroot.get());
+    dest.roots[sroot.get()]++;
+    dest.visit_epoch = std::max(dest.visit_epoch, visit_epoch);
+    return 0;
+  }
+
+ public:
+  // main operations
+
+  sptr<TNodeData> op0_getSharedData(const TArrowV1<TNodeData>& arrow) override {
+    sptr<TNode<TNodeData>> sremote_node = arrow.remote_node.lock();
+    if (!sremote_node)
+      return nullptr;
+    else
+      return sremote_node->value;
+  }
+
+  TArrowV1<TNodeData> op1_addNodeToNewTree(sptr<TNodeData> ref) override {
+    maybe_collect();
+    auto sptr_remote_node = add_node(ref);
+    roots[sptr_remote_node.get()]++;
+    //
+    TArrowV1<TNodeData> arrow;
+    arrow.owned_by_node = wptr<TNode<TNodeData>>{};
+    arrow.remote_node = sptr_remote_node;
+    return arrow;
+  }
+
+  TArrowV1<TNodeData> op2_addChildStrong(
+      const TArrowV1<TNodeData>& arrowToParent, sptr<TNodeData> ref) override {
+    // collect before locking owner (owner must be reachable anyway)
+    maybe_collect();
+    auto owner = arrowToParent.remote_node.lock();
+    assert(owner);  // TODO: remove // NOLINT
+    auto sptr_mynode = add_node(ref);
+    // every relation is a link on tracing forest (no 'children' here)
+    TNode<TNodeData>::add_weak_link_owned(sptr_mynode, owner);
+    //
+    TArrowV1<TNodeData> arrow;
+    arrow.owned_by_node = owner;
+    arrow.remote_node = sptr_mynode;
+    arrow.is_owned_by_node = true;
+    return arrow;
+  }
+
+  TArrowV1<TNodeData> op3_weakSetOwnedBy(
+      const TArrowV1<TNodeData>& arrowToOwned,
+      const TArrowV1<TNodeData>& arrowToOwner) override {
+    auto this_remote_node = arrowToOwned.remote_node.lock();
+    auto owner_remote_node = arrowToOwner.remote_node.lock();
+    assert(this_remote_node);   // TODO: remove // NOLINT
+    assert(owner_remote_node);  // TODO: remove // NOLINT
+    TNode<TNodeData>::add_weak_link_owned(this_remote_node, owner_remote_node);
+    //
+    TArrowV1<TNodeData> arrow;
+    arrow.owned_by_node = owner_remote_node;
+    arrow.remote_node = this_remote_node;
+    arrow.is_owned_by_node = true;
+    return arrow;
+  }
+
+  // NOLINTNEXTLINE
+  void op4_remove(TArrowV1<TNodeData>& arc) override {
+    bool isRoot = arc.is_root();
+    bool isOwned = arc.is_owned();
+    sptr<TNode<TNodeData>> owner_node = arc.owned_by_node.lock();
+    sptr<TNode<TNodeData>> sptr_mynode = arc.remote_node.lock();
+    arc.owned_by_node.reset();
+    arc.remote_node.reset();
+    // node already swept: nothing to do
+    if (!sptr_mynode) return;
+    //
+    if (isRoot) {
+      auto it = roots.find(sptr_mynode.get());
+      assert(it != roots.end());
+      if (--it->second == 0) roots.erase(it);
+      if (debug())
+        std::cout << "DynowForestTrace: root dropped. |roots|=" << roots.size()
+                  << std::endl;
+    }
+    if (isOwned && owner_node) {
+      // link is dropped now, memory is only reclaimed on collect()
+      bool r0 = TNodeHelper<>::removeFromOwnsList(owner_node, sptr_mynode);
+      assert(r0);
+      bool r1 = TNodeHelper<>::removeFromOwnedByList(owner_node, sptr_mynode);
+      assert(r1);
+    }
+    // NOTE: owner already swept means link was already dropped on sweep
+  }
+
+  // op5: receive 'arc' and make 'unowned' link
+  // NOTE: unlike V1, multiple unowned copies are allowed (roots are counted)
+  TArrowV1<TNodeData> op5_copyNodeToNewTree(
+      const TArrowV1<TNodeData>& arrow) override {
+    // cannot get pointer from null or copy unowned
+    if (arrow.is_null() || arrow.is_root()) {
+      TArrowV1<TNodeData> arr;
+      assert(arr.is_null());
+      return arr;
+    }
+    assert(arrow.is_owned());
+    auto sptr_mynode = arrow.remote_node.lock();
+    assert(sptr_mynode);
+    roots[sptr_mynode.get()]++;
+    //
+    TArrowV1<TNodeData> arr;
+    arr.is_owned_by_node = false;
+    arr.remote_node = sptr_mynode;
+    assert(arr.is_root());
+    return arr;
+  }
+
+ public:
+  // public method to manually invoke collection, if 'auto_collect' is not
+  // true
+  void collect() override {
+    if (is_collecting) {
+      if (debug())
+        std::cout << "WARNING: collect() already executing!" << std::endl;
+      return;
+    }
+    drainExternal();
+    is_collecting = true;
+    int n = static_cast<int>(nodes.size());
+    if (debug())
+      std::cout << "DynowForestTrace::collect |nodes|=" << n
+                << " |roots|=" << roots.size() << std::endl;
+    // ============
+    // mark phase
+    // ============
+    // NOLINTNEXTLINE
+    std::unique_ptr<std::atomic<unsigned char>[]> marks{
+        new std::atomic<unsigned char>[n]()};
+    mark_from_roots(marks.get());
+    // ============
+    // sweep phase
+    // ============
+    // first drop links from dead nodes into live nodes (live nodes never
+    // point to dead nodes, otherwise they would be marked)
+    vector<sptr<TNode<TNodeData>>> dead;
+    for (int i = 0; i < n; i++) {
+      auto& node = nodes[i];
+      if (marks[i].load(std::memory_order_relaxed)) continue;
+      for (auto& w : node->owns) {
+        auto target = w.lock();
+        if (target && marks[flatSlot(target)].load(std::memory_order_relaxed))
+          TNodeHelper<>::removeFromOwnedByList(node, target);
+      }
+      node->owns.clear();
+      node->owned_by.clear();
+    }
+    // compact pool
+    int j = 0;
+    for (int i = 0; i < n; i++) {
+      if (marks[i].load(std::memory_order_relaxed)) {
+        if (i != j) nodes[j] = std::move(nodes[i]);
+        flatSlot(nodes[j]) = j;
+        j++;
+      } else {
+        dead.push_back(std::move(nodes[i]));
+      }
+    }
+    nodes.resize(j);
+    // store data separately for delayed destruction
+    vector<sptr<TNodeData>> vdata;
+    vdata.reserve(dead.size());
+    for (auto& d : dead) vdata.push_back(std::move(d->value));
+    if (debug())
+      std::cout << "DynowForestTrace::collect |dead|=" << dead.size()
+                << std::endl;
+    // destroy empty nodes, then data (user destructors may invoke op4)
+    dead.clear();
+    vdata.clear();
+    //
+    alloc_count = 0;
+    next_collect = std::max(
+        min_collect_threshold,
+        static_cast<int>(collect_growth * static_cast<double>(nodes.size())));
+    is_collecting = false;
+  }
+
+ private:
+  sptr<TNode<TNodeData>> add_node(const sptr<TNodeData>& ref) {
+    sptr<TNode<TNodeData>> node{new TFlatNode<TNodeData>{ref}};
+    flatSlot(node) = nodes.size();
+    nodes.push_back(node);
+    alloc_count++;
+    return node;
+  }
+
+  void maybe_collect() {
+    if (_auto_collect && !is_collecting && (alloc_count >= next_collect))
+      collect();
+  }
+
+  // marks targets of 'owns' links of 'node' not yet marked, appending them
+  // to 'out' (marks are claimed atomically, so it is safe for parallel mark)
+  static void mark_owns(TNode<TNodeData>* node,
+                        vector<TNode<TNodeData>*>& out,
+                        std::atomic<unsigned char>* marks) {
+    for (auto& w : node->owns) {
+      auto target = w.lock();
+      if (!target) continue;
+      if (marks[flatSlot(target)].exchange(1, std::memory_order_relaxed) == 0)
+        out.push_back(target.get());
+    }
+  }
+
+  void mark_from_roots(std::atomic<unsigned char>* marks) {
+    vector<TNode<TNodeData>*> stack;
+    stack.reserve(roots.size());
+    for (auto& [node, count] : roots) {
+      if (marks[flatSlot(node)].exchange(1, std::memory_order_relaxed) == 0)
+        stack.push_back(node);
+    }
+    if (mark_pool &&
+        (static_cast<int>(nodes.size()) >= min_parallel_nodes)) {
+      // parallel mark: work is split over links (not roots), so a dense
+      // graph held by a few roots is also marked by all workers
+      workStealingRun(std::move(stack), *mark_pool,
+                      [marks](TNode<TNodeData>* node,
+                              vector<TNode<TNodeData>*>& out) {
+                        mark_owns(node, out, marks);
+                      });
+      return;
+    }
+    while (!stack.empty()) {
+      TNode<TNodeData>* node = stack.back();
+      stack.pop_back();
+      mark_owns(node, stack, marks);
+    }
+  }
+
+ public:
+  void destroyAll() override {
+    if (debug())
+      std::cout << "DynowForestTrace destroy() |nodes|=" << nodes.size()
+                << std::endl;
+    assert(!is_collecting);
+    is_collecting = true;
+    roots.clear();
+    vector<sptr<TNodeData>> vdata;
+    vdata.reserve(nodes.size());
+    for (auto& node : nodes) {
+      // force clean both lists: owned_by and owns (UNCHECKED/FASTER)
+      TNodeHelper<TNodeData>::cleanOwnsAndOwnedByLists(node, true);
+      vdata.push_back(std::move(node->value));
+    }
+    nodes.clear();
+    vdata.clear();
+    alloc_count = 0;
+    is_collecting = false;
+  }
+
+  ~DynowForestTrace() override {
+    if (debug())
+      std::cout << "~DynowForestTrace() |nodes|=" << nodes.size() << std::endl;
+    destroyAll();
+  }
+
+ public:
+  void print() override {
+    std::cout << "print DynowForestTrace: (|nodes|=" << nodes.size()
+              << " |roots|=" << roots.size() << ") [" << std::endl;
+    for (const auto& node : nodes) {
+      std::cout << " ~> NODE " << node << " as '" << (*node)
+                << "' |owns|=" << node->owns.size()
+                << " |owned_by|=" << node->owned_by.size()
+                << (roots.count(node.get()) ? " ROOT" : "") << std::endl;
+    }
+    std::cout << "]" << std::endl;
+  }
+};
+
+}  // namespace detail
+
+}  // namespace cycles
+
+#endif  // CYCLES_DETAIL_TRACE_DYNOWFORESTTRACE_HPP_ // NOLINT
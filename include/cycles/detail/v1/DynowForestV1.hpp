@@ -5,13 +5,22 @@
 #define CYCLES_DynowForestV1_HPP_  // NOLINT
 
 // C++
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <map>
+#include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 //
+#include <cycles/detail/EventTrace.hpp>
+#include <cycles/detail/ChangeTracking.hpp>
+#include <cycles/detail/ExternalRelations.hpp>
 #include <cycles/detail/IDynowForest.hpp>
+#include <cycles/detail/PauseHistogram.hpp>
+#include <cycles/detail/ReachableForest.hpp>
 //
 #include <cycles/detail/utils.hpp>
 #include <cycles/detail/v1/TArrowV1.hpp>
@@ -31,11 +40,75 @@ namespace cycles {
 
 namespace detail {
 
+// snapshot of forest counters (see DynowForestV1::getStats)
+struct ForestStats {
+  long nodes{0};               // live nodes
+  long trees{0};               // trees on forest (unowned arrows)
+  long weak_links{0};          // owned relations not used as tree edges
+  long op1{0};                 // new nodes on new trees
+  long op2{0};                 // new nodes as strong children
+  long op3{0};                 // new weak links
+  long op4{0};                 // removed arrows
+  long op5{0};                 // unowned copies of owned arrows
+  long reparent_attempts{0};   // owners tried as new parent
+  long reparents{0};           // nodes saved by a new parent
+  long descendent_steps{0};    // ancestors visited on descendent checks
+  long pending_high_water{0};  // largest pending list
+  long collections{0};         // runs of destroy_pending with pending nodes
+  long reclaimed{0};           // destroyed nodes
+  double collect_ms{0.0};      // time spent on destroy_pending
+};
+
+// how a node is held by next hop of a retention path
+enum class RetentionLink {
+  ROOT,    // tree root, held by unowned arrow (last hop)
+  STRONG,  // child of next hop
+  WEAK,    // orphan subtree root (adaptive), weakly owned by next hop
+  NONE     // not held: waiting destruction (last hop)
+};
+
+// hop of a retention path (see DynowForestV1::explainRetention)
+struct RetentionHop {
+  const void* node{nullptr};  // node id
+  std::string type;           // type name (see TypeDescriptor)
+  RetentionLink link{RetentionLink::NONE};
+};
+
+// node retaining a strong subtree (see DynowForestV1::getTopRetainers)
+struct Retainer {
+  const void* node{nullptr};  // node id
+  std::string type;           // type name (see TypeDescriptor)
+  long retained{0};           // nodes on strong subtree (including itself)
+  bool root{false};           // true if root of tree (or orphan subtree)
+};
+
+// live objects of one type on a pool (see DynowForestV1::getMemoryReport)
+struct TypeMemory {
+  std::string name;     // type name (see TypeDescriptor)
+  std::size_t size{0};  // sizeof(T)
+  long live{0};         // objects on this pool
+  long bytes{0};        // live * size
+};
+
+// snapshot of pool memory: objects per type and metadata overhead.
+// Heap owned by objects and shared_ptr control blocks are not included.
+struct MemoryReport {
+  vector<TypeMemory> types;  // largest bytes first
+  long object_bytes{0};      // sum of bytes of all types
+  long node_bytes{0};        // TNode and TNodeData
+  long tree_bytes{0};        // Tree (and its forest entry)
+  long link_bytes{0};        // capacity of children, owns and owned_by
+  long overhead_bytes{0};    // node + tree + link
+};
+
 // NOLINTNEXTLINE
 // class DynowForestV1 : public IDynowForest<TNode<TNodeData>, Tree<TNodeData>,
 //                                           TArrowV1<TNodeData>> {
 // NOLINTNEXTLINE
-class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
+class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>>,
+                      public ReachableForest,
+                      public ExternalRelations<DynowForestV1>,
+                      public ChangeTracking {
   // DynowForestV1 is type-erased by means of TNodeData
  public:
   // collect strategy parameters
@@ -53,6 +126,35 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
   bool _debug{false};
   bool debug() override { return _debug; }
   void setDebug(bool d) override { _debug = d; }
+  //
+  // adaptive collection: each tree measures the cost of its eager repairs
+  // (op4x_trySetNewOwner) and switches to DEFERRED mode when tracing is
+  // expected to be cheaper. In DEFERRED mode, removal of a parent link only
+  // detaches the orphan subtree, which is decided on next trace.
+  bool _adaptive{false};
+  bool getAdaptive() { return _adaptive; }
+  void setAdaptive(bool a) {
+    _adaptive = a;
+    if (a) return;
+    // back to default: decide all deferred subtrees now
+    collect();
+    forest_mode = TreeCollectMode::EAGER;
+    for (auto& p : forest) p.second->mode = TreeCollectMode::EAGER;
+  }
+  // forest-wide mode, followed by trees with few samples (see min_samples)
+  TreeCollectMode getForestMode() { return forest_mode; }
+  void setForestMode(TreeCollectMode m) { forest_mode = m; }
+  // cost model parameters
+  int min_trace_batch{64};      // minimum deferred removals before trace
+  int trace_batch_ratio{8};     // trace when |deferred| >= nodes/ratio
+  double mode_hysteresis{2.0};  // switch only if other mode is this cheaper
+  double cost_alpha{0.125};     // weight of new sample on moving averages
+  int min_samples{16};          // eager repairs before first switch
+  int probe_interval{32};       // DEFERRED: every n-th removal is eager
+  //
+  // owner selection on repair: the shallowest of first 'owner_candidates'
+  // valid owners becomes new parent ('1' keeps first valid owner)
+  int owner_candidates{4};
 
  private:
   // Forest: every Tree is identified by its Root node in map system
@@ -64,13 +166,332 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
 
  private:
   bool is_destroying{false};
+  // orphan subtrees (adaptive DEFERRED mode), decided on next trace
+  vector<sptr<TNode<TNodeData>>> deferred;
+  // number of live nodes in this forest
+  int node_count{0};
+  int trace_count{0};
+  // moving average of trace cost (visited nodes and links) per removal
+  double trace_cost_per_removal{0.0};
+  // forest-wide estimate, for trees with few samples
+  TreeCollectMode forest_mode{TreeCollectMode::EAGER};
+  double forest_repair_cost{0.0};
+  int forest_repairs{0};
+  // always-on counters (nodes and trees are taken on getStats)
+  ForestStats counters;
+  // pause histograms, nesting depth of collection runs and finished runs
+  PauseStats pauses;
+  int pause_depth{0};
+  long pause_runs{0};
+  // collection time of current op4_remove (-1 when not inside a removal)
+  long removal_pause_ns{-1};
 
  public:
   DynowForestV1() {
     if (debug()) std::cout << "DynowForestV1 created!" << std::endl;
   }
 
-  int getForestSize() override { return static_cast<int>(forest.size()); }
+  // number of trees (external anchor is left out, see ExternalRelations)
+  int getForestSize() override {
+    return static_cast<int>(forest.size()) - externalAnchors();
+  }
+
+  int getNodeCount() { return node_count; }
+
+  int getDeferredSize() { return static_cast<int>(deferred.size()); }
+
+  // snapshot of forest counters
+  ForestStats getStats() {
+    ForestStats st = counters;
+    st.nodes = node_count;
+    st.trees = getForestSize();
+    return st;
+  }
+
+  // pause histograms since creation (or last resetPauseStats)
+  PauseStats getPauseStats() { return pauses; }
+
+  // starts a new interval of pause histograms
+  void resetPauseStats() {
+    pauses.collect.reset();
+    pauses.remove.reset();
+  }
+
+  // live objects per type and metadata overhead (visits every node)
+  MemoryReport getMemoryReport() {
+    MemoryReport report;
+    map<const TypeDescriptor*, long> live;
+    // values shared by more than one node (op5)
+    std::unordered_set<const TNodeData*> shared;
+    long nodes = 0;
+    long values = 0;
+    forEachNode([&](const sptr<TNode<TNodeData>>& node) {
+      nodes++;
+      report.link_bytes += static_cast<long>(
+          node->children.capacity() * sizeof(sptr<TNode<TNodeData>>) +
+          node->owns.capacity() * sizeof(wptr<TNode<TNodeData>>) +
+          node->owned_by.capacity() * sizeof(wptr<TNode<TNodeData>>));
+      const TNodeData* data = node->value.get();
+      if (!data) return;
+      if ((node->value.use_count() > 1) && !shared.insert(data).second) return;
+      values++;
+      if (data->p) live[data->type]++;
+    });
+    for (const auto& [type, count] : live) {
+      TypeMemory tm;
+      tm.name = type ? type->name : std::string{"unknown"};
+      tm.size = type ? type->size : 0;
+      tm.live = count;
+      tm.bytes = count * static_cast<long>(tm.size);
+      report.object_bytes += tm.bytes;
+      report.types.push_back(std::move(tm));
+    }
+    std::sort(report.types.begin(), report.types.end(),
+              [](const TypeMemory& a, const TypeMemory& b) {
+                return (a.bytes != b.bytes) ? (a.bytes > b.bytes)
+                                            : (a.name < b.name);
+              });
+    report.node_bytes =
+        static_cast<long>(nodes * sizeof(TNode<TNodeData>) +
+                          values * sizeof(TNodeData));
+    report.tree_bytes = static_cast<long>(
+        forest.size() * (sizeof(Tree<TNodeData>) +
+                         sizeof(decltype(forest)::value_type)));
+    report.overhead_bytes =
+        report.node_bytes + report.tree_bytes + report.link_bytes;
+    return report;
+  }
+
+  // ownership path that keeps node of 'arrow' alive: each hop tells how it
+  // is held by the next one, until a tree root (empty path if null arrow)
+  vector<RetentionHop> explainRetention(const TArrowV1<TNodeData>& arrow) {
+    vector<RetentionHop> path;
+    auto node = arrow.remote_node.lock();
+    unsigned visited = ++visit_epoch;
+    while (node) {
+      node->epoch = visited;
+      RetentionHop hop;
+      hop.node = node.get();
+      hop.type = typeName(*node);
+      sptr<TNode<TNodeData>> next = node->parent.lock();
+      if (next) {
+        hop.link = RetentionLink::STRONG;
+      } else if (forest.find(node) != forest.end()) {
+        hop.link = RetentionLink::ROOT;
+      } else {
+        // orphan subtree: kept until next trace, if weakly owned
+        for (auto& w : node->owned_by) {
+          auto sptr_owner = w.lock();
+          if (sptr_owner && sptr_owner->epoch != visited) {
+            next = std::move(sptr_owner);
+            break;
+          }
+        }
+        hop.link = next ? RetentionLink::WEAK : RetentionLink::NONE;
+      }
+      path.push_back(std::move(hop));
+      node = std::move(next);
+    }
+    return path;
+  }
+
+  // ReachableForest::getReachability, after a fast path on tree ancestors
+  // of 'to'
+  Reachability getReachability(const TArrowV1<TNodeData>& from,
+                               const TArrowV1<TNodeData>& to,
+                               long max_visits = 0) {
+    auto source = from.remote_node.lock();
+    auto target = to.remote_node.lock();
+    if (source && target &&
+        TNodeHelper<>::hasAncestorValue(target.get(), source->value.get(),
+                                        &counters.descendent_steps))
+      return Reachability::REACHABLE;
+    return ReachableForest::getReachability(from, to, max_visits);
+  }
+
+  // Adds 'n' nodes (values are set later by caller) and 'links' (owner,
+  // owned) among them in bulk, without op1 to op3: node 'root' is held by
+  // returned unowned arrow, on a new tree, and every node must be reachable
+  // from it. Tree is a breadth-first spanning tree over links (as optimize),
+  // other links are weak. New nodes go to 'out', by index.
+  TArrowV1<TNodeData> addSubgraph(
+      std::size_t n, const vector<std::pair<std::size_t, std::size_t>>& links,
+      std::size_t root, vector<sptr<TNode<TNodeData>>>& out) {
+    out.clear();
+    out.reserve(n);
+    for (std::size_t i = 0; i < n; i++)
+      out.emplace_back(new TNode<TNodeData>{nullptr});
+    node_count += static_cast<int>(n);
+    // links by owner (counting sort keeps order of links of each owner)
+    vector<std::size_t> first(n + 1, 0);
+    for (const auto& [u, t] : links) first[u + 1]++;
+    for (std::size_t i = 0; i < n; i++) first[i + 1] += first[i];
+    vector<std::size_t> by_owner(links.size());
+    {
+      vector<std::size_t> next(first.begin(), first.end() - 1);
+      for (std::size_t k = 0; k < links.size(); k++)
+        by_owner[next[links[k].first]++] = k;
+    }
+    // breadth-first: first link that reaches a node becomes its parent
+    vector<char> strong(links.size(), 0);
+    vector<char> seen(n, 0);
+    vector<std::size_t> order{root};
+    seen[root] = 1;
+    for (std::size_t i = 0; i < order.size(); i++) {
+      std::size_t u = order[i];
+      for (std::size_t j = first[u]; j < first[u + 1]; j++) {
+        std::size_t t = links[by_owner[j]].second;
+        if (seen[t]) continue;
+        seen[t] = 1;
+        strong[by_owner[j]] = 1;
+        order.push_back(t);
+      }
+    }
+    assert(order.size() == n);
+    for (std::size_t k = 0; k < links.size(); k++) {
+      auto& owner = out[links[k].first];
+      auto& owned = out[links[k].second];
+      if (strong[k]) {
+        owned->parent = owner;
+        owner->add_child_strong(owned);
+      } else {
+        TNode<TNodeData>::add_weak_link_owned(owned, owner);
+        counters.weak_links++;
+      }
+    }
+    sptr<Tree<TNodeData>> stree(new Tree<TNodeData>{});
+    stree->set_root(out[root]);
+    stree->size = static_cast<int>(n);
+    this->forest[out[root]] = stree;
+    //
+    TArrowV1<TNodeData> arrow;
+    arrow.owned_by_node = wptr<TNode<TNodeData>>{};
+    arrow.remote_node = out[root];
+    return arrow;
+  }
+
+  // Moves every tree (and pending or deferred node) of 'other' into this
+  // forest: nodes are not touched, and cost is a merge of tree maps (live
+  // counts move too, operation counters stay with 'other'). Epoch
+  // counter is advanced past 'other', so old node marks are never current.
+  void absorb(DynowForestV1& other) {
+    assert(!is_destroying && !other.is_destroying);
+    forest.merge(other.forest);
+    assert(other.forest.empty());
+    for (auto& node : other.pending) pending.push_back(std::move(node));
+    other.pending.clear();
+    for (auto& node : other.deferred) deferred.push_back(std::move(node));
+    other.deferred.clear();
+    node_count += other.node_count;
+    other.node_count = 0;
+    counters.weak_links += other.counters.weak_links;
+    other.counters.weak_links = 0;
+    visit_epoch = std::max(visit_epoch, other.visit_epoch);
+  }
+
+  // Moves tree of unowned arrow 'root' to 'dest', when it holds every node
+  // reachable from root and nothing else points into them: no weak owner,
+  // parent or other tree root (unowned arrow) out of them, nor orphan
+  // subtree (adaptive). Nodes are not touched. Returns number of such
+  // incoming relations (nothing is moved unless it is zero).
+  long moveReachable(const TArrowV1<TNodeData>& root, DynowForestV1& dest) {
+    assert(root.is_root());
+    auto sroot = root.remote_node.lock();
+    auto tree_it = forest.find(sroot);
+    assert(tree_it != forest.end());
+    unsigned mark = ++visit_epoch;
+    vector<TNode<TNodeData>*> nodes;
+    TNodeHelper<>::collectReachable(sroot.get(), mark, nodes);
+    long incoming = TNodeHelper<>::countIncoming(nodes, mark);
+    long weak = 0;
+    for (TNode<TNodeData>* node : nodes) {
+      weak += static_cast<long>(node->owns.size());
+      if (node == sroot.get()) continue;
+      auto parent = node->parent.lock();
+      if (!parent || (parent->epoch != mark)) incoming++;
+    }
+    if (incoming > 0) return incoming;
+    dest.forest[sroot] = std::move(tree_it->second);
+    forest.erase(tree_it);
+    node_count -= static_cast<int>(nodes.size());
+    dest.node_count += static_cast<int>(nodes.size());
+    counters.weak_links -= weak;
+    dest.counters.weak_links += weak;
+    dest.visit_epoch = std::max(dest.visit_epoch, visit_epoch);
+    return 0;
+  }
+
+  // 'k' nodes with largest strong subtrees, in one linear pass over forest
+  // (subtree sizes accumulated from leaves to roots on breadth-first order)
+  vector<Retainer> getTopRetainers(int k) {
+    vector<TNode<TNodeData>*> order;
+    vector<long> vparent;
+    vector<TNode<TNodeData>*> roots;
+    for (auto& p : forest) roots.push_back(p.first.get());
+    for (auto& sptr_orphan : deferred)
+      if (!sptr_orphan->has_parent()) roots.push_back(sptr_orphan.get());
+    unsigned visited = ++visit_epoch;
+    for (auto* root : roots) {
+      if (root->epoch == visited) continue;
+      root->epoch = visited;
+      std::size_t first = order.size();
+      order.push_back(root);
+      vparent.push_back(-1);
+      for (std::size_t i = first; i < order.size(); i++) {
+        for (auto& child : order[i]->children) {
+          child->epoch = visited;
+          order.push_back(child.get());
+          vparent.push_back(static_cast<long>(i));
+        }
+      }
+    }
+    vector<long> retained(order.size(), 1);
+    for (std::size_t i = order.size(); i-- > 0;)
+      if (vparent[i] >= 0) retained[vparent[i]] += retained[i];
+    vector<std::size_t> idx(order.size());
+    for (std::size_t i = 0; i < idx.size(); i++) idx[i] = i;
+    std::size_t top = std::min(idx.size(), static_cast<std::size_t>(k));
+    std::partial_sort(idx.begin(), idx.begin() + top, idx.end(),
+                      [&](std::size_t a, std::size_t b) {
+                        return (retained[a] != retained[b])
+                                   ? (retained[a] > retained[b])
+                                   : (a < b);
+                      });
+    vector<Retainer> vret;
+    for (std::size_t i = 0; i < top; i++) {
+      Retainer r;
+      r.node = order[idx[i]];
+      r.type = typeName(*order[idx[i]]);
+      r.retained = retained[idx[i]];
+      r.root = (vparent[idx[i]] < 0);
+      vret.push_back(std::move(r));
+    }
+    return vret;
+  }
+
+  // statistics of every tree in forest (adaptive collection)
+  std::vector<TreeStats> getTreeStats() {
+    std::vector<TreeStats> vstats;
+    vstats.reserve(forest.size());
+    double trace_cost = traceCostEstimate();
+    for (const auto& p : forest) {
+      const Tree<TNodeData>& tree = *p.second;
+      TreeStats st;
+      st.root = p.first.get();
+      st.mode = _adaptive ? effectiveMode(tree) : TreeCollectMode::EAGER;
+      st.size = tree.size;
+      st.removals = tree.removals;
+      st.deferred_removals = tree.deferred_removals;
+      if (tree.eager_repairs > 0)
+        st.weak_link_density =
+            static_cast<double>(tree.weak_links_seen) / tree.eager_repairs;
+      st.avg_repair_cost = tree.avg_repair_cost;
+      st.trace_cost_estimate = trace_cost;
+      st.height = treeHeight(p.first);
+      vstats.push_back(st);
+    }
+    return vstats;
+  }
 
  public:
   // main operations
@@ -84,8 +505,11 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
   }
 
   TArrowV1<TNodeData> op1_addNodeToNewTree(sptr<TNodeData> ref) override {
+    CYCLES_TRACE_SPAN(span, "op1_addNodeToNewTree");
     // WE NEED TO HOLD SPTR locally, UNTIL we store it in definitive sptr tree
     sptr<TNode<TNodeData>> sptr_remote_node{new TNode<TNodeData>{ref}};
+    node_count++;
+    counters.op1++;
     //
     if (debug()) {
       std::cout << "=> C1 constructor: Registering this in new Tree!"
@@ -114,10 +538,13 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
   //                                        sptr<TNodeData> ref) override {
   TArrowV1<TNodeData> op2_addChildStrong(
       const TArrowV1<TNodeData>& arrowToParent, sptr<TNodeData> ref) override {
+    CYCLES_TRACE_SPAN(span, "op2_addChildStrong");
     auto myNewParent = arrowToParent.remote_node.lock();
     assert(myNewParent);  // TODO: remove // NOLINT
     // WE NEED TO HOLD SPTR locally, UNTIL we store it in definitive sptr tree
     sptr<TNode<TNodeData>> sptr_mynode{new TNode<TNodeData>{ref}};
+    node_count++;
+    counters.op2++;
     //
     // register STRONG ownership in tree
     //
@@ -137,6 +564,7 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
   TArrowV1<TNodeData> op3_weakSetOwnedBy(
       const TArrowV1<TNodeData>& arrowToOwned,
       const TArrowV1<TNodeData>& arrowToOwner) override {
+    CYCLES_TRACE_SPAN(span, "op3_weakSetOwnedBy");
     auto this_remote_node = arrowToOwned.remote_node.lock();
     auto owner_remote_node = arrowToOwner.remote_node.lock();
     assert(this_remote_node);   // TODO: remove // NOLINT
@@ -159,6 +587,8 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
     }
 
     TNode<TNodeData>::add_weak_link_owned(this_remote_node, owner_remote_node);
+    counters.op3++;
+    counters.weak_links++;
     //
     if (debug())
       std::cout << "owner |children|=" << this_remote_node->children.size()
@@ -175,10 +605,28 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
 
   // NOLINTNEXTLINE
   void op4_remove(TArrowV1<TNodeData>& arc) override {
+    // removal is a pause when it triggers auto collect: collection runs
+    // inside it are summed by PauseScope (no clock read on other removals)
+    if (!_auto_collect || pause_depth > 0 || removal_pause_ns >= 0) {
+      op4x_remove(arc);
+      return;
+    }
+    long runs = pause_runs;
+    removal_pause_ns = 0;
+    op4x_remove(arc);
+    if (pause_runs != runs) pauses.remove.record(removal_pause_ns);
+    removal_pause_ns = -1;
+  }
+
+ private:
+  // removal of 'arc' (see op4_remove)
+  void op4x_remove(TArrowV1<TNodeData>& arc) {
+    CYCLES_TRACE_SPAN(span, "op4_remove");
     bool isRoot = arc.is_root();
     bool isOwned = arc.is_owned();
     //
     assert(isRoot || isOwned);
+    counters.op4++;
     sptr<TNode<TNodeData>> owner_node = arc.owned_by_node.lock();
     sptr<TNode<TNodeData>> sptr_mynode = arc.remote_node.lock();
     // clear arc (???)
@@ -198,6 +646,12 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
       return;
     }
     assert(will_die);
+    // adaptive: only nodes with weak owners may need repair
+    if (_adaptive && !sptr_mynode->owned_by.empty()) {
+      if (myctx->op4x_adaptiveRemove(sptr_mynode, owner_node, isRoot)) return;
+    }
+    // detach from tree first, since new owner may become my parent
+    myctx->op4x_prepareDestruction(sptr_mynode, owner_node, isRoot, isOwned);
     // invoke expensive 'trySetNewOwner' operation
     will_die = myctx->op4x_trySetNewOwner(sptr_mynode);
     //
@@ -205,13 +659,10 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
     if (debug())
       std::cout << "CLEAR STEP: will_die = " << will_die << std::endl;
 
-    myctx->op4x_prepareDestruction(sptr_mynode, owner_node, isRoot, isOwned);
-
     // final check: if will_die, send to pending list (FAST)
     if (will_die) myctx->op4x_destroyNode(sptr_mynode);
   }
 
- private:
   // OK - helper 1 of op4_remove
   bool op4x_checkSituationCleanup(sptr<TNode<TNodeData>> sptr_mynode,
                                   sptr<TNode<TNodeData>> owner_node,
@@ -260,6 +711,7 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
           bool r1 =
               TNodeHelper<>::removeFromOwnedByList(owner_node, sptr_mynode);
           assert(r1);
+          counters.weak_links--;
         }
       }
     }  // end is_owned
@@ -267,7 +719,11 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
   }
 
   // OK - helper 2 of op4_remove
-  bool op4x_trySetNewOwner(sptr<TNode<TNodeData>> sptr_mynode) {
+  // If 'cost' is given, visited owners and ancestors are added to it.
+  bool op4x_trySetNewOwner(sptr<TNode<TNodeData>> sptr_mynode,
+                           long* cost = nullptr) {
+    CYCLES_TRACE_SPAN(span, "op4x_trySetNewOwner");
+    CYCLES_TRACE_ARG(span, sptr_mynode->owned_by.size());
     bool will_die = true;  // default
     // auto myctx = this;
     if (debug())
@@ -275,64 +731,165 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
           << "DEBUG: FIND OWNED_BY. NODE WILL DIE IF NOT FIND REPLACEMENT!"
           << std::endl;
     // find new owner, otherwise will die
-    int owned_by_count = static_cast<int>(sptr_mynode->owned_by.size());
+    int k = op4x_selectOwner(sptr_mynode, cost);
+    if (k < 0) return will_die;
+    // found some good k!
+    will_die = false;
+    auto myNewParent = sptr_mynode->owned_by.at(k).lock();
+    if (debug()) {
+      std::cout << "Found new VALID parent to own me: "
+                << myNewParent->value_to_string() << std::endl;
+    }
+    // COSTLY. Remove me from the 'owns' list of my owner
+    bool removed = TNodeHelper<>::removeFromOwnsList(myNewParent, sptr_mynode);
+    assert(removed);
+    // delete myself from owned_by (now I'm strong child)
+    sptr_mynode->owned_by.erase(sptr_mynode->owned_by.begin() +
+                                k);  // TODO: terrible TNode here...
+    // add myself as myNewParent child
+    sptr_mynode->parent = myNewParent;
+    myNewParent->add_child_strong(sptr_mynode);
+    counters.reparents++;
+    counters.weak_links--;
     //
-    for (unsigned k = 0; k < owned_by_count; k++) {
-      auto myNewParent = sptr_mynode->owned_by.at(k).lock();
-      if (!myNewParent) {
-        std::cout << "ERROR! no new parent! how??" << std::endl;
-      }
+    return will_die;
+  }
+
+  // OK - helper 3 of op4_remove (and of destroy_pending)
+  // Select new parent among weak owners of 'sptr_mynode' (index on
+  // 'owned_by'), or -1 if every owner is itself or a descendent.
+  // Deep parent chains make every later 'isDescendent' test costly, so the
+  // shallowest of first 'owner_candidates' valid owners is chosen (a root
+  // owner is taken immediately).
+  // If 'cost' is given, visited owners and ancestors are added to it.
+  int op4x_selectOwner(const sptr<TNode<TNodeData>>& sptr_mynode,
+                       long* cost = nullptr) {
+    int best = -1;
+    long best_depth = 0;
+    int valid = 0;
+    int owned_by_count = static_cast<int>(sptr_mynode->owned_by.size());
+    for (int k = 0; (k < owned_by_count) && (valid < owner_candidates); k++) {
+      counters.reparent_attempts++;
+      auto myNewParent = sptr_mynode->owned_by[k].lock();
       // new parent must exist
       assert(myNewParent);
-      if (myNewParent.get() == sptr_mynode.get()) {
-        if (debug()) {
-          std::cout << "Found new parent to own me but it's loop! Ignoring! k="
-                    << k << std::endl;
-        }
-        continue;
-      }
-      if (debug()) {
-        std::cout
-            << "Found new parent to own me (will check if not on subtree): "
-            << myNewParent->value_to_string() << std::endl;
+      // NOTE: costly O(tree_size)=O(N) test in worst case (see isDescendent)
+      long steps = 0;
+      long depth =
+          TNodeHelper<>::depthIfNotDescendent(myNewParent, sptr_mynode, &steps);
+      counters.descendent_steps += steps;
+      if (cost) (*cost) += 1 + steps;
+      if (debug())
+        std::cout << "DEBUG: owner k=" << k << " depth=" << depth << std::endl;
+      // loop or descendent: try next k
+      if (depth < 0) continue;
+      valid++;
+      if ((best < 0) || (depth < best_depth)) {
+        best = k;
+        best_depth = depth;
       }
-      // NOTE: costly O(tree_size)=O(N) test in worst case for 'isDescendent'
-      bool _isDescendent =
-          TNodeHelper<>::isDescendent(myNewParent, sptr_mynode);
-      //
+      if (best_depth == 0) break;
+    }
+    return best;
+  }
+
+  // adaptive helper of op4_remove: removal of root or parent link of a node
+  // that has weak owners. Returns false if tree is unknown (default path).
+  // NOLINTNEXTLINE
+  bool op4x_adaptiveRemove(sptr<TNode<TNodeData>>& sptr_mynode,
+                           sptr<TNode<TNodeData>> owner_node, bool isRoot) {
+    auto tree_it =
+        isRoot ? this->forest.find(sptr_mynode)
+               : this->forest.find(TNodeHelper<>::findRoot(owner_node));
+    // not in a tree (orphan subtree or pending): use default path
+    if (tree_it == this->forest.end()) return false;
+    // hold tree, since a root removal destroys it (released before collect)
+    sptr<Tree<TNodeData>> stree = tree_it->second;
+    stree->removals++;
+    bool probe = (stree->removals % probe_interval == 0);
+    if (effectiveMode(*stree) == TreeCollectMode::DEFERRED && !probe) {
       if (debug())
-        std::cout << "DEBUG: isDescendent=" << _isDescendent << " k=" << k
+        std::cout << "DEBUG: adaptive DEFERRED. detach orphan subtree."
                   << std::endl;
-      if (_isDescendent) {
-        if (debug())
-          std::cout << "WARNING: owned_by is already my descendent! Discard. "
-                    << "Will try next k!"
-                    << "k=" << k << std::endl;
-        // k++
-        continue;
-      }
-      // found some good k!
-      // assume this will not die (for this 'k'). FOUND some good owner!
-      will_die = false;
-      if (debug()) {
-        std::cout << "Found new VALID parent to own me: "
-                  << myNewParent->value_to_string() << std::endl;
-      }
-      // COSTLY. Remove me from the 'owns' list of my owner
-      bool removed =
-          TNodeHelper<>::removeFromOwnsList(myNewParent, sptr_mynode);
-      assert(removed);
-      // delete myself from owned_by (now I'm strong child)
-      sptr_mynode->owned_by.erase(sptr_mynode->owned_by.begin() +
-                                  k);  // TODO: terrible TNode here...
-      // add myself as myNewParent child
-      sptr_mynode->parent = myNewParent;
-      myNewParent->add_child_strong(sptr_mynode);
-      // will_die should be False, at this point
-      if (!will_die) break;
-    }  // end for k
-    //
-    return will_die;
+      stree->deferred_removals++;
+      stree = nullptr;
+      op4x_prepareDestruction(sptr_mynode, owner_node, isRoot, !isRoot);
+      deferred.push_back(std::move(sptr_mynode));
+      if (getAutoCollect() && !is_destroying &&
+          static_cast<int>(deferred.size()) >= traceThreshold())
+        collect();
+      return true;
+    }
+    // EAGER (or probe): repair now, measuring its cost
+    op4x_prepareDestruction(sptr_mynode, owner_node, isRoot, !isRoot);
+    long cost = 0;
+    stree->weak_links_seen += static_cast<long>(sptr_mynode->owned_by.size());
+    bool will_die = op4x_trySetNewOwner(sptr_mynode, &cost);
+    addSample(&stree->avg_repair_cost, stree->eager_repairs, cost);
+    addSample(&forest_repair_cost, forest_repairs, cost);
+    stree->eager_repairs++;
+    forest_repairs++;
+    updateModes(stree.get());
+    stree = nullptr;
+    if (debug())
+      std::cout << "DEBUG: adaptive EAGER. cost=" << cost
+                << " will_die=" << will_die << std::endl;
+    if (will_die) op4x_destroyNode(sptr_mynode);
+    return true;
+  }
+
+  // moving average with weight 'cost_alpha' for new samples
+  void addSample(double* avg, int count, double sample) {
+    if (count == 0)
+      *avg = sample;
+    else
+      *avg += cost_alpha * (sample - *avg);
+  }
+
+  // trees with few samples follow forest-wide estimate
+  TreeCollectMode effectiveMode(const Tree<TNodeData>& tree) {
+    return (tree.eager_repairs < min_samples) ? forest_mode : tree.mode;
+  }
+
+  // cost model: compare average eager repair cost against trace cost
+  TreeCollectMode decideMode(TreeCollectMode mode, double repair_cost) {
+    double trace_cost = traceCostEstimate();
+    if (mode == TreeCollectMode::EAGER &&
+        repair_cost > mode_hysteresis * trace_cost)
+      return TreeCollectMode::DEFERRED;
+    if (mode == TreeCollectMode::DEFERRED &&
+        repair_cost * mode_hysteresis < trace_cost)
+      return TreeCollectMode::EAGER;
+    return mode;
+  }
+
+  // NOTE: tree may be already out of forest (root removal)
+  void updateModes(Tree<TNodeData>* tree) {
+    if (forest_repairs >= min_samples)
+      forest_mode = decideMode(forest_mode, forest_repair_cost);
+    if (!tree) return;
+    if (tree->eager_repairs < min_samples) {
+      tree->mode = forest_mode;
+      return;
+    }
+    auto mode = decideMode(tree->mode, tree->avg_repair_cost);
+    if (debug() && (mode != tree->mode))
+      std::cout << "DEBUG: tree switch to "
+                << ((mode == TreeCollectMode::EAGER) ? "EAGER" : "DEFERRED")
+                << std::endl;
+    tree->mode = mode;
+  }
+
+  // number of deferred removals that triggers a trace
+  int traceThreshold() {
+    return std::max(min_trace_batch, node_count / trace_batch_ratio);
+  }
+
+  // expected trace cost per deferred removal (measured after first trace)
+  double traceCostEstimate() {
+    if (trace_count > 0) return trace_cost_per_removal;
+    // a trace visits every node and link (about twice the node count)
+    return 2.0 * node_count / traceThreshold();
   }
 
   // OK - helper 3 of op4_remove
@@ -367,7 +924,9 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
     if (debug())
       std::cout << "destroy: will_die is TRUE. MOVE TO GARBAGE." << std::endl;
     // MOVE NODE TO GARBAGE (DO NOT FIX CHILDREN NOW) - THIS MUST BE FAST
-    assert(myctx->pending.size() == 0);
+    // Without auto collect, pending list keeps every removal until collect():
+    // pending subtrees may be chosen as new parents meanwhile, but each child
+    // of a destroyed node looks for an owner again (or dies) on collection.
     // AVOID TNode here...
     // sptr_mynode->owned_by.size()
     //
@@ -402,6 +961,7 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
   // op5: receive 'arc' and make 'unowned' link
   TArrowV1<TNodeData> op5_copyNodeToNewTree(
       const TArrowV1<TNodeData>& arrow) override {
+    CYCLES_TRACE_SPAN(span, "op5_copyNodeToNewTree");
     // cannot get pointer from null or copy unowned
     if (arrow.is_null() || arrow.is_root()) {
       // return null
@@ -421,14 +981,14 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
     auto sptr_mynode = arrow.remote_node.lock();
     assert(sptr_mynode);
 
-    // C++17 required (if C++11 is desired, change this part)
-    bool found = false;
-    for (auto const& [key, val] : this->forest) {
-      if (key->value.get() == sptr_mynode->value.get()) {
-        found = true;
-        break;
-      }
-    }
+    // data is already on a root when node is a root itself, or when node is
+    // the child of a previous copy (op5 keeps copy as parent of node). Both
+    // cases are found in O(log n), without scanning the forest.
+    auto sptr_parent = sptr_mynode->parent.lock();
+    bool found =
+        (this->forest.find(sptr_mynode) != this->forest.end()) ||
+        (sptr_parent && sptr_parent->value.get() == sptr_mynode->value.get() &&
+         this->forest.find(sptr_parent) != this->forest.end());
 
     if (found) {
       // Cannot make double copy of unowned in this forest v1 structure.
@@ -442,6 +1002,8 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
     // copy data sptr into new node
     sptr<TNode<TNodeData>> sptrNewNode{
         new TNode<TNodeData>{sptr_mynode->value}};
+    node_count++;
+    counters.op5++;
 
     // (2) create new Tree and make remote_node its root
     sptr<Tree<TNodeData>> stree(new Tree<TNodeData>{});
@@ -460,6 +1022,7 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
 
     // (4) must include weak link from old parent to remote_node
     TNode<TNodeData>::add_weak_link_owned(sptr_mynode, sptr_oldParent);
+    counters.weak_links++;
 
     // (5) add strong child: sptrNewNode -> sptr_mynode (otherwise sptr_mynode
     // will die)
@@ -490,12 +1053,20 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
       std::cout << "DynowForestV1 destroy() forest_size =" << forest.size()
                 << std::endl;
     destroyForestRoots();
+    // orphan subtrees are also destroyed (UNCHECKED/FASTER)
+    for (auto& sptr_orphan : deferred) {
+      TNodeHelper<TNodeData>::cleanOwnsAndOwnedByLists(sptr_orphan, true);
+      pending.push_back(std::move(sptr_orphan));
+    }
+    deferred.clear();
     if (debug())
       std::cout << "~DynowForestV1: final cleanup on pending" << std::endl;
     assert(!is_destroying);
     // NOTE: collect is slower than destroy_pending with unchecked=true
     // collect();
     destroy_pending(true);
+    // unchecked destruction drops every link
+    counters.weak_links = 0;
     if (debug())
       std::cout << "DynowForestV1 destroy(): finished final collect"
                 << std::endl;
@@ -591,7 +1162,252 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
  public:
   // public method to manually invoke collection, if 'auto_collect' is not
   // true
-  void collect() override { destroy_pending(false); }
+  void collect() override {
+    drainExternal();
+    trace_deferred();
+    destroy_pending(false);
+  }
+
+ private:
+  // trace_deferred decides orphan subtrees of adaptive DEFERRED mode:
+  // (A) anchor every node strongly reachable from forest roots;
+  // (B) orphans weakly owned by anchored nodes are re-parented and anchored;
+  // (C) remaining orphan subtrees are garbage, sent to pending list.
+  void trace_deferred() {
+    if (deferred.empty() || is_destroying) return;
+    PauseScope pause{this};
+    CYCLES_TRACE_SPAN(span, "trace_deferred");
+    CYCLES_TRACE_ARG(span, deferred.size());
+    if (debug())
+      std::cout << "CTX: trace_deferred. |deferred|=" << deferred.size()
+                << std::endl;
+    unsigned live = ++visit_epoch;
+    long work = 0;
+    vector<sptr<TNode<TNodeData>>> anchored;
+    // tree of each anchored node (for tree sizes)
+    vector<Tree<TNodeData>*> vtree;
+    // (A) tree edges from forest roots
+    for (auto& p : forest) {
+      std::size_t first = anchored.size();
+      p.first->epoch = live;
+      anchored.push_back(p.first);
+      anchorChildren(anchored, first, live);
+      p.second->size = static_cast<int>(anchored.size() - first);
+      vtree.resize(anchored.size(), p.second.get());
+    }
+    // (B) weak edges out of anchored nodes
+    for (std::size_t i = 0; i < anchored.size(); i++) {
+      auto node = anchored[i];
+      unsigned j = 0;
+      while (j < node->owns.size()) {
+        work++;
+        auto sptr_owned = node->owns[j].lock();
+        if (!sptr_owned || sptr_owned->epoch == live) {
+          j++;
+          continue;
+        }
+        // unanchored: its parent (if any) is unanchored too
+        if (auto sptr_old = sptr_owned->parent.lock()) {
+          bool r = sptr_old->remove_child(sptr_owned.get());
+          assert(r);
+          TNode<TNodeData>::add_weak_link_owned(sptr_owned, sptr_old);
+          counters.weak_links++;
+        }
+        // weak link node->owned (at position j) becomes strong
+        bool r0 = TNodeHelper<>::removeFromOwnsList(node, sptr_owned);
+        bool r1 = TNodeHelper<>::removeFromOwnedByList(node, sptr_owned);
+        assert(r0 && r1);
+        counters.weak_links--;
+        sptr_owned->parent = node;
+        node->add_child_strong(sptr_owned);
+        std::size_t first = anchored.size();
+        sptr_owned->epoch = live;
+        anchored.push_back(sptr_owned);
+        anchorChildren(anchored, first, live);
+        vtree[i]->size += static_cast<int>(anchored.size() - first);
+        vtree.resize(anchored.size(), vtree[i]);
+      }
+    }
+    work += static_cast<long>(anchored.size());
+    anchored.clear();
+    vtree.clear();
+    // (C) unanchored orphan subtrees are garbage
+    unsigned dead = ++visit_epoch;
+    vector<sptr<TNode<TNodeData>>> garbage;
+    int removals = static_cast<int>(deferred.size());
+    for (auto& sptr_orphan : deferred) {
+      // rescued, nested in other orphan subtree or already seen
+      if (sptr_orphan->epoch == live || sptr_orphan->epoch == dead ||
+          sptr_orphan->has_parent())
+        continue;
+      std::size_t first = garbage.size();
+      sptr_orphan->epoch = dead;
+      garbage.push_back(sptr_orphan);
+      anchorChildren(garbage, first, dead);
+      pending.push_back(sptr_orphan);
+    }
+    deferred.clear();
+    long removed_links = 0;
+    for (auto& sptr_garbage : garbage) {
+      bool b1 = TNodeHelper<TNodeData>::cleanOwnsAndOwnedByLists(
+          sptr_garbage, false, &removed_links);
+      assert(b1);
+    }
+    counters.weak_links -= removed_links;
+    garbage.clear();
+    // update cost model
+    addSample(&trace_cost_per_removal, trace_count,
+              static_cast<double>(work) / std::max(1, removals));
+    trace_count++;
+    updateModes(nullptr);
+    for (auto& p : forest)
+      if (p.second->eager_repairs >= min_samples)
+        p.second->mode = decideMode(p.second->mode, p.second->avg_repair_cost);
+    if (debug())
+      std::cout << "CTX: trace_deferred. work=" << work
+                << " |pending|=" << pending.size() << std::endl;
+    destroy_pending(false);
+  }
+
+  // collection run: outermost one records its duration on pauses.collect
+  // (and adds it to removal_pause_ns, inside op4_remove)
+  class PauseScope {
+   public:
+    explicit PauseScope(DynowForestV1* _ctx)
+        : ctx{_ctx}, begin{std::chrono::steady_clock::now()} {
+      ctx->pause_depth++;
+    }
+
+    ~PauseScope() {
+      if (--ctx->pause_depth > 0) return;
+      long ns = static_cast<long>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - begin)
+              .count());
+      ctx->pauses.collect.record(ns);
+      if (ctx->removal_pause_ns >= 0) ctx->removal_pause_ns += ns;
+      ctx->pause_runs++;
+    }
+
+   private:
+    DynowForestV1* ctx;
+    std::chrono::steady_clock::time_point begin;
+  };
+
+  // breadth-first visit of children of vnodes[first..], marking with epoch
+  static void anchorChildren(vector<sptr<TNode<TNodeData>>>& vnodes,
+                             std::size_t first, unsigned epoch) {
+    for (std::size_t i = first; i < vnodes.size(); i++) {
+      for (unsigned c = 0; c < vnodes[i]->children.size(); c++) {
+        vnodes[i]->children[c]->epoch = epoch;
+        vnodes.push_back(vnodes[i]->children[c]);
+      }
+    }
+  }
+
+  // visits every node once: trees (from roots), then orphan subtrees of
+  // adaptive DEFERRED mode
+  template <class F>
+  void forEachNode(F&& f) {
+    unsigned visited = ++visit_epoch;
+    vector<sptr<TNode<TNodeData>>> vnodes;
+    for (auto& p : forest) {
+      p.first->epoch = visited;
+      vnodes.push_back(p.first);
+    }
+    for (auto& sptr_orphan : deferred) {
+      if (sptr_orphan->has_parent() || sptr_orphan->epoch == visited) continue;
+      sptr_orphan->epoch = visited;
+      vnodes.push_back(sptr_orphan);
+    }
+    anchorChildren(vnodes, 0, visited);
+    for (auto& node : vnodes) f(node);
+  }
+
+  static std::string typeName(const TNode<TNodeData>& node) {
+    if (node.value && node.value->type) return node.value->type->name;
+    return "unknown";
+  }
+
+  // longest parent chain of tree (root has height 0)
+  static int treeHeight(const sptr<TNode<TNodeData>>& root) {
+    int height = 0;
+    vector<TNode<TNodeData>*> level{root.get()};
+    vector<TNode<TNodeData>*> next;
+    while (true) {
+      next.clear();
+      for (auto* node : level)
+        for (auto& child : node->children) next.push_back(child.get());
+      if (next.empty()) break;
+      height++;
+      std::swap(level, next);
+    }
+    return height;
+  }
+
+ public:
+  // optimize rebuilds every tree as a breadth-first spanning tree over its
+  // owned relations (strong and weak), so each node gets the shallowest
+  // parent available inside its tree. Nodes stay on their trees, and only
+  // strong/weak kinds of links are exchanged. Returns re-parented nodes.
+  int optimize() {
+    if (is_destroying) return 0;
+    CYCLES_TRACE_SPAN(span, "optimize");
+    int moved = 0;
+    vector<sptr<TNode<TNodeData>>> members;
+    vector<sptr<TNode<TNodeData>>> order;
+    vector<sptr<TNode<TNodeData>>> vparent;
+    for (auto& p : forest) {
+      // nodes of this tree
+      unsigned member = ++visit_epoch;
+      members.clear();
+      p.first->epoch = member;
+      members.push_back(p.first);
+      anchorChildren(members, 0, member);
+      // breadth-first over children first (keeps current parent on ties)
+      unsigned seen = ++visit_epoch;
+      order.clear();
+      vparent.clear();
+      p.first->epoch = seen;
+      order.push_back(p.first);
+      vparent.push_back(nullptr);
+      for (std::size_t i = 0; i < order.size(); i++) {
+        auto node = order[i];
+        auto visit = [&](const sptr<TNode<TNodeData>>& owned) {
+          if (owned->epoch != member) return;
+          owned->epoch = seen;
+          order.push_back(owned);
+          vparent.push_back(node);
+        };
+        for (auto& child : node->children) visit(child);
+        for (auto& w : node->owns)
+          if (auto owned = w.lock()) visit(owned);
+      }
+      assert(order.size() == members.size());
+      // exchange links of nodes with a new parent
+      for (std::size_t i = 1; i < order.size(); i++) {
+        auto& node = order[i];
+        auto sptr_old = node->parent.lock();
+        if (sptr_old == vparent[i]) continue;
+        // strong link to old parent becomes weak
+        bool r = sptr_old->remove_child(node.get());
+        assert(r);
+        TNode<TNodeData>::add_weak_link_owned(node, sptr_old);
+        // weak link from new parent becomes strong
+        bool r0 = TNodeHelper<>::removeFromOwnsList(vparent[i], node);
+        bool r1 = TNodeHelper<>::removeFromOwnedByList(vparent[i], node);
+        assert(r0 && r1);
+        node->parent = vparent[i];
+        vparent[i]->add_child_strong(node);
+        moved++;
+      }
+      p.second->size = static_cast<int>(members.size());
+    }
+    if (debug())
+      std::cout << "CTX: optimize. re-parented=" << moved << std::endl;
+    CYCLES_TRACE_ARG(span, moved);
+    return moved;
+  }
 
  private:
   // destroy_pending(unchecked) performs destruction, with two modes:
@@ -618,22 +1434,37 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
       is_destroying = false;
       return;
     }
+    PauseScope pause{this};
     // ==============================
     //    begin destruction process
     // ==============================
     //
+    CYCLES_TRACE_SPAN(span, "destroy_pending");
+    counters.collections++;
+    auto collect_begin = std::chrono::steady_clock::now();
+    long removed_links = 0;
     // store data separately for delayed destruction
     std::vector<sptr<TNodeData>> vdata;
+    // adaptive: when rescue of children becomes more expensive than a trace,
+    // remaining children are deferred and decided by trace_deferred()
+    long cascade_cost = 0;
+    bool cascade_deferred = false;
+    double cascade_budget = mode_hysteresis * 2.0 *
+                            std::max(node_count, min_trace_batch);
 
-    // TODO(igormcoelho): make queue?
-    while (pending.size() > 0) {
+    // pending is consumed as a queue: entries before 'head' are moved-from,
+    // and the list is only cleared at the end (erasing front is O(n))
+    std::size_t head = 0;
+    while (head < pending.size()) {
+      counters.pending_high_water =
+          std::max(counters.pending_high_water,
+                   static_cast<long>(pending.size() - head));
       if (debug()) {
         std::cout << std::endl;
         std::cout << "CTX: WHILE processing pending list. |pending|="
-                  << pending.size() << std::endl;
+                  << pending.size() - head << std::endl;
       }
-      sptr<TNode<TNodeData>> sptr_delete = std::move(pending[0]);
-      pending.erase(pending.begin() + 0);
+      sptr<TNode<TNodeData>> sptr_delete = std::move(pending[head++]);
       //
       if (debug()) {
         std::cout << "CTX: sptr_delete is: " << sptr_delete->value_to_string()
@@ -653,8 +1484,8 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
                     << std::endl;
       }
       // force clean both lists: owned_by and owns (CHECKED OR UNCHECKED)
-      bool b1 = TNodeHelper<TNodeData>::cleanOwnsAndOwnedByLists(sptr_delete,
-                                                                 unchecked);
+      bool b1 = TNodeHelper<TNodeData>::cleanOwnsAndOwnedByLists(
+          sptr_delete, unchecked, &removed_links);
       assert(b1);
       //
       assert(sptr_delete->owned_by.size() == 0);
@@ -679,62 +1510,38 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
       vdata.push_back(std::move(sptr_delete->value));
       // IMPORTANT: destroy node (without any data)
       sptr_delete = nullptr;
+      node_count--;
+      counters.reclaimed++;
       //
       if (debug())
         std::cout << "destroy_pending: check children of node" << std::endl;
       // check if children can be saved
-      while (children.size() > 0) {
+      for (auto& slot : children) {
         bool will_die = true;
         if (debug()) std::cout << "DEBUG: will move child!" << std::endl;
-        auto sptr_child = std::move(children[0]);
+        auto sptr_child = std::move(slot);
         if (debug())
           std::cout << "DEBUG: child is " << sptr_child->value_to_string()
                     << std::endl;
-        if (debug()) std::cout << "DEBUG: will erase empty child!" << std::endl;
-        children.erase(children.begin() + 0);
         // I THINK THAT WE NEED TO CHECK isDescendent HERE BECAUSE MY CHILD
         // CANNOT OWN ME
         //
         if (unchecked) {
           // no solution for this child in UNCHECKED mode
           TNodeHelper<TNodeData>::cleanOwnsAndOwnedByLists(sptr_child, true);
+        } else if (cascade_deferred && !sptr_child->owned_by.empty()) {
+          deferred.push_back(std::move(sptr_child));
+          continue;
         }
 
-        for (unsigned k = 0; k < sptr_child->owned_by.size(); k++) {
-          if (debug())
-            std::cout << "DEBUG: child found new parent!" << std::endl;
+        int k = op4x_selectOwner(sptr_child,
+                                 _adaptive ? &cascade_cost : nullptr);
+        if (k >= 0) {
+          will_die = false;
           auto sptr_new_parent = sptr_child->owned_by[k].lock();
-          //
-          if (sptr_new_parent.get() == sptr_child.get()) {
-            if (debug()) {
-              std::cout << "Found new parent to own child but it's loop! "
-                           "Ignoring! k="
-                        << k << std::endl;
-            }
-            continue;
-          }
-          //
           if (debug())
-            std::cout << "DEBUG: sptr_new_parent="
+            std::cout << "DEBUG: child found new parent="
                       << sptr_new_parent->value_to_string() << std::endl;
-          // NOTE: costly O(tree_size)=O(N) test in worst case for
-          // 'isDescendent'
-          bool _isDescendent =
-              TNodeHelper<TNodeData>::isDescendent(sptr_new_parent, sptr_child);
-          //
-          if (debug())
-            std::cout << "DEBUG: isDescendent=" << _isDescendent << " k=" << k
-                      << std::endl;
-          if (_isDescendent) {
-            if (debug())
-              std::cout
-                  << "CTX DEBUG: owned_by is already my descendent! Discard. "
-                  << "Will try next k!"
-                  << "k=" << k << std::endl;
-            // k++
-            continue;
-          }
-          will_die = false;
           //
           sptr_child->parent = sptr_new_parent;
           TNodeHelper<TNodeData>::removeFromOwnsList(sptr_new_parent,
@@ -742,6 +1549,14 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
           TNodeHelper<TNodeData>::removeFromOwnedByList(sptr_new_parent,
                                                         sptr_child);
           sptr_new_parent->add_child_strong(sptr_child);
+          counters.reparents++;
+          counters.weak_links--;
+        }
+        if (_adaptive && !cascade_deferred && cascade_cost > cascade_budget) {
+          if (debug())
+            std::cout << "DEBUG: cascade over budget. defer children."
+                      << std::endl;
+          cascade_deferred = true;
         }
         // kill if not held by anyone now
         if (debug()) std::cout << "DEBUG: may kill child!" << std::endl;
@@ -751,8 +1566,8 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
                       << sptr_child->value_to_string() << std::endl;
           //
           // force clean both lists: owned_by and owns
-          bool b1 =
-              TNodeHelper<TNodeData>::cleanOwnsAndOwnedByLists(sptr_child);
+          bool b1 = TNodeHelper<TNodeData>::cleanOwnsAndOwnedByLists(
+              sptr_child, false, &removed_links);
           assert(b1);
           //
           pending.push_back(std::move(sptr_child));
@@ -771,6 +1586,7 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
       }  // while children exists
       //
     }  // while pending list > 0
+    pending.clear();
     if (debug())
       std::cout << "destroy_pending: finished pending list |pending|="
                 << pending.size() << std::endl;
@@ -778,7 +1594,13 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
     if (debug())
       std::cout << "destroy_pending: final clear vdata. |vdata|="
                 << vdata.size() << std::endl;
-    vdata.clear();
+    CYCLES_TRACE_ARG(span, vdata.size());
+    {
+      // batch of user destructors (TNodeData::destroy)
+      CYCLES_TRACE_SPAN(span_data, "TNodeData::destroy");
+      CYCLES_TRACE_ARG(span_data, vdata.size());
+      vdata.clear();
+    }
     //
     if (debug())
       std::cout << "destroy_pending: assert no more pending. |pending|="
@@ -786,9 +1608,15 @@ class DynowForestV1 : public IDynowForest<TArrowV1<TNodeData>> {
     // IF THIS FAILS, WE MAY NEED TO INTRODUCE ANOTHER WHILE LOOP HERE,
     // TO RESTART THE PROCESS, UNTIL WE FINISH WITH ZERO pending LIST.
     assert(pending.size() == 0);
+    counters.weak_links -= removed_links;
+    counters.collect_ms += std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - collect_begin)
+                               .count();
 
     is_destroying = false;
     if (debug()) std::cout << "destroy_pending: finished!" << std::endl;
+    // decide children deferred by this cascade
+    if (cascade_deferred) trace_deferred();
   }
 
  public:
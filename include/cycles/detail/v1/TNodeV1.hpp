@@ -5,7 +5,9 @@
 #define CYCLES_TNODE_HPP_  // NOLINT
 
 // C++
+#include <atomic>
 #include <iostream>
+#include <type_traits>
 #include <utility>
 #include <vector>
 // C++ HELPER ONLY
@@ -28,7 +30,8 @@ namespace cycles {
 
 namespace detail {
 
-inline int tnode_count = 0;
+// live nodes (atomic: pools may be used by different threads)
+inline std::atomic<int> tnode_count{0};
 
 // default is now type-erased T
 template <typename T = TNodeData>
@@ -58,11 +61,18 @@ class TNode {
   vector<wptr<TNode<T>>> owned_by;
   // list of nodes that I weakly own
   vector<wptr<TNode<T>>> owns;
+  // ===========================
+  // => traversal part (see TNodeHelper::visitReachable)
+  // last traversal (epoch) that visited this node
+  unsigned epoch{0};
+  // last parallel traversal (epoch) that claimed this node (see
+  // ReachableForest::parallelVisitReachable)
+  std::atomic<unsigned> claim{0};
   //
   explicit TNode(sptr<T> value, bool _debug_flag = false,
                  wptr<TNode<T>> _parent = wptr<TNode<T>>())
       : value{value}, debug_flag{_debug_flag}, parent{_parent} {
-    tnode_count++;
+    tnode_count.fetch_add(1, std::memory_order_relaxed);
     if (debug_flag)
       std::cout << "TNode tnode_count = " << tnode_count << std::endl;
   }
@@ -105,7 +115,7 @@ class TNode {
     if (debug_flag) {
       std::cout << "BEGIN ~TNode(" << value_to_string() << ")" << std::endl;
     }
-    tnode_count--;
+    tnode_count.fetch_sub(1, std::memory_order_relaxed);
     //
     if (owns.size() > 0) {
       std::cout << "~TNode SERIOUS WARNING: non-zero owns list. |owns|="
@@ -328,6 +338,9 @@ class TNode {
   }
 };
 
+// answer of a reachability query (UNKNOWN: search gave up)
+enum class Reachability { UNREACHABLE, REACHABLE, UNKNOWN };
+
 // default is now type-erased T
 template <typename T = TNodeData>
 class TNodeHelper {
@@ -338,25 +351,202 @@ class TNodeHelper {
   // Since tree_size can grow O(N), this check is O(N) in worst case,
   // where N is total number of data nodes.
   // ================================================================
+  // If 'steps' is given, the number of visited ancestors is added to it.
   static bool isDescendent(sptr<TNode<T>> myNewParent,
-                           sptr<TNode<T>> sptr_mynode) {
+                           sptr<TNode<T>> sptr_mynode, long* steps = nullptr) {
     // self-check
     if (myNewParent.get() == sptr_mynode.get()) return true;
     //
     bool isDescendent = false;
+    long count = 0;
     auto parentsParent = myNewParent->parent;
     while (auto sptrPP = parentsParent.lock()) {
+      count++;
       if (sptrPP == sptr_mynode) {
         isDescendent = true;
         break;
       }
       parentsParent = sptrPP->parent;
     }
+    if (steps) *steps += count;
     return isDescendent;
   }
 
+  // Depth of 'myNewParent' (number of ancestors), or -1 if it is 'sptr_mynode'
+  // or one of its descendents (same walk as 'isDescendent').
+  // If 'steps' is given, the number of visited ancestors is added to it.
+  static long depthIfNotDescendent(sptr<TNode<T>> myNewParent,
+                                   sptr<TNode<T>> sptr_mynode,
+                                   long* steps = nullptr) {
+    // self-check
+    if (myNewParent.get() == sptr_mynode.get()) return -1;
+    //
+    long count = 0;
+    auto parentsParent = myNewParent->parent;
+    while (auto sptrPP = parentsParent.lock()) {
+      count++;
+      if (sptrPP == sptr_mynode) {
+        if (steps) *steps += count;
+        return -1;
+      }
+      parentsParent = sptrPP->parent;
+    }
+    if (steps) *steps += count;
+    return count;
+  }
+
+  // Find root of tree that contains 'node' (walks parent chain).
+  // If 'steps' is given, the number of visited ancestors is added to it.
+  static sptr<TNode<T>> findRoot(sptr<TNode<T>> node, long* steps = nullptr) {
+    long count = 0;
+    while (auto sptrP = node->parent.lock()) {
+      count++;
+      node = std::move(sptrP);
+    }
+    if (steps) *steps += count;
+    return node;
+  }
+
+  // stack of iterative traversals: node and value of node it came from
+  using VisitStack = vector<std::pair<TNode<T>*, const T*>>;
+
+  // Visits every node reachable from 'root' (itself included) over children
+  // and owns links, depth-first with an explicit stack: no recursion, and no
+  // allocation once 'stack' (reused between calls) has grown. 'epoch' must
+  // be a new traversal epoch of the forest, marking visited nodes.
+  // A child that shares the value of its parent is the same object (unowned
+  // copy on tree forests): it is traversed, but f(node) is not called again.
+  // When f returns bool, traversal stops as soon as it returns false.
+  template <class F>
+  static void visitReachable(TNode<T>* root, unsigned epoch,
+                             VisitStack& stack, F&& f) {
+    stack.clear();
+    if (!root) return;
+    root->epoch = epoch;
+    stack.emplace_back(root, nullptr);
+    while (!stack.empty()) {
+      auto [node, from] = stack.back();
+      stack.pop_back();
+      const T* value = node->value.get();
+      if (value != from) {
+        if constexpr (std::is_same_v<decltype(f(*node)), bool>) {
+          if (!f(*node)) {
+            stack.clear();
+            return;
+          }
+        } else {
+          f(*node);
+        }
+      }
+      // pushed in reverse, so children (then owned nodes) come out in order
+      for (auto it = node->owns.rbegin(); it != node->owns.rend(); ++it) {
+        TNode<T>* owned = it->lock().get();
+        if (!owned || owned->epoch == epoch) continue;
+        owned->epoch = epoch;
+        stack.emplace_back(owned, nullptr);
+      }
+      for (auto it = node->children.rbegin(); it != node->children.rend();
+           ++it) {
+        TNode<T>* child = it->get();
+        if (child->epoch == epoch) continue;
+        child->epoch = epoch;
+        stack.emplace_back(child, value);
+      }
+    }
+  }
+
+  // Every node reachable from 'root' over children and owns links (unowned
+  // copies and their children included) is marked with 'epoch' (a new
+  // traversal epoch of the forest) and appended to 'out', breadth-first.
+  static void collectReachable(TNode<T>* root, unsigned epoch,
+                               vector<TNode<T>*>& out) {
+    out.clear();
+    if (!root) return;
+    root->epoch = epoch;
+    out.push_back(root);
+    auto push = [&](TNode<T>* node) {
+      if (!node || node->epoch == epoch) return;
+      node->epoch = epoch;
+      out.push_back(node);
+    };
+    for (std::size_t i = 0; i < out.size(); i++) {
+      TNode<T>* node = out[i];
+      for (auto& w : node->owns) push(w.lock().get());
+      for (auto& child : node->children) push(child.get());
+    }
+  }
+
+  // Number of weak links into 'nodes' (marked with 'epoch', see
+  // collectReachable) from nodes out of them
+  static long countIncoming(const vector<TNode<T>*>& nodes, unsigned epoch) {
+    long count = 0;
+    for (TNode<T>* node : nodes) {
+      for (auto& w : node->owned_by) {
+        auto owner = w.lock();
+        if (owner && (owner->epoch != epoch)) count++;
+      }
+    }
+    return count;
+  }
+
+  // Whether 'node', or one of its tree ancestors, holds 'value' (tree
+  // forests: a strong ancestor owns node). If 'steps' is given, number of
+  // visited ancestors is added to it.
+  static bool hasAncestorValue(TNode<T>* node, const T* value,
+                               long* steps = nullptr) {
+    long count = 0;
+    sptr<TNode<T>> ancestor;
+    while (node && (node->value.get() != value)) {
+      ancestor = node->parent.lock();
+      node = ancestor.get();
+      count++;
+    }
+    if (steps) *steps += count;
+    return node != nullptr;
+  }
+
+  // Whether node holding 'value' reaches 'target' over children and owns
+  // links (true when 'target' holds 'value' itself). Search goes backward
+  // from 'target', over parent and owned_by links (usually far less nodes
+  // than forward), marking visited nodes with 'epoch' (a new traversal epoch
+  // of the forest). Search gives up after 'max_visits' nodes (0: no limit).
+  static Reachability findOwner(TNode<T>* target, const T* value,
+                                unsigned epoch, VisitStack& stack,
+                                long max_visits = 0) {
+    stack.clear();
+    if (!target || !value) return Reachability::UNREACHABLE;
+    auto push = [&](TNode<T>* node) {
+      if (!node || node->epoch == epoch) return;
+      node->epoch = epoch;
+      stack.emplace_back(node, nullptr);
+    };
+    push(target);
+    // unowned copy on tree forests: same object is also on its child
+    for (auto& child : target->children)
+      if (child->value == target->value) push(child.get());
+    long visits = 0;
+    while (!stack.empty()) {
+      TNode<T>* node = stack.back().first;
+      stack.pop_back();
+      if (node->value.get() == value) {
+        stack.clear();
+        return Reachability::REACHABLE;
+      }
+      if ((max_visits > 0) && (++visits > max_visits)) {
+        stack.clear();
+        return Reachability::UNKNOWN;
+      }
+      push(node->parent.lock().get());
+      for (auto& owner : node->owned_by) push(owner.lock().get());
+    }
+    return Reachability::UNREACHABLE;
+  }
+
+  // If 'removed' is given, number of removed links is added to it (checked
+  // mode only).
   static bool cleanOwnsAndOwnedByLists(sptr<TNode<T>> sptr_mynode,
-                                       bool unchecked = false) {
+                                       bool unchecked = false,
+                                       long* removed = nullptr) {
     //
     // clean owns and owned_by list before continuing
     //
@@ -398,6 +588,7 @@ class TNodeHelper {
         assert(final_other_ownedby_count == other_ownedby_count);
       }
       assert(final_other_owns_count == other_owns_count - 1);
+      if (removed) (*removed)++;
     }  // end while
 
     assert(sptr_mynode->owned_by.size() == 0);
@@ -438,6 +629,7 @@ class TNodeHelper {
       assert(final_my_owns_count == my_owns_count - 1);
       assert(final_other_ownedby_count == other_ownedby_count - 1);
       assert(final_other_owns_count == other_owns_count);
+      if (removed) (*removed)++;
     }  // end while
     assert(sptr_mynode->owns.size() == 0);
     // sptr_mynode->owns.clear();
@@ -445,20 +637,22 @@ class TNodeHelper {
   }
 
   // remove me from the 'owns' list of myNewParent owner
+  // Order of 'owns' is not relevant, so last entry takes removed position
+  // (erase would shift whole list, making cleanup of large lists O(n^2)).
   static bool removeFromOwnsList(sptr<TNode<T>> sptrOwner,
                                  sptr<TNode<T>> sptrOwned) {
     assert(sptrOwner->owns.size() > 0);
-    bool removed = false;
-    for (unsigned i = 0; i < sptrOwner->owns.size(); i++) {
+    auto& owns = sptrOwner->owns;
+    for (unsigned i = 0; i < owns.size(); i++) {
       //
-      if (sptrOwner->owns[i].lock().get() == sptrOwned.get()) {
+      if (owns[i].lock().get() == sptrOwned.get()) {
         //
-        sptrOwner->owns.erase(sptrOwner->owns.begin() + i);
-        removed = true;
-        break;
+        if (i + 1 < owns.size()) owns[i] = std::move(owns.back());
+        owns.pop_back();
+        return true;
       }
     }
-    return removed;
+    return false;
   }
 
   // remove other from my 'owned_by' list of sptr_myWeakOwner owner
@@ -19,6 +19,24 @@ namespace cycles {
 
 namespace detail {
 
+// collection strategy for removals of parent links inside a Tree
+// - EAGER:    repair immediately (op4x_trySetNewOwner), default behavior
+// - DEFERRED: detach orphan subtree and decide it on next trace
+enum class TreeCollectMode { EAGER, DEFERRED };
+
+// snapshot of per-tree statistics (see DynowForestV1::getTreeStats)
+struct TreeStats {
+  const void* root{nullptr};  // identity of tree (its root node)
+  TreeCollectMode mode{TreeCollectMode::EAGER};
+  int size{1};                     // nodes seen on last trace
+  int removals{0};                 // parent-link removals (eager + deferred)
+  int deferred_removals{0};        // parent-link removals done deferred
+  double weak_link_density{0.0};   // avg |owned_by| of repaired nodes
+  double avg_repair_cost{0.0};     // avg eager cost (ancestors visited)
+  double trace_cost_estimate{0.0}; // estimated trace cost per removal
+  int height{0};                   // longest parent chain (root is 0)
+};
+
 // default is now type-erased T
 template <typename T = TNodeData>
 struct Tree {
@@ -26,6 +44,17 @@ struct Tree {
   sptr<TNode<T>> root;  // owned reference
   bool debug_flag{false};
   //
+  // ===========================
+  // => adaptive collection (statistics for this tree)
+  TreeCollectMode mode{TreeCollectMode::EAGER};
+  int size{1};
+  int removals{0};
+  int deferred_removals{0};
+  int eager_repairs{0};
+  long weak_links_seen{0};
+  // moving average of eager repair cost (ancestors visited per removal)
+  double avg_repair_cost{0.0};
+  //
   // wptr<TNode<T>> tail_node; // DAG behavior, but... non-owning
 
   explicit Tree(bool _debug_flag = false)
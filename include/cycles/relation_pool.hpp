@@ -5,12 +5,22 @@
 #define CYCLES_RELATION_POOL_HPP_  // NOLINT
 
 // C++
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
 #include <map>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 //
+#include <cycles/detail/OpTrace.hpp>
+#include <cycles/detail/Snapshot.hpp>
 #include <cycles/detail/v1/DynowForestV1.hpp>
 
 using std::vector, std::ostream, std::map;  // NOLINT
@@ -44,21 +54,55 @@ class relation_pool {
  private:
   // TODO(igormcoelho): ensure ctx behaves like "unique_ptr"? or allow this to
   // live as long as dependent relation_ptr exists?
-  // ==== Implementation using DynowForestV1 ====
-  sptr<DynowForestV1> ctx;
+  // ==== Implementation using DOF (default is DynowForestV1) ====
+  sptr<DOF> ctx;
+  // contexts of absorbed pools, forwarding to 'ctx' (kept alive here, as
+  // relations may only hold them weakly, see WEAK_POOL_PTR)
+  vector<sptr<DOF>> absorbed;
+
+  // adapts visitor(T&) (or visitor(void*) with T = void) to forest nodes,
+  // skipping objects created with other types
+  template <class T, class F>
+  static auto typed_visitor(F& visitor) {
+    return [&visitor](TNode<TNodeData>& node) {
+      const TNodeData* data = node.value.get();
+      if (!data || !data->p) return;
+      void* p = const_cast<void*>(data->p);  // NOLINT
+      if constexpr (std::is_void_v<T>)
+        visitor(p);
+      else if (data->type == TypeDescriptor::of<T>())
+        visitor(*static_cast<T*>(p));
+    };
+  }
+
+  // drops contexts of absorbed pools (forwarding to a context being
+  // dropped): relations still holding them find them empty
+  void clear_absorbed() {
+    for (auto& old : absorbed) old->destroyAll();
+    absorbed.clear();
+  }
+
+  // object of node 'w' (null if node is gone)
+  static sptr<TNodeData> value_of(const wptr<TNode<TNodeData>>& w) {
+    auto node = w.lock();
+    return node ? node->value : nullptr;
+  }
 
  public:
   // default constructor
-  relation_pool() : ctx{new DynowForestV1{}} {}
+  relation_pool() : ctx{new DOF{}} {}
 
   // move only
-  relation_pool(relation_pool&& corpse) noexcept : ctx{std::move(corpse.ctx)} {
+  relation_pool(relation_pool&& corpse) noexcept
+      : ctx{std::move(corpse.ctx)}, absorbed{std::move(corpse.absorbed)} {
     corpse.ctx = nullptr;
   }
 
   // move only
   relation_pool& operator=(relation_pool&& corpse) noexcept {
+    clear_absorbed();
     this->ctx = std::move(corpse.ctx);
+    this->absorbed = std::move(corpse.absorbed);
     corpse.ctx = nullptr;
     return *this;
   }
@@ -78,16 +122,544 @@ class relation_pool {
 
   void setDebug(bool b) { ctx->setDebug(b); }
 
+  // adaptive per-tree collection strategy (forests that support it)
+  void setAdaptive(bool b) { ctx->setAdaptive(b); }
+
+  // per-tree statistics (forests that support adaptive collection)
+  auto tree_stats() const { return ctx->getTreeStats(); }
+
+  // snapshot of forest counters (forests that support it)
+  auto stats() const { return ctx->getStats(); }
+
+  // pause histograms of collections and of removals that triggered auto
+  // collect (forests that support it)
+  auto pause_stats() const { return ctx->getPauseStats(); }
+
+  // starts a new interval of pause histograms (forests that support it)
+  void reset_pause_stats() { ctx->resetPauseStats(); }
+
+  // live objects per type and metadata overhead (forests that support it)
+  auto memory_report() const { return ctx->getMemoryReport(); }
+
+  // ownership path that keeps 'ptr' alive, from its node up to a tree root
+  // (forests that support it)
+  template <class T>
+  auto explain_retention(const relation_ptr<T, DOF>& ptr) const {
+    return ctx->explainRetention(ptr.arrow);
+  }
+
+  // calls visitor(T&) once for every object of type T reachable from 'root'
+  // (itself included) over owned relations, iteratively and without
+  // allocation (see TNodeHelper::visitReachable). Objects created with other
+  // types are traversed, but not visited (with T = void, visitor(void*) gets
+  // every object). Visitor must not create or drop relations, nor start
+  // another traversal on this pool.
+  template <class T, class F>
+  void for_each_reachable(const relation_ptr<T, DOF>& root, F&& visitor) {
+    ctx->forEachReachable(root.arrow, typed_visitor<T>(visitor));
+  }
+
+  // for_each_reachable on 'threads' workers (0: hardware concurrency), with
+  // work stealing and atomic visit marks (see workStealingRun). Visitor is
+  // called concurrently and must be thread-safe. Pool is frozen during the
+  // traversal: creating or dropping relations of this pool (on visitor or on
+  // any other thread) is an error (assert on debug builds).
+  template <class T, class F>
+  void parallel_for_each_reachable(const relation_ptr<T, DOF>& root,
+                                   const F& visitor, int threads = 0) {
+    if (threads <= 0)
+      threads = static_cast<int>(std::thread::hardware_concurrency());
+    struct Unfreeze {
+      std::atomic<int>& frozen;
+      ~Unfreeze() { frozen--; }
+    } unfreeze{ctx->frozen};
+    ctx->frozen++;
+    auto f = typed_visitor<T>(visitor);
+    if (threads <= 1)
+      ctx->forEachReachable(root.arrow, f);
+    else
+      ctx->parallelForEachReachable(root.arrow, threads, f);
+  }
+
+  // whether 'b' is owned by 'a', directly or through other objects (or 'b'
+  // is 'a'), i.e., 'b' is visited by for_each_reachable(a). Tree forests
+  // check tree ancestors of 'b' first, then search goes backward from 'b'
+  // over its owners (see TNodeHelper::findOwner).
+  template <class A, class B>
+  bool owns_transitively(const relation_ptr<A, DOF>& a,
+                         const relation_ptr<B, DOF>& b) {
+    return reachability(a, b) == Reachability::REACHABLE;
+  }
+
+  // same query as owns_transitively, but search gives up (UNKNOWN) after
+  // visiting 'max_visits' nodes (0: no limit)
+  template <class A, class B>
+  Reachability reachability(const relation_ptr<A, DOF>& a,
+                            const relation_ptr<B, DOF>& b,
+                            long max_visits = 0) {
+    return ctx->getReachability(a.arrow, b.arrow, max_visits);
+  }
+
+  // owns_transitively on many pairs (a, b). Pairs with the same 'a' share a
+  // single forward traversal from 'a', stopped once all their 'b' are found.
+  // Pairs with a null 'a' or 'b' (pointer or relation) are false.
+  template <class A, class B>
+  std::vector<bool> owns_transitively(
+      const vector<std::pair<const relation_ptr<A, DOF>*,
+                             const relation_ptr<B, DOF>*>>& queries) {
+    std::vector<bool> result(queries.size(), false);
+    auto node_of = [](const auto* ptr) {
+      return ptr ? ptr->arrow.remote_node.lock().get() : nullptr;
+    };
+    vector<std::pair<TNode<TNodeData>*, std::size_t>> order;
+    for (std::size_t i = 0; i < queries.size(); i++)
+      order.emplace_back(node_of(queries[i].first), i);
+    std::sort(order.begin(), order.end());
+    vector<const TNodeData*> wanted;
+    vector<char> found;
+    for (std::size_t g = 0, h = 0; g < order.size(); g = h) {
+      while ((h < order.size()) && (order[h].first == order[g].first)) h++;
+      if (!order[g].first) continue;
+      const auto& source = *queries[order[g].second].first;
+      if (h - g == 1) {
+        const auto* target = queries[order[g].second].second;
+        if (target)
+          result[order[g].second] = owns_transitively(source, *target);
+        continue;
+      }
+      wanted.clear();
+      for (std::size_t k = g; k < h; k++) {
+        auto* target = node_of(queries[order[k].second].second);
+        if (target) wanted.push_back(target->value.get());
+      }
+      std::sort(wanted.begin(), wanted.end());
+      wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+      found.assign(wanted.size(), 0);
+      std::size_t left = wanted.size();
+      auto index_of = [&](const TNodeData* value) {
+        auto it = std::lower_bound(wanted.begin(), wanted.end(), value);
+        return ((it != wanted.end()) && (*it == value))
+                   ? static_cast<long>(it - wanted.begin())
+                   : -1L;
+      };
+      ctx->forEachReachable(source.arrow, [&](TNode<TNodeData>& node) {
+        long i = index_of(node.value.get());
+        if ((i >= 0) && !found[i]) {
+          found[i] = 1;
+          left--;
+        }
+        return left > 0;
+      });
+      for (std::size_t k = g; k < h; k++) {
+        auto* target = node_of(queries[order[k].second].second);
+        if (!target) continue;
+        result[order[k].second] = found[index_of(target->value.get())];
+      }
+    }
+    return result;
+  }
+
+  // Deep copy of every object reachable from 'root' (see for_each_reachable)
+  // into pool 'target', returning the copy of 'root' (unowned). Each object
+  // is copied once, by copy_fn(const T& obj, remap) returning a new T*, and
+  // relations among copies are created in bulk (see DOF::addSubgraph), not
+  // by op1 to op3. On copy_fn, remap(ptr) gives the relation of the copy
+  // matching owned relation 'ptr' of 'obj' (null if 'ptr' is null or
+  // unowned). Each copied relation is given once: remapping more relations
+  // between two objects than there are gives null, and copied relations
+  // never remapped are dropped after copy_fn (so their targets may be
+  // collected). Every reachable object must be of type T, otherwise nothing
+  // is copied and null is returned.
+  template <class T, class F>
+  relation_ptr<T, DOF> clone_reachable(const relation_ptr<T, DOF>& root,
+                                       relation_pool& target, F&& copy_fn) {
+    static_assert(!std::is_void_v<T>, "clone_reachable requires object type");
+    relation_ptr<T, DOF> result;
+    // objects by value, and nodes of each object (an unowned copy on tree
+    // forests shares value with its child)
+    std::unordered_map<const TNodeData*, std::size_t> index;
+    vector<const TNodeData*> values;
+    vector<std::pair<TNode<TNodeData>*, std::size_t>> members;
+    std::unordered_set<const TNode<TNodeData>*> listed;
+    auto add_member = [&](TNode<TNodeData>* node) {
+      if (!listed.insert(node).second) return;
+      const TNodeData* data = node->value.get();
+      auto it = index.emplace(data, values.size()).first;
+      if (it->second == values.size()) values.push_back(data);
+      members.emplace_back(node, it->second);
+    };
+    bool typed = true;
+    ctx->forEachReachable(root.arrow, [&](TNode<TNodeData>& node) {
+      const TNodeData* data = node.value.get();
+      typed = data && data->p && (data->type == TypeDescriptor::of<T>());
+      if (!typed) return false;
+      add_member(&node);
+      for (auto& child : node.children)
+        if (child->value == node.value) add_member(child.get());
+      return true;
+    });
+    if (!typed || values.empty()) return result;
+    vector<std::pair<std::size_t, std::size_t>> links;
+    // copied relations not yet given by remap, per pair of objects
+    std::map<std::pair<std::size_t, std::size_t>, long> unclaimed;
+    for (auto [node, u] : members) {
+      for (auto& w : node->owns)
+        if (auto owned = w.lock())
+          links.emplace_back(u, index.at(owned->value.get()));
+      for (auto& child : node->children)
+        if (child->value != node->value)
+          links.emplace_back(u, index.at(child->value.get()));
+    }
+    for (const auto& link : links) unclaimed[link]++;
+    // root is first visited object
+    vector<sptr<TNode<TNodeData>>> copies;
+    auto arrow = target.ctx->addSubgraph(values.size(), links, 0, copies);
+    result.ctx = target.ctx;
+    result.arrow = arrow;
+    auto arrow_of = [&](std::size_t u, std::size_t t) {
+      TArrowV1<TNodeData> copy;
+      copy.owned_by_node = copies[u];
+      copy.remote_node = copies[t];
+      copy.is_owned_by_node = true;
+      return copy;
+    };
+    auto remap = [&](const auto& ptr) {
+      std::decay_t<decltype(ptr)> copy;
+      if (!ptr.arrow.is_owned()) return copy;
+      auto owner = ptr.arrow.owned_by_node.lock();
+      auto owned = ptr.arrow.remote_node.lock();
+      if (!owner || !owned) return copy;
+      auto u = index.find(owner->value.get());
+      auto t = index.find(owned->value.get());
+      if ((u == index.end()) || (t == index.end())) return copy;
+      auto left = unclaimed.find({u->second, t->second});
+      if ((left == unclaimed.end()) || (left->second == 0)) return copy;
+      left->second--;
+      copy.ctx = target.ctx;
+      copy.arrow = arrow_of(u->second, t->second);
+      return copy;
+    };
+    for (std::size_t i = 0; i < values.size(); i++) {
+      T* obj = copy_fn(*static_cast<const T*>(values[i]->p), remap);
+      copies[i]->value = TNodeData::make_data(obj);
+    }
+    // no relation holds these: drop them as relation_ptr::destroy would
+    // (copies are only held by target from now on, and are collected after
+    // all are dropped, as some may die on the way)
+    vector<TArrowV1<TNodeData>> dropped;
+    for (const auto& [link, left] : unclaimed)
+      for (long k = 0; k < left; k++)
+        dropped.push_back(arrow_of(link.first, link.second));
+    copies.clear();
+    if (dropped.empty()) return result;
+    bool auto_collect = target.ctx->getAutoCollect();
+    target.ctx->setAutoCollect(false);
+    for (auto& arc : dropped) {
+      target.ctx->markChanged(arc);
+      target.ctx->op4_remove(arc);
+    }
+    target.ctx->setAutoCollect(auto_collect);
+    return result;
+  }
+
+  // Moves every object of pool 'other' into this pool (see DOF::absorb): on
+  // tree forests, only maps of trees are merged. Relations of 'other' are not
+  // touched: its old context forwards to this pool (see relation_ptr::
+  // get_ctx), and 'other' gets a new empty context. Contexts absorbed
+  // earlier by 'other' forward directly to this pool too, so forwarding is
+  // always a single hop. Neither pool may be frozen, and both must be used
+  // by a single thread during absorb. Cross-pool relations into 'other'
+  // (see relation_ptr::get_owned_external) cannot follow its objects: then
+  // nothing is absorbed and false is returned (also when 'other' is this
+  // pool).
+  bool absorb(relation_pool&& other) {
+    if (!other.ctx || (other.ctx == ctx)) return false;
+    assert(!ctx->isFrozen() && !other.ctx->isFrozen());
+    if (!other.ctx->dropExternalAnchor()) return false;
+    ctx->absorb(*other.ctx);
+    other.ctx->absorbed_by = ctx;
+    absorbed.push_back(std::move(other.ctx));
+    for (auto& old : other.absorbed) {
+      old->absorbed_by = ctx;
+      absorbed.push_back(std::move(old));
+    }
+    other.absorbed.clear();
+    other.ctx = sptr<DOF>{new DOF{}};
+    return true;
+  }
+
+  // Moves unowned 'root' and every object reachable from it (see
+  // for_each_reachable) to pool 'dest', without reallocating nodes (see
+  // DOF::moveReachable), and returns the moved root ('root' becomes null).
+  // Subgraph must be exclusive: when relations of other objects, or other
+  // unowned relations, point into it (or 'root' is owned), nothing is moved,
+  // 'root' is kept, null is returned and the number of such crossing
+  // relations goes to 'crossing'. Relations held by moved objects must join
+  // 'dest' too: rehome_fn(T& obj, rehome) must call rehome(ptr) on each of
+  // them. Every reachable object must be of type T, otherwise nothing is
+  // moved. Both pools must be used by a single thread during transfer.
+  template <class T, class F>
+  relation_ptr<T, DOF> transfer(relation_ptr<T, DOF>&& root,
+                                relation_pool& dest, F&& rehome_fn,
+                                long* crossing = nullptr) {
+    static_assert(!std::is_void_v<T>, "transfer requires object type");
+    relation_ptr<T, DOF> result;
+    if (crossing) *crossing = 0;
+    if (!root || (root.get_ctx() != ctx)) return result;
+    if (dest.ctx == ctx) return std::move(root);
+    if (!root.arrow.is_root()) {
+      if (crossing) *crossing = 1;
+      return result;
+    }
+    assert(!ctx->isFrozen() && !dest.ctx->isFrozen());
+    bool typed = true;
+    ctx->forEachReachable(root.arrow, [&](TNode<TNodeData>& node) {
+      const TNodeData* data = node.value.get();
+      typed = data && data->p && (data->type == TypeDescriptor::of<T>());
+      return typed;
+    });
+    if (!typed) return result;
+    long incoming = ctx->moveReachable(root.arrow, *dest.ctx);
+    if (crossing) *crossing = incoming;
+    if (incoming > 0) return result;
+    result.ctx = dest.ctx;
+    result.arrow = std::move(root.arrow);
+    root.arrow = typename relation_ptr<T, DOF>::arrow_type{};
+    root.ctx = nullptr;
+    auto rehome = [&](auto& ptr) {
+      if (ptr.get_ctx() == ctx) ptr.ctx = dest.ctx;
+    };
+    dest.ctx->forEachReachable(result.arrow, [&](TNode<TNodeData>& node) {
+      void* p = const_cast<void*>(node.value->p);  // NOLINT
+      rehome_fn(*static_cast<T*>(p), rehome);
+    });
+    return result;
+  }
+
+  // Writes 'root' and every object reachable from it over relations given
+  // by 'project' into binary snapshot file at 'path' (see SnapshotWriter).
+  // project(const T& obj, link) returns a trivially copyable payload of
+  // 'obj', and calls link(ptr) on each owned relation 'ptr' of 'obj' to be
+  // saved (in order, duplicates included). link returns false (and skips
+  // 'ptr') when 'ptr' is null, not owned by 'obj' or from another pool.
+  // Objects are numbered in breadth-first order (root is 0), and get stable
+  // ids (see ChangeTracking::checkpointId). A new snapshot is the base of next
+  // checkpoint_delta. Returns false if 'root' is null or file cannot be
+  // written.
+  template <class T, class F>
+  bool save_snapshot(const relation_ptr<T, DOF>& root, const std::string& path,
+                     F&& project) {
+    static_assert(!std::is_void_v<T>, "save_snapshot requires object type");
+    if (!root || (root.get_ctx() != ctx)) return false;
+    std::unordered_map<const TNodeData*, std::uint32_t> index;
+    vector<sptr<TNodeData>> values;
+    auto number = [&](sptr<TNodeData> data) {
+      auto id = static_cast<std::uint32_t>(values.size());
+      auto it = index.emplace(data.get(), id).first;
+      if (it->second == id) values.push_back(std::move(data));
+      return it->second;
+    };
+    number(value_of(root.arrow.remote_node));
+    vector<std::uint64_t> offsets{0};
+    vector<std::uint32_t> targets;
+    vector<std::uint64_t> ids;
+    const TNodeData* current = nullptr;
+    auto link = [&](const relation_ptr<T, DOF>& ptr) {
+      if (!ptr || !ptr.arrow.is_owned() || (ptr.get_ctx() != ctx) ||
+          (value_of(ptr.arrow.owned_by_node).get() != current))
+        return false;
+      targets.push_back(number(value_of(ptr.arrow.remote_node)));
+      return true;
+    };
+    using P = std::decay_t<decltype(project(std::declval<const T&>(), link))>;
+    static_assert(std::is_trivially_copyable_v<P>,
+                  "snapshot payload must be trivially copyable");
+    vector<P> payload;
+    for (std::size_t i = 0; i < values.size(); i++) {
+      if (values.size() >= UINT32_MAX) return false;
+      current = values[i].get();
+      payload.push_back(project(*static_cast<const T*>(current->p), link));
+      offsets.push_back(targets.size());
+      ids.push_back(ctx->assignCheckpointId(values[i]));
+    }
+    if (!SnapshotWriter::write(path, offsets, targets, ids, payload.data(),
+                               sizeof(P), alignof(P)))
+      return false;
+    ctx->takeChanges();
+    return true;
+  }
+
+  // Rebuilds objects of snapshot file at 'path' (see save_snapshot) on this
+  // pool, returning root (unowned), or null when file is not a valid
+  // snapshot of payload type P. File is mapped in memory (see
+  // SnapshotImage) and relations are created in bulk (see DOF::addSubgraph),
+  // not by op1 to op3. restore(const P& payload, links) returns a new T*,
+  // and links(k) gives its k-th saved relation (k < links.size()). Every
+  // saved relation should be taken once: the others still keep their
+  // targets alive while object lives. Objects keep their stable ids, so
+  // load on an empty pool to continue checkpoints of a snapshot.
+  template <class T, class P, class F>
+  relation_ptr<T, DOF> load_snapshot(const std::string& path, F&& restore) {
+    static_assert(!std::is_void_v<T>, "load_snapshot requires object type");
+    static_assert(std::is_trivially_copyable_v<P>,
+                  "snapshot payload must be trivially copyable");
+    relation_ptr<T, DOF> result;
+    SnapshotImage image;
+    if (!image.open(path)) return result;
+    const SnapshotHeader& h = image.header();
+    if ((h.payload_size != sizeof(P)) || (h.payload_align != alignof(P)))
+      return result;
+    const std::uint64_t* offsets = image.offsets();
+    const std::uint32_t* targets = image.targets();
+    vector<std::pair<std::size_t, std::size_t>> links;
+    links.reserve(h.links);
+    for (std::size_t i = 0; i < h.nodes; i++)
+      for (std::uint64_t k = offsets[i]; k < offsets[i + 1]; k++)
+        links.emplace_back(i, targets[k]);
+    vector<sptr<TNode<TNodeData>>> nodes;
+    result.ctx = ctx;
+    result.arrow = ctx->addSubgraph(h.nodes, links, 0, nodes);
+    // saved relations of a single object
+    struct Links {
+      const sptr<DOF>& ctx;
+      const vector<sptr<TNode<TNodeData>>>& nodes;
+      const sptr<TNode<TNodeData>>& owner;
+      const std::uint32_t* first;
+      std::size_t count;
+
+      std::size_t size() const { return count; }
+
+      relation_ptr<T, DOF> operator()(std::size_t k) const {
+        relation_ptr<T, DOF> ptr;
+        if (k >= count) return ptr;
+        ptr.ctx = ctx;
+        ptr.arrow.owned_by_node = owner;
+        ptr.arrow.remote_node = nodes[first[k]];
+        ptr.arrow.is_owned_by_node = true;
+        return ptr;
+      }
+    };
+    const std::uint64_t* ids = image.ids();
+    for (std::size_t i = 0; i < h.nodes; i++) {
+      Links saved{ctx, nodes, nodes[i], targets + offsets[i],
+                  static_cast<std::size_t>(offsets[i + 1] - offsets[i])};
+      const P& p = *static_cast<const P*>(image.payload(i));
+      nodes[i]->value = TNodeData::make_data(restore(p, saved));
+      ctx->setCheckpointId(nodes[i]->value, ids[i]);
+    }
+    return result;
+  }
+
+  // starts (or stops) tracking changed objects for checkpoint_delta (see
+  // ChangeTracking::markChanged)
+  void track_changes(bool b = true) { ctx->setTrackChanges(b); }
+
+  // object of 'ptr' changed (e.g., its payload): saved on next
+  // checkpoint_delta
+  template <class T>
+  void mark_changed(const relation_ptr<T, DOF>& ptr) {
+    if (!ptr || (ptr.get_ctx() != ctx)) return;
+    if (auto node = ptr.arrow.remote_node.lock()) ctx->markChanged(node->value);
+  }
+
+  // Writes changes since last save_snapshot (or load_snapshot) or
+  // checkpoint_delta into 'out' (see SnapshotDelta), while tracking changes
+  // (see track_changes). Objects marked by relation_ptr operations or by
+  // mark_changed are saved again by 'project' (see save_snapshot), with
+  // relations by stable id, and marked objects now gone are listed as
+  // removed. New objects targeted by saved relations are saved too.
+  // Re-parenting inside forest changes no record: trees are rebuilt on
+  // load. Marked objects of other types than T are skipped. Relations moved
+  // by absorb or transfer are not tracked (save a new snapshot instead).
+  // Returns false if not tracking, 'root' is null or 'out' fails.
+  template <class T, class F>
+  bool checkpoint_delta(const relation_ptr<T, DOF>& root, std::ostream& out,
+                        F&& project) {
+    static_assert(!std::is_void_v<T>, "checkpoint_delta requires object type");
+    if (!ctx->isTrackingChanges() || !root || (root.get_ctx() != ctx))
+      return false;
+    SnapshotDelta delta;
+    vector<sptr<TNodeData>> saved;
+    // saved objects have ids, and new ones are saved once
+    auto id_of = [&](const sptr<TNodeData>& data) {
+      std::uint64_t id = ctx->checkpointId(data.get());
+      if (id == 0) {
+        id = ctx->assignCheckpointId(data);
+        saved.push_back(data);
+      }
+      return id;
+    };
+    for (auto& [w, id] : ctx->takeChanges()) {
+      auto data = w.lock();
+      if (!data) {
+        if (id != 0) delta.removed.push_back(id);
+      } else if (data->p && (data->type == TypeDescriptor::of<T>())) {
+        if (ctx->checkpointId(data.get()) == 0)
+          id_of(data);
+        else
+          saved.push_back(data);
+      }
+    }
+    delta.root = id_of(value_of(root.arrow.remote_node));
+    const TNodeData* current = nullptr;
+    auto link = [&](const relation_ptr<T, DOF>& ptr) {
+      if (!ptr || !ptr.arrow.is_owned() || (ptr.get_ctx() != ctx) ||
+          (value_of(ptr.arrow.owned_by_node).get() != current))
+        return false;
+      delta.targets.push_back(id_of(value_of(ptr.arrow.remote_node)));
+      return true;
+    };
+    using P = std::decay_t<decltype(project(std::declval<const T&>(), link))>;
+    static_assert(std::is_trivially_copyable_v<P>,
+                  "snapshot payload must be trivially copyable");
+    delta.payload_size = sizeof(P);
+    delta.payload_align = alignof(P);
+    for (std::size_t i = 0; i < saved.size(); i++) {
+      current = saved[i].get();
+      P p = project(*static_cast<const T*>(current->p), link);
+      const char* bytes = reinterpret_cast<const char*>(&p);  // NOLINT
+      delta.payload.insert(delta.payload.end(), bytes, bytes + sizeof(P));
+      delta.ids.push_back(ctx->checkpointId(current));
+      delta.offsets.push_back(delta.targets.size());
+    }
+    return delta.write(out);
+  }
+
+  // 'k' nodes retaining largest strong subtrees (forests that support it)
+  auto top_retainers(int k = 10) const { return ctx->getTopRetainers(k); }
+
+  // rebuild trees as breadth-first spanning trees over owned relations
+  // (forests that support it). Returns number of re-parented nodes.
+  int optimize() { return ctx->optimize(); }
+
+  // logs every forest operation into binary trace file at 'path' (see
+  // OpTraceReplayer). Context is replaced, so this must be invoked on an empty
+  // pool, before any configuration. Returns false if file cannot be created.
+  bool start_recording(const std::string& path) {
+    sptr<RecordingForest<DOF>> rec{new RecordingForest<DOF>{}};
+    if (!rec->open(path)) return false;
+    if (ctx) ctx->destroyAll();
+    ctx = rec;
+    return true;
+  }
+
+  // closes trace file (operations are no longer recorded)
+  void stop_recording() {
+    auto* rec = dynamic_cast<RecordingForest<DOF>*>(ctx.get());
+    if (rec) rec->close();
+  }
+
   // internal structure... TODO(igormcoelho): provide this as wptr or sptr?
   auto getContext() const { return ctx; }
 
   void clear() {
     // force destruction (beware: ctx could have been moved)
     if (ctx) ctx->destroyAll();
+    clear_absorbed();
     // clear context
     ctx = nullptr;
     // start again
-    ctx = sptr<DynowForestV1>{new DynowForestV1{}};
+    ctx = sptr<DOF>{new DOF{}};
   }
 
   // DOF comes from this pool... T comes explicitly
@@ -51,11 +51,19 @@ class relation_ptr {
 
  public:
 #ifdef WEAK_POOL_PTR
-  sptr<DOF> get_ctx() const { return ctx.lock(); }
+  sptr<DOF> get_ctx() const { return resolve(ctx.lock()); }
 #else
-  sptr<DOF> get_ctx() const { return ctx; }
+  sptr<DOF> get_ctx() const { return resolve(ctx); }
 #endif
 
+  // context of an absorbed pool forwards to the pool that absorbed it (a
+  // single hop: relation_pool::absorb keeps forwarding flat)
+  static sptr<DOF> resolve(sptr<DOF> c) {
+    if (c && c->absorbed_by) c = std::static_pointer_cast<DOF>(c->absorbed_by);
+    assert(!c || !c->absorbed_by);
+    return c;
+  }
+
   // ======= C[-1] constructor (weak self) ======
   // struct weak_self {};
   //
@@ -98,8 +106,9 @@ class relation_ptr {
 
   // implementation for constructor C1 and C1'
   void setup_c1(T* t) {
+    auto c = get_ctx();
     // if no context or null pointer, this is null arrow
-    if ((!t) || (!get_ctx())) {
+    if ((!t) || (!c)) {
       this->arrow = arrow_type{};
       assert(arrow.is_null());
       return;
@@ -109,15 +118,19 @@ class relation_ptr {
     // sanity check on 'make_sptr'
     assert(ref);
     // using op1: we only store weak reference here
-    this->arrow = get_ctx()->op1_addNodeToNewTree(ref);
+    assert(!c->isFrozen());
+    c->drainExternal();
+    this->arrow = c->op1_addNodeToNewTree(ref);
+    c->markChanged(this->arrow);
     // sanity check on 'op1'
     assert(arrow.is_root());
   }
 
   // C2 CONSTRUCTOR - EQUIVALENT TO C1+C4
-  relation_ptr(T* t, const relation_ptr<T>& owner) : ctx{owner.ctx} {
+  relation_ptr(T* t, const relation_ptr<T, DOF>& owner) : ctx{owner.ctx} {
+    auto c = get_ctx();
     // if no context or null pointer, this is null arrow
-    if ((!t) || (!get_ctx()) || owner.arrow.is_null()) {
+    if ((!t) || (!c) || owner.arrow.is_null()) {
       this->arrow = arrow_type{};
       assert(arrow.is_null());
       return;
@@ -127,36 +140,44 @@ class relation_ptr {
     // sanity check on 'make_sptr'
     assert(ref);
     // invoke op2
-    this->arrow = get_ctx()->op2_addChildStrong(owner.arrow, ref);
+    assert(!c->isFrozen());
+    c->drainExternal();
+    this->arrow = c->op2_addChildStrong(owner.arrow, ref);
+    c->markChanged(this->arrow);
     // sanity check
     assert(this->arrow.is_owned());
   }
 
  private:
   // ======= C3 copy constructor (DELETED) =======
-  relation_ptr(const relation_ptr<T>& copy) = delete;
+  relation_ptr(const relation_ptr<T, DOF>& copy) = delete;
 
  public:
   // ======= C4 copy constructor WITH owner =======
-  relation_ptr(const relation_ptr<T>& copy, const relation_ptr<T>& owner)
+  relation_ptr(const relation_ptr<T, DOF>& copy,
+               const relation_ptr<T, DOF>& owner)
       : ctx{copy.ctx} {
+    auto c = get_ctx();
     // if no context or null pointer, this is null arrow
-    if (!get_ctx() || copy.arrow.is_null() || owner.arrow.is_null()) {
+    if (!c || copy.arrow.is_null() || owner.arrow.is_null()) {
       this->arrow = arrow_type{};
       assert(arrow.is_null());
       return;
     }
 
-    // Runtime Check: same ctx for both pointers
-    assert(get_ctx().get() == owner.get_ctx().get());
+    // Runtime Check: same ctx for both pointers (see get_owned_external)
+    assert(c == owner.get_ctx());
     //
     assert(this != &copy);   // IMPOSSIBLE
     assert(this != &owner);  // IMPOSSIBLE
+    assert(!c->isFrozen());
+    c->drainExternal();
     // ==========================================================
     // both nodes exist already (copy node and owner node)
     // register WEAK ownership in tree using 'op3_weakSetOwnedBy'
     //
-    this->arrow = get_ctx()->op3_weakSetOwnedBy(copy.arrow, owner.arrow);
+    this->arrow = c->op3_weakSetOwnedBy(copy.arrow, owner.arrow);
+    c->markOwnerChanged(this->arrow);
     // sanity check
     assert(this->arrow.is_owned());
   }
@@ -165,6 +186,9 @@ class relation_ptr {
   template <typename U, typename DOF2>
   friend class relation_ptr;
 
+  // pool may inspect arrow (see relation_pool::explain_retention)
+  friend class relation_pool<DOF>;
+
   // ======= M1 move constructor =======
   // IMPORTANT 1: allow conversion from any type U, such that U* converts to T*
   // IMPORTANT 2: do not restrict it over implicit conversions
@@ -190,11 +214,18 @@ class relation_ptr {
       // arrow will be fully cleared in next step
     } else {
       assert(this->arrow.is_root() || this->arrow.is_owned());
-      if (!this->get_ctx()) {
+      auto c = this->get_ctx();
+      if (!c) {
         std::cout << "WARNING: no context to destroy()... why this happened? ";
         std::cout << "arrow getType = " << arrow.getType() << std::endl;
+      } else if (c->isExternal(this->arrow)) {
+        // cross-pool relation may be dropped on thread of owner pool
+        c->releaseExternal(std::move(this->arrow));
       } else {
-        this->get_ctx()->op4_remove(this->arrow);
+        assert(!c->isFrozen());
+        c->drainExternal();
+        c->markChanged(this->arrow);
+        c->op4_remove(this->arrow);
       }
       // end-if is_root || is_owned
     }
@@ -233,18 +264,37 @@ class relation_ptr {
   // b is a copy of a's pointer, and relationship c->b is created
   // (so relation "c owns a", c->a, is kept on object b)
   //
-  auto get_owned(const relation_ptr<T>& owner) const {
+  auto get_owned(const relation_ptr<T, DOF>& owner) const {
     // C4 constructor
     // NOTE: this cannot be nullptr
     assert(!this->arrow.is_null());
     // NOTE: owner cannot be nullptr
     assert(!owner.arrow.is_null());
     //
-    auto r = relation_ptr<T>(*this, owner);
+    auto r = relation_ptr<T, DOF>(*this, owner);
     //
     return r;
   }
 
+  // get_owned_external: same as get_owned, for 'owner' on another pool.
+  // Cross-pool relation is owned by external anchor of this pool (see
+  // ExternalRelations::addExternal), so this pool is changed: it must run
+  // on the thread that uses this pool (checked on debug builds), while
+  // returned relation may be dropped on any thread.
+  auto get_owned_external(const relation_ptr<T, DOF>& owner) const {
+    assert(!this->arrow.is_null());
+    assert(!owner.arrow.is_null());
+    relation_ptr<T, DOF> r;
+    auto c = get_ctx();
+    if (!c) return r;
+    assert(c != owner.get_ctx());
+    assert(!c->isFrozen());
+    r.ctx = ctx;
+    r.arrow = c->addExternal(this->arrow);
+    assert(r.arrow.is_owned());
+    return r;
+  }
+
   // create self-owned reference (similar to "weak reference")
   auto get_self_owned() const {
     auto self_ptr = this->get_owned(*this);
@@ -252,15 +302,20 @@ class relation_ptr {
   }
 
   auto get_unowned() {
-    if (!get_ctx()) return relation_ptr<T>{};
-    auto arr = get_ctx()->op5_copyNodeToNewTree(this->arrow);
+    auto c = get_ctx();
+    if (!c) return relation_ptr<T, DOF>{};
+    assert(!c->isFrozen());
+    c->drainExternal();
+    auto arr = c->op5_copyNodeToNewTree(this->arrow);
     // manually create relation_ptr
-    relation_ptr<T> p{};
+    relation_ptr<T, DOF> p{};
+    // unowned copy lives in the same context (required to release it)
+    if (!arr.is_null()) p.ctx = ctx;
     p.arrow = std::move(arr);
     return p;
   }
 
-  bool operator==(const relation_ptr<T>& other) const {
+  bool operator==(const relation_ptr<T, DOF>& other) const {
     // context and pointers should be the same
     return (get_ctx() == other.get_ctx()) && (get() == other.get());
   }
@@ -278,9 +333,10 @@ class relation_ptr {
 
   // returns shared pointer to data
   sptr<T> get_shared() const {
-    if (!get_ctx()) return nullptr;
+    auto c = get_ctx();
+    if (!c) return nullptr;
     // TODO: manage other types than 'sptr<TNodeData>'
-    sptr<TNodeData> sdata = get_ctx()->op0_getSharedData(this->arrow);
+    sptr<TNodeData> sdata = c->op0_getSharedData(this->arrow);
     if (!sdata)
       return nullptr;
     else
@@ -324,19 +380,19 @@ class relation_ptr {
   // - use make_owned   if pointer is supposed to have "owner"
 
   template <class... Args>
-  static relation_ptr<T> make_unowned(const relation_pool<DOF>& pool,
+  static relation_ptr<T, DOF> make_unowned(const relation_pool<DOF>& pool,
                                       Args&&... args) {
     // NOLINTNEXTLINE
     auto* t = new T(std::forward<Args>(args)...);
-    return relation_ptr<T>{t, pool};
+    return relation_ptr<T, DOF>{t, pool};
   }
 
   template <class... Args>
-  static relation_ptr<T> make_owned(const relation_ptr<T>& owner,
+  static relation_ptr<T, DOF> make_owned(const relation_ptr<T, DOF>& owner,
                                     Args&&... args) {
     // NOLINTNEXTLINE
     auto* t = new T(std::forward<Args>(args)...);
-    return relation_ptr<T>{t, owner};
+    return relation_ptr<T, DOF>{t, owner};
   }
 };
 
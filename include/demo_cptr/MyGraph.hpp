@@ -1,6 +1,7 @@
 #pragma once
 
 // C++
+#include <atomic>
 #include <vector>
 //
 #include <cycles/relation_ptr.hpp>
@@ -9,13 +10,13 @@
 
 using namespace cycles;  // NOLINT
 
-inline int mynode_count = 0;
+inline std::atomic<int> mynode_count{0};
 
-template <typename X>
+template <typename X, class DOF = DynowForestV1>
 class MyNode {
  public:
   X val;
-  vector<relation_ptr<MyNode>> neighbors;
+  vector<relation_ptr<MyNode, DOF>> neighbors;
   bool debug_flag{false};
 
   explicit MyNode(X _val, bool _debug_flag = false)
@@ -53,19 +54,19 @@ class MyNode {
 
 // ---------
 
-template <typename X>
+template <typename X, class DOF = DynowForestV1>
 class MyGraph {
-  using MyNodeX = MyNode<X>;
+  using MyNodeX = MyNode<X, DOF>;
 
  public:
   bool debug_flag{false};
 
  private:
-  relation_pool<> pool;
+  relation_pool<DOF> pool;
 
  public:
   // Example: graph with entry, similar to a root in trees... but may be cyclic.
-  relation_ptr<MyNodeX> entry;
+  relation_ptr<MyNodeX, DOF> entry;
 
   MyGraph() {}
 
@@ -75,28 +76,28 @@ class MyGraph {
     // entry.reset();
   }
   //
-  auto my_ctx() -> wptr<relation_pool<>::pool_type> {
+  auto my_ctx() -> wptr<typename relation_pool<DOF>::pool_type> {
     return this->pool.getContext();
   }
 
-  auto make_node(X v) -> relation_ptr<MyNodeX> {
+  auto make_node(X v) -> relation_ptr<MyNodeX, DOF> {
     auto* ptr = new MyNodeX(v, debug_flag);  // NOLINT
     int nc1 = tnode_count;
-    relation_ptr<MyNodeX> cptr(ptr, this->pool);
+    relation_ptr<MyNodeX, DOF> cptr(ptr, this->pool);
     int nc2 = tnode_count;
     // checking tnode_count against possible (and crazy...) ODR errors
     assert(nc2 == nc1 + 1);
     return cptr;
   }
 
-  auto make_node_owned(X v, const relation_ptr<MyNodeX>& owner)
-      -> relation_ptr<MyNodeX> {
+  auto make_node_owned(X v, const relation_ptr<MyNodeX, DOF>& owner)
+      -> relation_ptr<MyNodeX, DOF> {
 #if 0
-    auto ptr1 = relation_ptr<MyNodeX>(this->pool.getContext(),
-                                      new MyNodeX(v, debug_flag));
+    auto ptr1 = relation_ptr<MyNodeX, DOF>(this->pool.getContext(),
+                                           new MyNodeX(v, debug_flag));
     return ptr1.get_owned(owner);
 #else
-    return relation_ptr<MyNodeX>(new MyNodeX(v, debug_flag), owner);
+    return relation_ptr<MyNodeX, DOF>(new MyNodeX(v, debug_flag), owner);
 #endif
   }
 
@@ -112,19 +113,27 @@ class MyGraph {
     std::cout << "============================ " << std::endl;
   }
 
-  void printFrom(const relation_ptr<MyNodeX>& node) {
-    if (node) {
-      std::cout << "node=" << node.get()
-                << " |neighbors|=" << node.get()->neighbors.size() << std::endl;
-
-      for (unsigned i = 0; i < node.get()->neighbors.size(); i++) {
-        if (node.get()->neighbors[i] == entry) {
-          std::cout << "WARNING: cyclic graph! stop printing..." << std::endl;
-        } else {
-          printFrom(node.get()->neighbors[i]);
-        }
-      }
-    }
+  // each reachable node is printed once (iterative, cycles included)
+  void printFrom(const relation_ptr<MyNodeX, DOF>& node) {
+    forEachFrom(node, [](const MyNodeX& n) {
+      std::cout << "node=" << &n << " |neighbors|=" << n.neighbors.size()
+                << std::endl;
+    });
+  }
+
+  // visits every node reachable from 'node' (see
+  // relation_pool::for_each_reachable)
+  template <class F>
+  void forEachFrom(const relation_ptr<MyNodeX, DOF>& node, F&& f) {
+    pool.for_each_reachable(node, f);
+  }
+
+  // same as forEachFrom, on 'threads' workers: f is called concurrently (see
+  // relation_pool::parallel_for_each_reachable)
+  template <class F>
+  void parallelForEachFrom(const relation_ptr<MyNodeX, DOF>& node, const F& f,
+                           int threads = 0) {
+    pool.parallel_for_each_reachable(node, f, threads);
   }
   //
 };
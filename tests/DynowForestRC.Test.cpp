@@ -0,0 +1,129 @@
+// #define CATCH_CONFIG_MAIN // This tells Catch to provide a main()
+#include <iostream>
+//
+#ifdef HEADER_ONLY
+#include <catch2/catch_amalgamated.hpp>
+#else
+#include <catch2/catch_all.hpp>
+#endif
+#include <cycles/detail/rc/DynowForestRC.hpp>
+#include <demo_cptr/MyGraph.hpp>
+
+using namespace std;     // NOLINT
+using namespace cycles;  // NOLINT
+
+// ==================================
+// reference counting forest tests
+// ==================================
+
+TEST_CASE("CyclesTestRC: acyclic nodes are freed on count zero") {
+  std::cout << "begin RC acyclic" << std::endl;
+  {
+    MyGraph<double, DynowForestRC> G;
+    auto ctx = G.my_ctx().lock();
+    ctx->setAutoCollect(false);
+    G.entry = G.make_node(-1.0);
+    G.entry->neighbors.push_back(G.make_node_owned(1.0, G.entry));
+    G.entry->neighbors[0]->neighbors.push_back(
+        G.make_node_owned(2.0, G.entry->neighbors[0]));
+    REQUIRE(ctx->getPoolSize() == 3);
+    REQUIRE(ctx->getRefCount(G.entry.arrow.remote_node.lock()) == 1);
+    auto u1 = G.entry->neighbors[0].get_unowned();
+    REQUIRE(ctx->getRefCount(u1.arrow.remote_node.lock()) == 2);
+    // no cycle: no collection is needed, even with auto collect disabled
+    G.entry.reset();
+    REQUIRE(mynode_count == 2);
+    REQUIRE(ctx->getBufferSize() == 1);
+    u1.reset();
+    REQUIRE(mynode_count == 0);
+    REQUIRE(ctx->getPoolSize() == 0);
+    // expired candidate is only dropped by next collect
+    ctx->collect();
+    REQUIRE(ctx->getBufferSize() == 0);
+  }
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestRC: buffered cycles are reclaimed on collect") {
+  std::cout << "begin RC buffered cycles" << std::endl;
+  {
+    MyGraph<double, DynowForestRC> G;
+    auto ctx = G.my_ctx().lock();
+    ctx->setAutoCollect(false);
+    for (int i = 0; i < 10; i++) {
+      auto ptr1 = G.make_node(i);
+      auto ptr2 = G.make_node(-i);
+      // i -> -i -> i
+      ptr1->neighbors.push_back(ptr2.get_owned(ptr1));
+      ptr2->neighbors.push_back(ptr1.get_owned(ptr2));
+    }
+    // every cycle survives, waiting on buffer
+    REQUIRE(mynode_count == 20);
+    REQUIRE(ctx->getForestSize() == 0);
+    REQUIRE(ctx->getBufferSize() > 0);
+    ctx->collect();
+    REQUIRE(mynode_count == 0);
+    REQUIRE(ctx->getPoolSize() == 0);
+    REQUIRE(ctx->getBufferSize() == 0);
+  }
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestRC: trial deletion is batched by default") {
+  std::cout << "begin RC batched trial deletion" << std::endl;
+  {
+    MyGraph<double, DynowForestRC> G;
+    auto ctx = G.my_ctx().lock();
+    const int threshold = ctx->cycle_buffer_threshold;
+    REQUIRE(threshold > 1);
+    // each dropped self-owned node is one candidate
+    for (int i = 1; i < threshold; i++) {
+      auto ptr = G.make_node(i);
+      ptr->neighbors.push_back(ptr.get_owned(ptr));
+    }
+    REQUIRE(mynode_count == threshold - 1);
+    REQUIRE(ctx->getBufferSize() == threshold - 1);
+    {
+      auto ptr = G.make_node(threshold);
+      ptr->neighbors.push_back(ptr.get_owned(ptr));
+    }
+    REQUIRE(mynode_count == 0);
+    REQUIRE(ctx->getBufferSize() == 0);
+    // threshold '1': every candidate is decided now
+    ctx->cycle_buffer_threshold = 1;
+    auto ptr = G.make_node(0.0);
+    ptr->neighbors.push_back(ptr.get_owned(ptr));
+    ptr.reset();
+    REQUIRE(mynode_count == 0);
+  }
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestRC: trial deletion keeps externally owned cycle") {
+  std::cout << "begin RC trial deletion" << std::endl;
+  {
+    MyGraph<double, DynowForestRC> G;
+    auto ctx = G.my_ctx().lock();
+    ctx->cycle_buffer_threshold = 4;
+    G.entry = G.make_node(-1.0);
+    auto ptr1 = G.make_node(1.0);
+    auto ptr2 = G.make_node(2.0);
+    // -1 -> 1 <-> 2
+    G.entry->neighbors.push_back(ptr1.get_owned(G.entry));
+    ptr1->neighbors.push_back(ptr2.get_owned(ptr1));
+    ptr2->neighbors.push_back(ptr1.get_owned(ptr2));
+    ptr1.reset();
+    ptr2.reset();
+    ctx->collect();
+    // cycle is still owned by -1
+    REQUIRE(mynode_count == 3);
+    REQUIRE(G.entry->neighbors[0]->neighbors[0]->val == 2.0);
+    REQUIRE(ctx->getBufferSize() == 0);
+    // drop -1: 1 <-> 2 becomes garbage, reclaimed by threshold or collect
+    G.entry.reset();
+    REQUIRE(mynode_count <= 2);
+    ctx->collect();
+    REQUIRE(mynode_count == 0);
+  }
+  REQUIRE(mynode_count == 0);
+}
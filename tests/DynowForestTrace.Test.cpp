@@ -0,0 +1,223 @@
+// #define CATCH_CONFIG_MAIN // This tells Catch to provide a main()
+#include <iostream>
+//
+#ifdef HEADER_ONLY
+#include <catch2/catch_amalgamated.hpp>
+#else
+#include <catch2/catch_all.hpp>
+#endif
+#include <cycles/detail/trace/DynowForestTrace.hpp>
+#include <demo_cptr/MyGraph.hpp>
+
+using namespace std;     // NOLINT
+using namespace cycles;  // NOLINT
+
+// =======================
+// tracing forest tests
+// =======================
+
+TEST_CASE("CyclesTestTrace: cycle is only reclaimed on collect") {
+  std::cout << "begin Trace cycle collect" << std::endl;
+  {
+    MyGraph<double, DynowForestTrace> G;
+    auto ctx = G.my_ctx().lock();
+    G.entry = G.make_node(-1.0);
+    auto ptr1 = G.make_node(1.0);
+    auto ptr2 = G.make_node(2.0);
+    REQUIRE(ctx->getForestSize() == 3);
+    // -1 -> 1 -> 2 -> -1
+    G.entry->neighbors.push_back(ptr1.get_owned(G.entry));
+    ptr1->neighbors.push_back(ptr2.get_owned(ptr1));
+    ptr2->neighbors.push_back(G.entry.get_owned(ptr2));
+    ptr1.reset();
+    ptr2.reset();
+    REQUIRE(ctx->getForestSize() == 1);
+    // nothing reachable is lost
+    ctx->collect();
+    REQUIRE(mynode_count == 3);
+    REQUIRE(ctx->getPoolSize() == 3);
+    REQUIRE(G.entry->neighbors[0]->neighbors[0]->val == 2.0);
+    REQUIRE(G.entry->neighbors[0]->neighbors[0]->neighbors[0]->val == -1.0);
+    // drop last root: cycle is garbage, but memory is deferred
+    G.entry.reset();
+    REQUIRE(ctx->getForestSize() == 0);
+    REQUIRE(mynode_count == 3);
+    ctx->collect();
+    REQUIRE(mynode_count == 0);
+    REQUIRE(ctx->getPoolSize() == 0);
+    REQUIRE(tnode_count == 0);
+  }
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestTrace: dead owner releases links into live nodes") {
+  std::cout << "begin Trace dead owner" << std::endl;
+  {
+    MyGraph<double, DynowForestTrace> G;
+    auto ctx = G.my_ctx().lock();
+    G.entry = G.make_node(-1.0);
+    auto ptr1 = G.make_node(1.0);
+    // 1 -> -1 (and 1 is dropped)
+    ptr1->neighbors.push_back(G.entry.get_owned(ptr1));
+    REQUIRE(G.entry.arrow.remote_node.lock()->owned_by.size() == 1);
+    ptr1.reset();
+    ctx->collect();
+    REQUIRE(mynode_count == 1);
+    // link from swept node was removed from survivor
+    REQUIRE(G.entry.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE(G.entry->val == -1.0);
+  }
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestTrace: multiple unowned copies and self-owned") {
+  std::cout << "begin Trace unowned" << std::endl;
+  {
+    MyGraph<double, DynowForestTrace> G;
+    auto ctx = G.my_ctx().lock();
+    G.entry = G.make_node(-1.0);
+    G.entry->neighbors.push_back(G.make_node_owned(1.0, G.entry));
+    auto self = G.entry.get_self_owned();
+    REQUIRE(self.arrow.is_owned());
+    auto u1 = G.entry->neighbors[0].get_unowned();
+    auto u2 = G.entry->neighbors[0].get_unowned();
+    REQUIRE(u1.arrow.is_root());
+    REQUIRE(u2.arrow.is_root());
+    // one root for -1, one (counted twice) for 1
+    REQUIRE(ctx->getForestSize() == 2);
+    G.entry.reset();
+    ctx->collect();
+    // self-owned link does not keep -1 alive
+    REQUIRE(mynode_count == 1);
+    REQUIRE(!self);
+    REQUIRE(u1->val == 1.0);
+    u1.reset();
+    ctx->collect();
+    REQUIRE(mynode_count == 1);
+    u2.reset();
+    ctx->collect();
+    REQUIRE(mynode_count == 0);
+  }
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestTrace: auto collect by allocation volume") {
+  std::cout << "begin Trace auto collect" << std::endl;
+  using TraceNode = MyNode<double, DynowForestTrace>;
+  {
+    relation_pool<DynowForestTrace> pool;
+    auto ctx = pool.getContext();
+    ctx->min_collect_threshold = 16;
+    ctx->collect();
+    for (int i = 0; i < 100; i++) {
+      auto ptr = pool.make<TraceNode>(i);
+      ptr->neighbors.push_back(ptr.get_owned(ptr));
+    }
+    // garbage is bounded by threshold
+    REQUIRE(ctx->getPoolSize() <= 16);
+    REQUIRE(mynode_count == ctx->getPoolSize());
+  }
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestTrace: parallel mark") {
+  std::cout << "begin Trace parallel mark" << std::endl;
+  {
+    MyGraph<double, DynowForestTrace> G;
+    auto ctx = G.my_ctx().lock();
+    ctx->setAutoCollect(false);
+    ctx->setMarkThreads(4);
+    ctx->min_parallel_nodes = 1;
+    std::vector<relation_ptr<MyNode<double, DynowForestTrace>,
+                             DynowForestTrace>>
+        vroots;
+    for (int i = 0; i < 64; i++) {
+      vroots.push_back(G.make_node(i));
+      auto& r = vroots.back();
+      r->neighbors.push_back(G.make_node_owned(-i, r));
+      r->neighbors[0]->neighbors.push_back(r.get_owned(r->neighbors[0]));
+    }
+    REQUIRE(mynode_count == 128);
+    // drop every odd root
+    for (int i = 1; i < 64; i += 2) vroots[i].reset();
+    ctx->collect();
+    REQUIRE(mynode_count == 64);
+    for (int i = 0; i < 64; i += 2)
+      REQUIRE(vroots[i]->neighbors[0]->val == -i);
+  }
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestTrace: parallel mark of a graph held by one root") {
+  std::cout << "begin Trace parallel mark one root" << std::endl;
+  {
+    MyGraph<double, DynowForestTrace> G;
+    auto ctx = G.my_ctx().lock();
+    ctx->setAutoCollect(false);
+    ctx->setMarkThreads(4);
+    REQUIRE(ctx->getMarkThreads() == 4);
+    ctx->min_parallel_nodes = 1;
+    // entry owns 1000 nodes, each one owning next 10 ones (and entry)
+    G.entry = G.make_node(-1.0);
+    std::vector<relation_ptr<MyNode<double, DynowForestTrace>,
+                             DynowForestTrace>>
+        vnodes;
+    for (int i = 0; i < 1000; i++)
+      vnodes.push_back(G.make_node_owned(i, G.entry));
+    for (int i = 0; i < 1000; i++) {
+      for (int k = 1; k <= 10; k++)
+        vnodes[i]->neighbors.push_back(
+            vnodes[(i + k) % 1000].get_owned(vnodes[i]));
+      vnodes[i]->neighbors.push_back(G.entry.get_owned(vnodes[i]));
+    }
+    for (auto& ptr : vnodes) G.entry->neighbors.push_back(std::move(ptr));
+    vnodes.clear();
+    REQUIRE(ctx->getForestSize() == 1);
+    // every marking is repeated on same workers
+    for (int rep = 0; rep < 3; rep++) {
+      ctx->collect();
+      REQUIRE(mynode_count == 1001);
+    }
+    G.entry.reset();
+    ctx->collect();
+    REQUIRE(mynode_count == 0);
+    ctx->setMarkThreads(1);
+    REQUIRE(ctx->getMarkThreads() == 1);
+  }
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestTrace: for_each_reachable skips uncollected garbage") {
+  std::cout << "begin Trace for_each_reachable" << std::endl;
+  {
+    MyGraph<double, DynowForestTrace> G;
+    auto ctx = G.my_ctx().lock();
+    ctx->setAutoCollect(false);
+    G.entry = G.make_node(-1.0);
+    auto ptr1 = G.make_node(1.0);
+    auto ptr2 = G.make_node(2.0);
+    // -1 -> 1 -> 2 -> 1 (and 2 -> -1, dropped later)
+    G.entry->neighbors.push_back(ptr1.get_owned(G.entry));
+    ptr1->neighbors.push_back(ptr2.get_owned(ptr1));
+    ptr2->neighbors.push_back(ptr1.get_owned(ptr2));
+    ptr2->neighbors.push_back(G.entry.get_owned(ptr2));
+    ptr1.reset();
+    ptr2.reset();
+    std::vector<double> vals;
+    G.forEachFrom(G.entry, [&](const MyNode<double, DynowForestTrace>& n) {
+      vals.push_back(n.val);
+    });
+    REQUIRE(vals == std::vector<double>{-1.0, 1.0, 2.0});
+    // 1 and 2 become garbage (not collected yet): only -1 is reachable
+    G.entry->neighbors.clear();
+    REQUIRE(mynode_count == 3);
+    vals.clear();
+    G.forEachFrom(G.entry, [&](const MyNode<double, DynowForestTrace>& n) {
+      vals.push_back(n.val);
+    });
+    REQUIRE(vals == std::vector<double>{-1.0});
+    ctx->setAutoCollect(true);
+    REQUIRE(mynode_count == 1);
+  }
+  REQUIRE(mynode_count == 0);
+}
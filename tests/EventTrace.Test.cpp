@@ -0,0 +1,76 @@
+// #define CATCH_CONFIG_MAIN // This tells Catch to provide a main()
+#include <iostream>
+#include <sstream>
+#include <string>
+// tracing is compiled in only for this test (separate executable)
+#ifndef CYCLES_TRACE_EVENTS
+#define CYCLES_TRACE_EVENTS
+#endif
+//
+#ifdef HEADER_ONLY
+#include <catch2/catch_amalgamated.hpp>
+#else
+#include <catch2/catch_all.hpp>
+#endif
+#include <demo_cptr/MyGraph.hpp>
+
+using namespace std;     // NOLINT
+using namespace cycles;  // NOLINT
+
+// =======================
+// event tracing tests
+// =======================
+
+int count_events(const std::vector<TraceEvent>& events, const string& name) {
+  int count = 0;
+  for (const auto& e : events)
+    if (name == e.name) count++;
+  return count;
+}
+
+TEST_CASE("CyclesTestEventTrace: ring buffer keeps newest events") {
+  EventTraceBuffer buffer{4};
+  for (int i = 0; i < 10; i++) buffer.record("ev", i, i + 1, i);
+  REQUIRE(buffer.getRecorded() == 10);
+  auto events = buffer.snapshot();
+  REQUIRE(events.size() == 4);
+  REQUIRE(events[0].arg == 6);
+  REQUIRE(events[3].arg == 9);
+  REQUIRE(events[3].duration_ns == 1);
+  buffer.setEnabled(false);
+  buffer.record("ev", 0, 1);
+  REQUIRE(buffer.getRecorded() == 10);
+  buffer.clear();
+  REQUIRE(buffer.snapshot().empty());
+}
+
+TEST_CASE("CyclesTestEventTrace: forest operations are recorded") {
+  std::cout << "begin EventTrace forest operations" << std::endl;
+  auto& buffer = EventTraceBuffer::global();
+  buffer.clear();
+  {
+    MyGraph<double> G;
+    G.entry = G.make_node(-1.0);
+    auto ptr1 = G.make_node(1.0);
+    // -1 -> 1 -> -1
+    G.entry->neighbors.push_back(ptr1.get_owned(G.entry));
+    ptr1->neighbors.push_back(G.entry.get_owned(ptr1));
+    ptr1.reset();
+    G.entry.reset();
+    REQUIRE(mynode_count == 0);
+  }
+  auto events = buffer.snapshot();
+  REQUIRE(count_events(events, "op1_addNodeToNewTree") == 2);
+  REQUIRE(count_events(events, "op3_weakSetOwnedBy") == 2);
+  REQUIRE(count_events(events, "op4_remove") >= 2);
+  REQUIRE(count_events(events, "op4x_trySetNewOwner") >= 1);
+  REQUIRE(count_events(events, "destroy_pending") >= 1);
+  REQUIRE(count_events(events, "TNodeData::destroy") >= 1);
+  // Chrome trace format
+  std::stringstream ss;
+  buffer.dump_json(ss);
+  std::string json = ss.str();
+  REQUIRE(json.find("{\"traceEvents\":[") == 0);
+  REQUIRE(json.find("\"name\":\"destroy_pending\"") != std::string::npos);
+  REQUIRE(json.find("\"ph\":\"X\"") != std::string::npos);
+}
@@ -1,12 +1,21 @@
 
 // #define CATCH_CONFIG_MAIN // This tells Catch to provide a main()
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
 //
 #ifdef HEADER_ONLY
 #include <catch2/catch_amalgamated.hpp>
 #else
 #include <catch2/catch_all.hpp>
 #endif
+#include <cycles/detail/rc/DynowForestRC.hpp>
+#include <cycles/detail/trace/DynowForestTrace.hpp>
 #include <demo_cptr/MyGraph.hpp>
 
 using namespace std;     // NOLINT
@@ -15,12 +24,31 @@ using namespace cycles;  // NOLINT
 // =======================
 // memory management tests
 // =======================
+// tests run on both tree forest (DynowForestV1) and reference counting
+// forest (DynowForestRC). Internal structure (tree/weak links) is only
+// checked on DynowForestV1.
 
-TEST_CASE("CyclesTestGraph: TEST_CASE 1 - MyGraph Single") {
+// NOLINTNEXTLINE
+#define REQUIRE_TREE(...)                                  \
+  do {                                                     \
+    if constexpr (std::is_same_v<TestType, DynowForestV1>) \
+      REQUIRE(__VA_ARGS__);                                \
+  } while (0)
+
+// DynowForestRC batches trial deletion by default: tests that check counts
+// right after a cycle is dropped make it synchronous, as DynowForestV1
+template <class DOF, class Ctx>
+void syncCycles(const Ctx& ctx) {
+  if constexpr (std::is_same_v<DOF, DynowForestRC>)
+    ctx->cycle_buffer_threshold = 1;
+}
+
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 1 - MyGraph Single", "",
+                   DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph Single" << std::endl;
   // create context
   {
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
     REQUIRE(!G.my_ctx().lock()->debug());
     REQUIRE(G.my_ctx().lock()->getForestSize() == 0);
 
@@ -42,11 +70,12 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 1 - MyGraph Single") {
   REQUIRE(mynode_count == 0);
 }
 
-TEST_CASE("CyclesTestGraph: TEST_CASE 2 - MyGraph A B C' D' E'") {
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 2 - MyGraph A B C' D' E'", "",
+                   DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph MyGraph A B C' D' E'" << std::endl;
   // create context
   {
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
     REQUIRE(!G.my_ctx().lock()->debug());
     // G.debug_flag = true;
     // G.my_ctx().lock()->debug = true;
@@ -105,10 +134,11 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 2 - MyGraph A B C' D' E'") {
                   << std::endl;
     }
     // node 2 should point to node 3
-    REQUIRE(ptr2.arrow.remote_node.lock()->owned_by.size() == 0);  // no one
-    REQUIRE(ptr2.arrow.remote_node.lock()->owns.size() == 1);      // 3
-    REQUIRE(ptr3.arrow.remote_node.lock()->owned_by.size() == 1);  // 2
-    REQUIRE(ptr3.arrow.remote_node.lock()->owns.size() == 1);      // -1
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->owned_by.size() ==
+                 0);  // no one
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->owns.size() == 1);      // 3
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->owned_by.size() == 1);  // 2
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->owns.size() == 1);      // -1
 
     // CHECKS (E') - ptr2 and ptr3 are removed
     //
@@ -116,8 +146,8 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 2 - MyGraph A B C' D' E'") {
     // std::cout << std::endl << "WILL RESET ptr2" << std::endl << std::endl;
     ptr2.reset();
     // node 2 should not point to node 3 anymore
-    REQUIRE(ptr3.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(ptr3.arrow.remote_node.lock()->owns.size() == 1);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->owns.size() == 1);
     //
     REQUIRE(G.entry.arrow.is_root());
     REQUIRE(ptr3.arrow.is_root());
@@ -145,11 +175,12 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 2 - MyGraph A B C' D' E'") {
   REQUIRE(mynode_count == 0);
 }
 
-TEST_CASE("CyclesTestGraph: TEST_CASE 3 - MyGraph A-B-C-D-E Simple") {
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 3 - MyGraph A-B-C-D-E Simple",
+                   "", DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph A-B-C-D-E Simple" << std::endl;
   // create context
   {
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
     REQUIRE(!G.my_ctx().lock()->debug());
 
     // STEP (A)
@@ -190,32 +221,32 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 3 - MyGraph A-B-C-D-E Simple") {
     ptr2.get()->neighbors.push_back(ptr3.get_owned(ptr2));
     ptr3.get()->neighbors.push_back(G.entry.get_owned(ptr3));
     // CHECKS
-    REQUIRE(G.entry.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(G.entry.arrow.remote_node.lock()->children.size() == 1);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owned_by.size() == 1);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->children.size() == 1);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owned_by.size() == 1);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owns.size() == 0);
     //
-    REQUIRE(
+    REQUIRE_TREE(
         G.entry.get()->neighbors[0].arrow.remote_node.lock()->has_parent() ==
         true);
-    REQUIRE(
+    REQUIRE_TREE(
         G.entry.get()->neighbors[0].arrow.remote_node.lock()->children.size() ==
         0);
-    REQUIRE(
+    REQUIRE_TREE(
         G.entry.get()->neighbors[0].arrow.remote_node.lock()->owned_by.size() ==
         0);
-    REQUIRE(G.entry.get()->neighbors[0].arrow.remote_node.lock()->owns.size() ==
-            1);
+    REQUIRE_TREE(
+        G.entry.get()->neighbors[0].arrow.remote_node.lock()->owns.size() == 1);
     //
-    REQUIRE(ptr2.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr2.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(ptr2.arrow.remote_node.lock()->owned_by.size() == 1);
-    REQUIRE(ptr2.arrow.remote_node.lock()->owns.size() == 1);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->owned_by.size() == 1);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->owns.size() == 1);
     //
-    REQUIRE(ptr3.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr3.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(ptr3.arrow.remote_node.lock()->owned_by.size() == 1);
-    REQUIRE(ptr3.arrow.remote_node.lock()->owns.size() == 1);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->owned_by.size() == 1);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->owns.size() == 1);
     //
     // CHECKS (E) - ptr2 and ptr3 are removed
     //
@@ -254,11 +285,12 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 3 - MyGraph A-B-C-D-E Simple") {
 }
 
 // NOLINTNEXTLINE
-TEST_CASE("CyclesTestGraph: TEST_CASE 4 - MyGraph A-B-C-D-E Detailed") {
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 4 - MyGraph A-B-C-D-E Detailed",
+                   "", DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph A-B-C-D-E Detailed" << std::endl;
   // create context
   {
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
     REQUIRE(!G.my_ctx().lock()->debug());
     // G.debug_flag = true;
     // G.my_ctx().lock()->debug = true;
@@ -273,10 +305,10 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 4 - MyGraph A-B-C-D-E Detailed") {
 
     // check few things on 'entry'... Parent, Children, Owned and Owns
     // CHECKS (A) - just -1 node
-    REQUIRE(G.entry.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(G.entry.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owns.size() == 0);
 
     // forest size is 1
     REQUIRE(G.my_ctx().lock()->getForestSize() == 1);
@@ -317,15 +349,15 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 4 - MyGraph A-B-C-D-E Detailed") {
     REQUIRE(ptr1.arrow.is_root());
     REQUIRE(G.entry.get()->neighbors[0].arrow.is_owned());
     // CHECKS (B) - node 1 is owned by -1
-    REQUIRE(G.entry.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(G.entry.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owns.size() == 1);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owns.size() == 1);
     //
-    REQUIRE(ptr1.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr1.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(ptr1.arrow.remote_node.lock()->owned_by.size() == 1);
-    REQUIRE(ptr1.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->owned_by.size() == 1);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->owns.size() == 0);
 
     //
     ptr1.get()->neighbors.push_back(ptr2.get_owned(ptr1));
@@ -340,20 +372,20 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 4 - MyGraph A-B-C-D-E Detailed") {
     REQUIRE(G.entry.get()->neighbors[0].arrow.is_owned());
     auto& fake_ptr1 = G.entry.get()->neighbors[0];
     // CHECKS (C) - ptr1 is deleted
-    REQUIRE(G.entry.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(G.entry.arrow.remote_node.lock()->children.size() == 1);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->children.size() == 1);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owns.size() == 0);
     //
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->has_parent() == true);
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->owns.size() == 1);
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->has_parent() == true);
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->owns.size() == 1);
     //
-    REQUIRE(ptr2.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr2.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(ptr2.arrow.remote_node.lock()->owned_by.size() == 1);
-    REQUIRE(ptr2.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->owned_by.size() == 1);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->owns.size() == 0);
     //
     ptr2.get()->neighbors.push_back(ptr3.get_owned(ptr2));
     REQUIRE(G.my_ctx().lock()->getForestSize() == 3);
@@ -361,25 +393,25 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 4 - MyGraph A-B-C-D-E Detailed") {
     ptr3.get()->neighbors.push_back(G.entry.get_owned(ptr3));
     REQUIRE(G.my_ctx().lock()->getForestSize() == 3);
     // CHECKS (D) - ptr2 and ptr3 are added as owners
-    REQUIRE(G.entry.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(G.entry.arrow.remote_node.lock()->children.size() == 1);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owned_by.size() == 1);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owns.size() == 0);
-    //
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->has_parent() == true);
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->owns.size() == 1);
-    //
-    REQUIRE(ptr2.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr2.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(ptr2.arrow.remote_node.lock()->owned_by.size() == 1);
-    REQUIRE(ptr2.arrow.remote_node.lock()->owns.size() == 1);
-    //
-    REQUIRE(ptr3.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr3.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(ptr3.arrow.remote_node.lock()->owned_by.size() == 1);
-    REQUIRE(ptr3.arrow.remote_node.lock()->owns.size() == 1);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->children.size() == 1);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owned_by.size() == 1);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owns.size() == 0);
+    //
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->has_parent() == true);
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->owns.size() == 1);
+    //
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->owned_by.size() == 1);
+    REQUIRE_TREE(ptr2.arrow.remote_node.lock()->owns.size() == 1);
+    //
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->owned_by.size() == 1);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->owns.size() == 1);
     //
     // will clean all from this context
     //
@@ -392,40 +424,41 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 4 - MyGraph A-B-C-D-E Detailed") {
     auto& fake_ptr2 = fake_ptr1.get()->neighbors[0];
     auto& fake_ptr3 = fake_ptr2.get()->neighbors[0];
     // CHECKS (E) - ptr2 and ptr3 are removed
-    REQUIRE(G.entry.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(G.entry.arrow.remote_node.lock()->children.size() == 1);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owned_by.size() == 1);
-    REQUIRE(G.entry.arrow.remote_node.lock()->owns.size() == 0);
-    //
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->has_parent() == true);
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->children.size() == 1);
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_ptr1.arrow.remote_node.lock()->owns.size() == 0);
-    //
-    REQUIRE(fake_ptr2.arrow.remote_node.lock()->has_parent() == true);
-    REQUIRE(fake_ptr2.arrow.remote_node.lock()->children.size() == 1);
-    REQUIRE(fake_ptr2.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_ptr2.arrow.remote_node.lock()->owns.size() == 0);
-    //
-    REQUIRE(fake_ptr3.arrow.remote_node.lock()->has_parent() == true);
-    REQUIRE(fake_ptr3.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(fake_ptr3.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_ptr3.arrow.remote_node.lock()->owns.size() == 1);
-    REQUIRE(fake_ptr3.arrow.remote_node.lock()->owns[0].lock().get() ==
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->children.size() == 1);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owned_by.size() == 1);
+    REQUIRE_TREE(G.entry.arrow.remote_node.lock()->owns.size() == 0);
+    //
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->has_parent() == true);
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->children.size() == 1);
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_ptr1.arrow.remote_node.lock()->owns.size() == 0);
+    //
+    REQUIRE_TREE(fake_ptr2.arrow.remote_node.lock()->has_parent() == true);
+    REQUIRE_TREE(fake_ptr2.arrow.remote_node.lock()->children.size() == 1);
+    REQUIRE_TREE(fake_ptr2.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_ptr2.arrow.remote_node.lock()->owns.size() == 0);
+    //
+    REQUIRE_TREE(fake_ptr3.arrow.remote_node.lock()->has_parent() == true);
+    REQUIRE_TREE(fake_ptr3.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(fake_ptr3.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_ptr3.arrow.remote_node.lock()->owns.size() == 1);
+    REQUIRE_TREE(fake_ptr3.arrow.remote_node.lock()->owns[0].lock().get() ==
             G.entry.arrow.remote_node.lock().get());
     //
     REQUIRE(G.entry.get()->val == -1);
-    REQUIRE(G.entry.arrow.count_owned_by() == 1);
+    REQUIRE_TREE(G.entry.arrow.count_owned_by() == 1);
     //
     REQUIRE(G.entry->neighbors[0].get()->val == 1);
-    REQUIRE(G.entry->neighbors[0].arrow.count_owned_by() == 0);
+    REQUIRE_TREE(G.entry->neighbors[0].arrow.count_owned_by() == 0);
     REQUIRE(G.entry->neighbors[0].get()->neighbors.size() == 1);
     //
     REQUIRE(G.entry->neighbors[0]->neighbors[0]->val == 2);
-    REQUIRE(G.entry->neighbors[0]->neighbors[0].arrow.count_owned_by() == 0);
+    REQUIRE_TREE(G.entry->neighbors[0]->neighbors[0].arrow.count_owned_by() ==
+                 0);
     //
     REQUIRE(G.entry->neighbors[0]->neighbors[0]->neighbors[0]->val == 3);
-    REQUIRE(G.entry->neighbors[0]
+    REQUIRE_TREE(G.entry->neighbors[0]
                 ->neighbors[0]
                 ->neighbors[0]
                 .arrow.count_owned_by() == 0);
@@ -434,7 +467,7 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 4 - MyGraph A-B-C-D-E Detailed") {
     REQUIRE(
         G.entry->neighbors[0]->neighbors[0]->neighbors[0]->neighbors[0]->val ==
         -1);
-    REQUIRE(G.entry->neighbors[0]
+    REQUIRE_TREE(G.entry->neighbors[0]
                 ->neighbors[0]
                 ->neighbors[0]
                 ->neighbors[0]
@@ -483,15 +516,16 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 4 - MyGraph A-B-C-D-E Detailed") {
 }
 
 // NOLINTNEXTLINE
-TEST_CASE(
-    "CyclesTestGraph: TEST_CASE 5 - MyGraph A-B-C-D force slow destruction") {
+TEMPLATE_TEST_CASE(
+    "CyclesTestGraph: TEST_CASE 5 - MyGraph A-B-C-D force slow destruction", "",
+                   DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph A-B-C-D force slow destruction" << std::endl;
   // create context
   {
     // THIS CASE FORCES GRAPH TO HAVE USELESS WEAK LINK ON TOP, UNTIL LAST
     // DESTRUCTION
 
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
     REQUIRE(G.my_ctx().lock()->getForestSize() == 0);
     //
     G.entry = G.make_node(-1.0);
@@ -537,29 +571,35 @@ TEST_CASE(
     REQUIRE(fake_entry.arrow.is_owned());  // node -1
 
     // deeper debug
-    REQUIRE(ptr1.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr1.arrow.remote_node.lock()->children.size() == 1);  // node 2
-    REQUIRE(ptr1.arrow.remote_node.lock()->owned_by.size() == 1);  // node -1
-    REQUIRE(ptr1.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->children.size() ==
+                 1);  // node 2
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->owned_by.size() ==
+                 1);  // node -1
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->owns.size() == 0);
     // change value to 2.2
     fake_ptr2->val = 2.2;
-    REQUIRE(fake_ptr2.arrow.remote_node.lock()->has_parent() ==
+    REQUIRE_TREE(fake_ptr2.arrow.remote_node.lock()->has_parent() ==
             true);  // node 1
-    REQUIRE(fake_ptr2.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(fake_ptr2.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_ptr2.arrow.remote_node.lock()->owns.size() == 1);  // node 3
+    REQUIRE_TREE(fake_ptr2.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(fake_ptr2.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_ptr2.arrow.remote_node.lock()->owns.size() ==
+                 1);  // node 3
 
     //
-    REQUIRE(ptr3.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr3.arrow.remote_node.lock()->children.size() == 1);  // node -1
-    REQUIRE(ptr3.arrow.remote_node.lock()->owned_by.size() == 1);  // node 2
-    REQUIRE(ptr3.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->children.size() ==
+                 1);  // node -1
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->owned_by.size() ==
+                 1);  // node 2
+    REQUIRE_TREE(ptr3.arrow.remote_node.lock()->owns.size() == 0);
     //
-    REQUIRE(fake_entry.arrow.remote_node.lock()->has_parent() ==
+    REQUIRE_TREE(fake_entry.arrow.remote_node.lock()->has_parent() ==
             true);  // node 3
-    REQUIRE(fake_entry.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(fake_entry.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_entry.arrow.remote_node.lock()->owns.size() == 1);  // node 1
+    REQUIRE_TREE(fake_entry.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(fake_entry.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_entry.arrow.remote_node.lock()->owns.size() ==
+                 1);  // node 1
     //
     // ptr3.reset(); // do not delete here
     // ptr1.reset(); // do not delete here
@@ -576,14 +616,15 @@ TEST_CASE(
 }
 
 // NOLINTNEXTLINE
-TEST_CASE("CyclesTestGraph: TEST_CASE 6 - MyGraph 1 2 3 -1 kill 2") {
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 6 - MyGraph 1 2 3 -1 kill 2", "",
+                   DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph 1 2 3 -1 kill 2" << std::endl;
   // create context
   {
     // THIS CASE FORCES GRAPH TO HAVE USELESS WEAK LINK ON TOP, UNTIL LAST
     // DESTRUCTION
 
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
     REQUIRE(G.my_ctx().lock()->getForestSize() == 0);
     //
     G.entry = G.make_node(-1.0);
@@ -615,10 +656,10 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 6 - MyGraph 1 2 3 -1 kill 2") {
     REQUIRE(fake_ptr2.arrow.is_null());
 
     // deeper debug
-    REQUIRE(ptr1.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr1.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(ptr1.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->owns.size() == 0);
     REQUIRE(fake_ptr2.arrow.is_null());
     // fake_ptr3 is broken now
     // REQUIRE(fake_ptr3.arrow.is_null());
@@ -631,9 +672,10 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 6 - MyGraph 1 2 3 -1 kill 2") {
 }
 
 // NOLINTNEXTLINE
-TEST_CASE(
+TEMPLATE_TEST_CASE(
     "CyclesTestGraph: TEST_CASE 7 - MyGraph 1 2 3 -1 (4) kill 2 but 4 saves 3 "
-    "-1") {
+    "-1", "",
+                   DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph 1 2 3 -1 (4) kill 2 but 4 saves 3 -1"
             << std::endl;
   // create context
@@ -641,7 +683,7 @@ TEST_CASE(
     // THIS CASE FORCES GRAPH TO HAVE USELESS WEAK LINK ON TOP, UNTIL LAST
     // DESTRUCTION
 
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
     //
     // G.debug_flag = true;
     // G.my_ctx().lock()->debug = true;
@@ -698,37 +740,41 @@ TEST_CASE(
     // deeper debug
     //
     REQUIRE(ptr1.arrow.is_root());
-    REQUIRE(ptr1.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr1.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(ptr1.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->owns.size() == 0);
     REQUIRE(fake_ptr2.arrow.is_null());
     // fake_ptr3 is broken now, but fake_ptr3_2 is good
     REQUIRE(fake_ptr3_2.arrow.is_owned());
-    REQUIRE(fake_ptr3_2.arrow.remote_node.lock()->has_parent() == true);  // 4
-    REQUIRE(fake_ptr3_2.arrow.remote_node.lock()->children.size() == 1);  // -1
-    REQUIRE(fake_ptr3_2.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_ptr3_2.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(fake_ptr3_2.arrow.remote_node.lock()->has_parent() ==
+                 true);  // 4
+    REQUIRE_TREE(fake_ptr3_2.arrow.remote_node.lock()->children.size() ==
+                 1);  // -1
+    REQUIRE_TREE(fake_ptr3_2.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_ptr3_2.arrow.remote_node.lock()->owns.size() == 0);
     // fake_entry is broken now, but fake_entry_2 is good
     REQUIRE(fake_entry_2.arrow.is_owned());
-    REQUIRE(fake_entry_2.arrow.remote_node.lock()->has_parent() == true);  // 3
-    REQUIRE(fake_entry_2.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(fake_entry_2.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_entry_2.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(fake_entry_2.arrow.remote_node.lock()->has_parent() ==
+                 true);  // 3
+    REQUIRE_TREE(fake_entry_2.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(fake_entry_2.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_entry_2.arrow.remote_node.lock()->owns.size() == 0);
     REQUIRE(ptr4.arrow.is_root());
-    REQUIRE(ptr4.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr4.arrow.remote_node.lock()->children.size() == 1);  // 3
-    REQUIRE(ptr4.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(ptr4.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(ptr4.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr4.arrow.remote_node.lock()->children.size() == 1);  // 3
+    REQUIRE_TREE(ptr4.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(ptr4.arrow.remote_node.lock()->owns.size() == 0);
     // SHOULD NOT LEAK
   }
   REQUIRE(mynode_count == 0);
 }
 
 // NOLINTNEXTLINE
-TEST_CASE(
+TEMPLATE_TEST_CASE(
     "CyclesTestGraph: TEST_CASE 8 - MyGraph 1 2 3 -1 (4) kill 2 but 4 saves 3 "
-    "-1 with C2 constructor") {
+    "-1 with C2 constructor", "",
+                   DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph 1 2 3 -1 (4) kill 2 but 4 saves 3 "
                "-1 with C2 constructor"
             << std::endl;
@@ -740,7 +786,7 @@ TEST_CASE(
     // THIS TEST 8 IS SAME AS TEST 7, USING make_node_owned INSTEAD OF
     // get_owned
 
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
     //
     // G.debug_flag = true;
     // G.my_ctx().lock()->debug = true;
@@ -799,38 +845,42 @@ TEST_CASE(
     // deeper debug
     //
     REQUIRE(ptr1.arrow.is_root());
-    REQUIRE(ptr1.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr1.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(ptr1.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(ptr1.arrow.remote_node.lock()->owns.size() == 0);
     REQUIRE(fake_ptr2.arrow.is_null());
     // fake_ptr3 is broken now, but fake_ptr3_2 is good
     REQUIRE(fake_ptr3_2.arrow.is_owned());
-    REQUIRE(fake_ptr3_2.arrow.remote_node.lock()->has_parent() == true);  // 4
-    REQUIRE(fake_ptr3_2.arrow.remote_node.lock()->children.size() == 1);  // -1
-    REQUIRE(fake_ptr3_2.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_ptr3_2.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(fake_ptr3_2.arrow.remote_node.lock()->has_parent() ==
+                 true);  // 4
+    REQUIRE_TREE(fake_ptr3_2.arrow.remote_node.lock()->children.size() ==
+                 1);  // -1
+    REQUIRE_TREE(fake_ptr3_2.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_ptr3_2.arrow.remote_node.lock()->owns.size() == 0);
     // fake_entry is broken now, but fake_entry_2 is good
     REQUIRE(fake_entry_2.arrow.is_owned());
-    REQUIRE(fake_entry_2.arrow.remote_node.lock()->has_parent() == true);  // 3
-    REQUIRE(fake_entry_2.arrow.remote_node.lock()->children.size() == 0);
-    REQUIRE(fake_entry_2.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(fake_entry_2.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(fake_entry_2.arrow.remote_node.lock()->has_parent() ==
+                 true);  // 3
+    REQUIRE_TREE(fake_entry_2.arrow.remote_node.lock()->children.size() == 0);
+    REQUIRE_TREE(fake_entry_2.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(fake_entry_2.arrow.remote_node.lock()->owns.size() == 0);
     REQUIRE(ptr4.arrow.is_root());
-    REQUIRE(ptr4.arrow.remote_node.lock()->has_parent() == false);
-    REQUIRE(ptr4.arrow.remote_node.lock()->children.size() == 1);  // 3
-    REQUIRE(ptr4.arrow.remote_node.lock()->owned_by.size() == 0);
-    REQUIRE(ptr4.arrow.remote_node.lock()->owns.size() == 0);
+    REQUIRE_TREE(ptr4.arrow.remote_node.lock()->has_parent() == false);
+    REQUIRE_TREE(ptr4.arrow.remote_node.lock()->children.size() == 1);  // 3
+    REQUIRE_TREE(ptr4.arrow.remote_node.lock()->owned_by.size() == 0);
+    REQUIRE_TREE(ptr4.arrow.remote_node.lock()->owns.size() == 0);
     // SHOULD NOT LEAK
   }
   REQUIRE(mynode_count == 0);
 }
 
-TEST_CASE("CyclesTestGraph: TEST_CASE 9 - MyGraph MultiGraph") {
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 9 - MyGraph MultiGraph", "",
+                   DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph MultiGraph" << std::endl;
   // create context
   {
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
     REQUIRE(!G.my_ctx().lock()->debug());
     REQUIRE(G.my_ctx().lock()->getForestSize() == 0);
 
@@ -901,11 +951,14 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 9 - MyGraph MultiGraph") {
   REQUIRE(mynode_count == 0);
 }
 
-TEST_CASE("CyclesTestGraph: TEST_CASE 10 - MyGraph unowned and self-owned") {
+TEMPLATE_TEST_CASE(
+    "CyclesTestGraph: TEST_CASE 10 - MyGraph unowned and self-owned", "",
+    DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph unowned and self-owned" << std::endl;
   // create context
   {
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
+    syncCycles<TestType>(G.my_ctx().lock());
     // create unowned node
     G.entry = G.make_node(-1.0);
     // create copy of self-owned node
@@ -981,11 +1034,12 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 10 - MyGraph unowned and self-owned") {
   REQUIRE(mynode_count == 0);
 }
 
-TEST_CASE("CyclesTestGraph: TEST_CASE 11 - MyGraph get_unowned") {
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 11 - MyGraph get_unowned", "",
+                   DynowForestV1, DynowForestRC) {
   std::cout << "begin MyGraph get_unowned" << std::endl;
   // create context
   {
-    MyGraph<double> G;
+    MyGraph<double, TestType> G;
     // create unowned node
     G.entry = G.make_node(-1.0);
     // create copy of unowned node
@@ -1033,3 +1087,1345 @@ TEST_CASE("CyclesTestGraph: TEST_CASE 11 - MyGraph get_unowned") {
   // SHOULD NOT LEAK
   REQUIRE(mynode_count == 0);
 }
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 12 - MyGraph adaptive deferred trees") {
+  std::cout << "begin MyGraph adaptive" << std::endl;
+  {
+    MyGraph<double> G;
+    auto ctx = G.my_ctx().lock();
+    ctx->setAdaptive(true);
+    // pin DEFERRED mode: no switch from samples, never probe
+    ctx->min_samples = 1000;
+    ctx->probe_interval = 1000;
+    G.entry = G.make_node(-1.0);
+    auto ptr1 = G.make_node(1.0);
+    auto ptr2 = G.make_node(2.0);
+    auto ptr3 = G.make_node(3.0);
+    // -1 -> 1 -> 2 -> 3 -> 1 and -1 -> 3
+    G.entry->neighbors.push_back(ptr1.get_owned(G.entry));
+    ptr1->neighbors.push_back(ptr2.get_owned(ptr1));
+    ptr2->neighbors.push_back(ptr3.get_owned(ptr2));
+    ptr3->neighbors.push_back(ptr1.get_owned(ptr3));
+    G.entry->neighbors.push_back(ptr3.get_owned(G.entry));
+    REQUIRE(ctx->getTreeStats()[0].mode == TreeCollectMode::EAGER);
+    // eager repair: 1 becomes child of -1
+    ptr1.reset();
+    REQUIRE(ctx->getDeferredSize() == 0);
+    REQUIRE(ctx->getForestSize() == 3);
+    ctx->setForestMode(TreeCollectMode::DEFERRED);
+    REQUIRE(ctx->getTreeStats()[0].mode == TreeCollectMode::DEFERRED);
+    // deferred: orphans are kept aside
+    ptr2.reset();
+    ptr3.reset();
+    REQUIRE(ctx->getDeferredSize() == 2);
+    REQUIRE(ctx->getForestSize() == 1);
+    REQUIRE(mynode_count == 4);
+    // trace re-parents everything reachable
+    ctx->collect();
+    REQUIRE(ctx->getDeferredSize() == 0);
+    REQUIRE(mynode_count == 4);
+    REQUIRE(ctx->getNodeCount() == 4);
+    REQUIRE(G.entry->neighbors[0]->neighbors[0]->val == 2.0);
+    REQUIRE(G.entry->neighbors[1]->neighbors[0]->val == 1.0);
+    // drop -1 -> 1: still reachable from -1 -> 3 -> 1
+    G.entry->neighbors[0].reset();
+    REQUIRE(ctx->getDeferredSize() == 1);
+    ctx->collect();
+    REQUIRE(mynode_count == 4);
+    REQUIRE(G.entry->neighbors[1]->neighbors[0]->neighbors[0]->val == 2.0);
+    // drop -1 -> 3: cycle 1 -> 2 -> 3 -> 1 is garbage
+    G.entry->neighbors[1].reset();
+    REQUIRE(mynode_count == 4);
+    ctx->collect();
+    REQUIRE(mynode_count == 1);
+    REQUIRE(ctx->getNodeCount() == 1);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 13 - MyGraph adaptive cost model") {
+  std::cout << "begin MyGraph adaptive cost model" << std::endl;
+  {
+    MyGraph<double> G;
+    auto ctx = G.my_ctx().lock();
+    ctx->setAdaptive(true);
+    ctx->min_trace_batch = 8;
+    // deep chain: -1 -> 0 -> 1 -> ... -> 99
+    int D = 100;
+    G.entry = G.make_node(-1.0);
+    auto* tail = &G.entry;
+    for (int d = 0; d < D; d++) {
+      (*tail)->neighbors.push_back(G.make_node_owned(d, *tail));
+      tail = &(*tail)->neighbors[0];
+    }
+    // extra nodes, weakly owned by deep tail: costly eager repairs
+    int M = 40;
+    std::vector<relation_ptr<MyNode<double>>> vextra;
+    for (int m = 0; m < M; m++) {
+      vextra.push_back(G.make_node(1000 + m));
+      (*tail)->neighbors.push_back(vextra[m].get_owned(*tail));
+    }
+    REQUIRE(ctx->getForestMode() == TreeCollectMode::EAGER);
+    vextra.clear();
+    // first removals are eager, then forest switches to DEFERRED
+    REQUIRE(ctx->getForestMode() == TreeCollectMode::DEFERRED);
+    REQUIRE(ctx->getDeferredSize() > 0);
+    REQUIRE(mynode_count == 1 + D + M);
+    ctx->collect();
+    REQUIRE(ctx->getDeferredSize() == 0);
+    REQUIRE(mynode_count == 1 + D + M);
+    REQUIRE(ctx->getNodeCount() == 1 + D + M);
+    REQUIRE(ctx->getForestSize() == 1);
+    REQUIRE(ctx->getTreeStats()[0].size == 1 + D + M);
+    REQUIRE((*tail)->neighbors.back()->val == 1000 + M - 1);
+    G.entry.reset();
+    REQUIRE(mynode_count == 0);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 14 - MyGraph shallow owner, optimize") {
+  std::cout << "begin MyGraph shallow owner and optimize" << std::endl;
+  {
+    MyGraph<double> G;
+    auto ctx = G.my_ctx().lock();
+    // chain: -1 -> 0 -> 1 -> ... -> 9
+    int D = 10;
+    G.entry = G.make_node(-1.0);
+    // vchain[k] is node k-1 (vchain[0] is -1), held by rptr(k)
+    std::vector<MyNode<double>*> vchain{G.entry.get()};
+    auto rptr = [&](int k) -> relation_ptr<MyNode<double>>& {
+      return (k == 0) ? G.entry : vchain[k - 1]->neighbors[0];
+    };
+    for (int k = 0; k < D; k++) {
+      vchain[k]->neighbors.push_back(G.make_node_owned(k, rptr(k)));
+      vchain.push_back(vchain[k]->neighbors[0].get());
+    }
+    REQUIRE(ctx->getTreeStats()[0].height == D);
+    // node 100: child of 4, weakly owned by 9 (deepest) and -1 (root)
+    vchain[5]->neighbors.push_back(G.make_node_owned(100.0, rptr(5)));
+    auto& n100 = vchain[5]->neighbors.back();
+    vchain[D]->neighbors.push_back(n100.get_owned(rptr(D)));
+    G.entry->neighbors.push_back(n100.get_owned(G.entry));
+    // removal of parent link: shallowest owner (-1) is chosen, not first (9)
+    vchain[5]->neighbors.pop_back();
+    REQUIRE(mynode_count == D + 2);
+    auto sptr_100 = G.entry->neighbors.back().arrow.remote_node.lock();
+    REQUIRE(sptr_100->parent.lock() == G.entry.arrow.remote_node.lock());
+    sptr_100 = nullptr;
+    // every chain node also weakly owned by -1: optimize flattens the tree
+    for (int k = 2; k <= D; k++)
+      G.entry->neighbors.push_back(rptr(k).get_owned(G.entry));
+    REQUIRE(ctx->getTreeStats()[0].height == D);
+    REQUIRE(ctx->optimize() == D - 1);
+    REQUIRE(ctx->getTreeStats()[0].height == 1);
+    REQUIRE(ctx->getTreeStats()[0].size == D + 2);
+    REQUIRE(ctx->optimize() == 0);
+    REQUIRE(vchain[D]->neighbors[0]->val == 100.0);
+    // links exchanged by optimize are still consistent
+    for (int k = 2; k <= D; k++) G.entry->neighbors.pop_back();
+    REQUIRE(mynode_count == D + 2);
+    REQUIRE(ctx->getTreeStats()[0].height == D);
+    G.entry.reset();
+    REQUIRE(mynode_count == 0);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 15 - MyGraph forest statistics") {
+  std::cout << "begin MyGraph forest statistics" << std::endl;
+  {
+    MyGraph<double> G;
+    auto ctx = G.my_ctx().lock();
+    G.entry = G.make_node(-1.0);
+    auto ptr1 = G.make_node(1.0);
+    // -1 -> 1 -> 2 -> -1 (1 also held by root 'ptr1')
+    G.entry->neighbors.push_back(ptr1.get_owned(G.entry));
+    ptr1->neighbors.push_back(G.make_node_owned(2.0, ptr1));
+    ptr1->neighbors[0]->neighbors.push_back(
+        G.entry.get_owned(ptr1->neighbors[0]));
+    ForestStats st = ctx->getStats();
+    REQUIRE(st.nodes == 3);
+    REQUIRE(st.trees == 2);
+    REQUIRE(st.op1 == 2);
+    REQUIRE(st.op2 == 1);
+    REQUIRE(st.op3 == 2);
+    REQUIRE(st.op4 == 0);
+    REQUIRE(st.weak_links == 2);
+    REQUIRE(st.weak_links == ctx->debug_count_ownership_links().first);
+    // 1 is saved by -1
+    ptr1.reset();
+    st = ctx->getStats();
+    REQUIRE(st.trees == 1);
+    REQUIRE(st.op4 == 1);
+    REQUIRE(st.reparent_attempts == 1);
+    REQUIRE(st.reparents == 1);
+    REQUIRE(st.weak_links == 1);
+    REQUIRE(st.weak_links == ctx->debug_count_ownership_links().first);
+    REQUIRE(st.reclaimed == 0);
+    REQUIRE(st.collections == 0);
+    // owner 2 of -1 is its descendent (2 steps): cycle is reclaimed
+    G.entry.reset();
+    st = ctx->getStats();
+    REQUIRE(mynode_count == 0);
+    REQUIRE(st.nodes == 0);
+    REQUIRE(st.trees == 0);
+    REQUIRE(st.weak_links == 0);
+    REQUIRE(st.descendent_steps >= 2);
+    REQUIRE(st.reclaimed == 3);
+    REQUIRE(st.collections >= 1);
+    REQUIRE(st.pending_high_water >= 1);
+    REQUIRE(st.collect_ms >= 0.0);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 16 - MyGraph memory report") {
+  std::cout << "begin MyGraph memory report" << std::endl;
+  {
+    MyGraph<double> G;
+    const TypeDescriptor* desc = TypeDescriptor::of<MyNode<double>>();
+    REQUIRE(desc->size == sizeof(MyNode<double>));
+    REQUIRE(desc->name.find("MyNode") != std::string::npos);
+    REQUIRE(desc->getLive() == 0);
+    G.entry = G.make_node(-1.0);
+    G.entry->neighbors.push_back(G.make_node_owned(1.0, G.entry));
+    G.entry->neighbors.push_back(G.make_node_owned(2.0, G.entry));
+    G.entry->neighbors[1]->neighbors.push_back(
+        G.entry.get_owned(G.entry->neighbors[1]));
+    // unowned copy shares data with owned node
+    auto u1 = G.entry->neighbors[0].get_unowned();
+    REQUIRE(desc->getLive() == 3);
+    REQUIRE(desc->getBytes() == 3 * static_cast<long>(sizeof(MyNode<double>)));
+    auto report = G.my_ctx().lock()->getMemoryReport();
+    REQUIRE(report.types.size() == 1);
+    REQUIRE(report.types[0].name == desc->name);
+    REQUIRE(report.types[0].live == 3);
+    REQUIRE(report.object_bytes == desc->getBytes());
+    REQUIRE(report.node_bytes ==
+            static_cast<long>(4 * sizeof(TNode<TNodeData>) +
+                              3 * sizeof(TNodeData)));
+    REQUIRE(report.tree_bytes > 0);
+    REQUIRE(report.link_bytes > 0);
+    REQUIRE(report.overhead_bytes ==
+            report.node_bytes + report.tree_bytes + report.link_bytes);
+    u1.reset();
+    G.entry.reset();
+    REQUIRE(desc->getLive() == 0);
+    REQUIRE(G.my_ctx().lock()->getMemoryReport().types.empty());
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 17 - MyGraph retention explanation") {
+  std::cout << "begin MyGraph retention explanation" << std::endl;
+  {
+    relation_pool<> pool;
+    auto ctx = pool.getContext();
+    ctx->setAdaptive(true);
+    ctx->min_samples = 1000;
+    ctx->setForestMode(TreeCollectMode::DEFERRED);
+    // -1 -> 1 -> 2 and -1 -> 3 (3 weakly owns 1)
+    using Ptr = relation_ptr<MyNode<double>>;
+    auto entry = pool.make<MyNode<double>>(-1.0);
+    entry->neighbors.push_back(Ptr(new MyNode<double>(1.0), entry));  // NOLINT
+    entry->neighbors.push_back(Ptr(new MyNode<double>(3.0), entry));  // NOLINT
+    auto& p1 = entry->neighbors[0];
+    auto& p3 = entry->neighbors[1];
+    p1->neighbors.push_back(Ptr(new MyNode<double>(2.0), p1));  // NOLINT
+    p3->neighbors.push_back(p1.get_owned(p3));
+    auto& p2 = p1->neighbors[0];
+    auto id = [](const auto& ptr) { return ptr.arrow.remote_node.lock().get(); };
+    auto path = pool.explain_retention(p2);
+    REQUIRE(path.size() == 3);
+    REQUIRE(path[0].node == id(p2));
+    REQUIRE(path[0].link == RetentionLink::STRONG);
+    REQUIRE(path[0].type.find("MyNode") != std::string::npos);
+    REQUIRE(path[1].node == id(p1));
+    REQUIRE(path[1].link == RetentionLink::STRONG);
+    REQUIRE(path[2].node == id(entry));
+    REQUIRE(path[2].link == RetentionLink::ROOT);
+    auto top = pool.top_retainers(2);
+    REQUIRE(top.size() == 2);
+    REQUIRE(top[0].node == id(entry));
+    REQUIRE(top[0].retained == 4);
+    REQUIRE(top[0].root);
+    REQUIRE(top[1].node == id(p1));
+    REQUIRE(top[1].retained == 2);
+    // deferred removal of -1 -> 1: orphan subtree is weakly owned by 3
+    entry->neighbors.erase(entry->neighbors.begin());
+    REQUIRE(ctx->getDeferredSize() == 1);
+    auto& q2 = entry->neighbors[0]->neighbors[0]->neighbors[0];
+    path = pool.explain_retention(q2);
+    REQUIRE(path.size() == 4);
+    REQUIRE(path[1].link == RetentionLink::WEAK);
+    REQUIRE(path[2].link == RetentionLink::STRONG);
+    REQUIRE(path[3].node == id(entry));
+    REQUIRE(pool.top_retainers(10).size() == 4);
+    ctx->collect();
+    path = pool.explain_retention(q2);
+    REQUIRE(path.size() == 4);
+    REQUIRE(path[1].link == RetentionLink::STRONG);
+    REQUIRE(pool.explain_retention(Ptr{}).empty());
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 18 - MyGraph record and replay") {
+  std::cout << "begin MyGraph record and replay" << std::endl;
+  std::string path = "cycles_test_record.bin";
+  // same program, recorded on any forest
+  auto record = [&path](auto& pool) {
+    using DOF = typename std::decay_t<decltype(pool)>::pool_type;
+    using Node = MyNode<double, DOF>;
+    using Ptr = relation_ptr<Node, DOF>;
+    REQUIRE(pool.start_recording(path));
+    // -1 -> 1 -> 2 -> -1 (and unowned copy of 2)
+    auto entry = pool.template make<Node>(-1.0);
+    entry->neighbors.push_back(Ptr(new Node(1.0), entry));  // NOLINT
+    auto& p1 = entry->neighbors[0];
+    p1->neighbors.push_back(Ptr(new Node(2.0), p1));  // NOLINT
+    auto& p2 = p1->neighbors[0];
+    p2->neighbors.push_back(entry.get_owned(p2));
+    auto u2 = p2.get_unowned();
+    entry.reset();
+    REQUIRE(mynode_count == 3);
+    u2.reset();
+    pool.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+    pool.stop_recording();
+    std::vector<OpRecord> records;
+    REQUIRE(OpTraceReader::read(path, records));
+    std::remove(path.c_str());
+    return records;
+  };
+  auto count = [](const std::vector<OpRecord>& records, OpCode op,
+                  bool nested) {
+    return std::count_if(records.begin(), records.end(), [&](const auto& r) {
+      return (r.op == op) && (r.nested == nested);
+    });
+  };
+  std::vector<OpRecord> records;
+  {
+    relation_pool<> pool;
+    records = record(pool);
+  }
+  REQUIRE(records.size() == 8);
+  REQUIRE(count(records, OpCode::OP1, false) == 1);
+  REQUIRE(count(records, OpCode::OP2, false) == 2);
+  REQUIRE(count(records, OpCode::OP3, false) == 1);
+  REQUIRE(count(records, OpCode::OP5, false) == 1);
+  REQUIRE(count(records, OpCode::OP4, false) == 2);
+  REQUIRE(count(records, OpCode::COLLECT, false) == 1);
+  REQUIRE(records[0].size == sizeof(MyNode<double>));
+  REQUIRE(records[1].owner == records[0].node);
+  // -1 is weakly owned by 2
+  REQUIRE(records[3].node == records[0].node);
+  REQUIRE(records[3].owner == records[2].node);
+  REQUIRE(records[6].node == records[2].node);
+  REQUIRE(records[6].owner == OpRecord::ROOT);
+  {
+    OpTraceReplayer<DynowForestV1> replayer{
+        sptr<DynowForestV1>{new DynowForestV1{}}};
+    auto stats = replayer.replay(records);
+    REQUIRE(stats.ops == 8);
+    REQUIRE(stats.skipped == 0);
+    REQUIRE(stats.mismatches == 0);
+    REQUIRE(replayer.getLiveObjects() == 0);
+  }
+  // same trace on another forest (and replay on it)
+  {
+    relation_pool<DynowForestRC> pool;
+    auto rc_records = record(pool);
+    REQUIRE(rc_records.size() == records.size());
+    for (std::size_t i = 0; i < records.size(); i++) {
+      REQUIRE(rc_records[i].op == records[i].op);
+      REQUIRE(rc_records[i].node == records[i].node);
+      REQUIRE(rc_records[i].owner == records[i].owner);
+    }
+  }
+  {
+    OpTraceReplayer<DynowForestRC> replayer{
+        sptr<DynowForestRC>{new DynowForestRC{}}};
+    auto stats = replayer.replay(records);
+    REQUIRE(stats.ops == 8);
+    REQUIRE(stats.skipped == 0);
+    REQUIRE(stats.mismatches == 0);
+    REQUIRE(replayer.getLiveObjects() == 0);
+  }
+  // long recording: ids of dead objects are dropped
+  {
+    relation_pool<> pool;
+    REQUIRE(pool.start_recording(path));
+    auto entry = pool.make<MyNode<double>>(-1.0);
+    for (int i = 0; i < 20000; i++) {
+      auto ptr = pool.make<MyNode<double>>(i);
+      entry->neighbors.push_back(ptr.get_owned(entry));
+      if (entry->neighbors.size() > 10)
+        entry->neighbors.erase(entry->neighbors.begin());
+    }
+    auto* rec =
+        dynamic_cast<RecordingForest<DynowForestV1>*>(pool.getContext().get());
+    REQUIRE(rec);
+    REQUIRE(mynode_count == 11);
+    REQUIRE(rec->getIdCount() <= 2048);
+    pool.stop_recording();
+    std::remove(path.c_str());
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 19 - MyGraph pause statistics") {
+  std::cout << "begin MyGraph pause statistics" << std::endl;
+  // log buckets: exact below 8, then 8 steps per power of two
+  PauseHistogram h;
+  REQUIRE(h.p99Ns() == 0);
+  for (long v = 1; v <= 1000; v++) h.record(v * 1000);
+  REQUIRE(h.count() == 1000);
+  REQUIRE(h.minNs() == 1000);
+  REQUIRE(h.maxNs() == 1000000);
+  REQUIRE(h.totalNs() == 500500000);
+  REQUIRE(h.p50Ns() >= 500000);
+  REQUIRE(h.p50Ns() <= 500000 * 1.125);
+  REQUIRE(h.p99Ns() >= 990000);
+  REQUIRE(h.p999Ns() == 1000000);
+  for (int b = 1; b < PauseHistogram::BUCKETS; b++)
+    REQUIRE(PauseHistogram::lowerBound(b) ==
+            PauseHistogram::upperBound(b - 1) + 1);
+  REQUIRE(PauseHistogram::bucketOf(PauseHistogram::lowerBound(100)) == 100);
+  PauseHistogram h2;
+  h2.record(5);
+  h2.merge(h);
+  REQUIRE(h2.count() == 1001);
+  REQUIRE(h2.minNs() == 5);
+  h.reset();
+  REQUIRE(h.count() == 0);
+  REQUIRE(h.maxNs() == 0);
+  {
+    MyGraph<double> G;
+    auto ctx = G.my_ctx().lock();
+    G.entry = G.make_node(-1.0);
+    auto ptr1 = G.make_node(1.0);
+    // -1 -> 1 -> 2 -> -1 (1 also held by root 'ptr1')
+    G.entry->neighbors.push_back(ptr1.get_owned(G.entry));
+    ptr1->neighbors.push_back(G.make_node_owned(2.0, ptr1));
+    ptr1->neighbors[0]->neighbors.push_back(
+        G.entry.get_owned(ptr1->neighbors[0]));
+    // 1 is saved by -1: no collection
+    ptr1.reset();
+    PauseStats ps = ctx->getPauseStats();
+    REQUIRE(ps.collect.count() == 0);
+    REQUIRE(ps.remove.count() == 0);
+    // cycle is reclaimed by auto collect, inside removal of -1
+    G.entry.reset();
+    REQUIRE(mynode_count == 0);
+    ps = ctx->getPauseStats();
+    REQUIRE(ps.collect.count() == 1);
+    REQUIRE(ps.remove.count() == 1);
+    REQUIRE(ps.remove.maxNs() >= ps.collect.maxNs());
+    // new interval
+    ctx->resetPauseStats();
+    REQUIRE(ctx->getPauseStats().collect.count() == 0);
+    // without auto collect, many removals wait for a single collection
+    ctx->setAutoCollect(false);
+    for (int i = 0; i < 4; i++) {
+      auto ptr = G.make_node(i);
+      ptr->neighbors.push_back(G.make_node_owned(-i, ptr));
+      ptr->neighbors[0]->neighbors.push_back(ptr.get_owned(ptr->neighbors[0]));
+    }
+    REQUIRE(mynode_count == 8);
+    REQUIRE(ctx->pending.size() == 4);
+    ps = ctx->getPauseStats();
+    REQUIRE(ps.collect.count() == 0);
+    ctx->collect();
+    REQUIRE(mynode_count == 0);
+    ps = ctx->getPauseStats();
+    REQUIRE(ps.collect.count() == 1);
+    REQUIRE(ps.remove.count() == 0);
+    ctx->setAutoCollect(true);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 20 - MyGraph for_each_reachable",
+                   "", DynowForestV1, DynowForestRC) {
+  std::cout << "begin MyGraph for_each_reachable" << std::endl;
+  using Node = MyNode<double, TestType>;
+  {
+    MyGraph<double, TestType> G;
+    syncCycles<TestType>(G.my_ctx().lock());
+    // deep list -1 -> 0 -> 1 -> ... -> N-1 -> -1 (no recursion on traversal)
+    const int N = 10000;
+    G.entry = G.make_node(-1.0);
+    Node* last = G.entry.get();
+    last->neighbors.push_back(G.make_node_owned(0, G.entry));
+    for (int i = 1; i < N; i++) {
+      auto& prev = last->neighbors[0];
+      prev->neighbors.push_back(G.make_node_owned(i, prev));
+      last = prev.get();
+    }
+    auto& tail = last->neighbors[0];
+    tail->neighbors.push_back(G.entry.get_owned(tail));
+    REQUIRE(mynode_count == N + 1);
+    int count = 0;
+    double sum = 0;
+    auto visit = [&](const Node& n) {
+      count++;
+      sum += n.val;
+    };
+    G.forEachFrom(G.entry, visit);
+    REQUIRE(count == N + 1);
+    REQUIRE(sum == (N - 1.0) * N / 2 - 1);
+    // from last node, cycle reaches all (again: new traversal epoch)
+    count = 0;
+    G.forEachFrom(tail, visit);
+    REQUIRE(count == N + 1);
+    // unowned copy of owned node is the same object
+    auto copy = G.entry->neighbors[0].get_unowned();
+    count = 0;
+    G.forEachFrom(copy, visit);
+    REQUIRE(count == N + 1);
+    copy.reset();
+    // null root visits nothing
+    relation_ptr<Node, TestType> null_ptr;
+    count = 0;
+    G.forEachFrom(null_ptr, visit);
+    REQUIRE(count == 0);
+    G.entry.reset();
+    REQUIRE(mynode_count == 0);
+  }
+  // type-erased root: every object is visited as void*
+  {
+    relation_pool<TestType> pool;
+    relation_ptr<void, TestType> ptr{nullptr, pool};
+    ptr = relation_ptr<double, TestType>{new double{1}, pool};
+    int count = 0;
+    pool.for_each_reachable(ptr, [&](void* p) {
+      count++;
+      REQUIRE(*static_cast<double*>(p) == 1);
+    });
+    REQUIRE(count == 1);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEMPLATE_TEST_CASE(
+    "CyclesTestGraph: TEST_CASE 21 - MyGraph parallel_for_each_reachable", "",
+    DynowForestV1, DynowForestRC) {
+  std::cout << "begin MyGraph parallel_for_each_reachable" << std::endl;
+  using Node = MyNode<double, TestType>;
+  {
+    MyGraph<double, TestType> G;
+    // random graph over V vertices, reachable from vertex 0 through a cycle
+    const int V = 3000;
+    std::vector<relation_ptr<Node, TestType>> vertex;
+    for (int i = 0; i < V; i++) vertex.push_back(G.make_node(i));
+    for (int i = 0; i < V; i++) {
+      int j = (i + 1) % V;
+      vertex[i]->neighbors.push_back(vertex[j].get_owned(vertex[i]));
+    }
+    srand(999999);
+    for (int k = 0; k < 4 * V; k++) {
+      int i = ::rand() % V;
+      int j = ::rand() % V;
+      vertex[i]->neighbors.push_back(vertex[j].get_owned(vertex[i]));
+    }
+    auto root = std::move(vertex[0]);
+    vertex.clear();
+    REQUIRE(mynode_count == V);
+    auto ctx = G.my_ctx().lock();
+    for (int threads : {1, 2, 4, 8}) {
+      std::vector<std::atomic<int>> hits(V);
+      std::atomic<bool> frozen{true};
+      G.parallelForEachFrom(
+          root,
+          [&](const Node& n) {
+            hits[static_cast<int>(n.val)]++;
+            if (!ctx->isFrozen()) frozen = false;
+          },
+          threads);
+      int once = 0;
+      for (auto& h : hits) once += (h.load() == 1);
+      REQUIRE(once == V);
+      REQUIRE(frozen);
+      REQUIRE(!ctx->isFrozen());
+    }
+    // unreachable part is not visited
+    root->neighbors.clear();
+    std::atomic<int> count{0};
+    G.parallelForEachFrom(root, [&](const Node&) { count++; }, 4);
+    REQUIRE(count == 1);
+    root.reset();
+    ctx->collect();
+    REQUIRE(mynode_count == 0);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 22 - MyGraph owns_transitively",
+                   "", DynowForestV1, DynowForestRC) {
+  std::cout << "begin MyGraph owns_transitively" << std::endl;
+  using Node = MyNode<double, TestType>;
+  using Ptr = relation_ptr<Node, TestType>;
+  {
+    relation_pool<TestType> pool;
+    // list -1 -> 0 -> 1 -> ... -> N-1 (owned nodes)
+    const int N = 1000;
+    auto entry = Ptr{new Node(-1), pool};
+    std::vector<Ptr*> list{&entry};
+    for (int i = 0; i < N; i++) {
+      auto& prev = *list.back();
+      prev->neighbors.push_back(Ptr{new Node(i), prev});
+      list.push_back(&prev->neighbors.back());
+    }
+    auto& tail = *list.back();
+    auto other = Ptr{new Node(-2), pool};
+    REQUIRE(pool.owns_transitively(entry, tail));
+    REQUIRE(pool.owns_transitively(entry, entry));
+    REQUIRE(!pool.owns_transitively(tail, entry));
+    REQUIRE(!pool.owns_transitively(entry, other));
+    // bounded search: tail has N owners up to entry
+    REQUIRE(pool.reachability(other, tail, 10) == Reachability::UNKNOWN);
+    REQUIRE(pool.reachability(other, tail) == Reachability::UNREACHABLE);
+    // tree forest: found on ancestors of tail (no search)
+    REQUIRE_TREE(pool.reachability(entry, tail, 10) == Reachability::REACHABLE);
+    // weak links: -2 -> N-1 -> -1
+    tail->neighbors.push_back(entry.get_owned(tail));
+    other->neighbors.push_back(tail.get_owned(other));
+    REQUIRE(pool.owns_transitively(tail, entry));
+    REQUIRE(pool.owns_transitively(other, entry));
+    REQUIRE(pool.owns_transitively(other, *list[N / 2]));
+    REQUIRE(!pool.owns_transitively(entry, other));
+    // unowned copy is the same object
+    auto copy = list[1]->get_unowned();
+    REQUIRE(pool.owns_transitively(copy, tail));
+    REQUIRE(pool.owns_transitively(entry, copy));
+    copy.reset();
+    // batched: same source shares one traversal
+    std::vector<std::pair<const Ptr*, const Ptr*>> queries;
+    for (int i = 0; i <= N; i += 100) queries.emplace_back(&entry, list[i]);
+    queries.emplace_back(&entry, &other);
+    queries.emplace_back(&tail, &other);
+    queries.emplace_back(&other, &entry);
+    Ptr null_ptr;
+    queries.emplace_back(&null_ptr, &entry);
+    queries.emplace_back(&entry, &null_ptr);
+    // null target pointer, with other targets and alone
+    queries.emplace_back(&entry, nullptr);
+    queries.emplace_back(list[N / 2], nullptr);
+    queries.emplace_back(nullptr, &entry);
+    auto answers = pool.owns_transitively(queries);
+    REQUIRE(answers.size() == queries.size());
+    for (std::size_t i = 0; i < queries.size(); i++) {
+      bool expected = queries[i].first && queries[i].second &&
+                      (queries[i].first != &null_ptr) &&
+                      (queries[i].second != &null_ptr) &&
+                      (queries[i].second != &other);
+      REQUIRE(answers[i] == expected);
+    }
+    tail->neighbors.clear();
+    entry.reset();
+    other.reset();
+    pool.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 23 - MyGraph clone_reachable",
+                   "", DynowForestV1, DynowForestTrace, DynowForestRC) {
+  std::cout << "begin MyGraph clone_reachable" << std::endl;
+  using Node = MyNode<double, TestType>;
+  using Ptr = relation_ptr<Node, TestType>;
+  auto copy_fn = [](const Node& n, const auto& remap) {
+    auto* c = new Node(n.val);
+    for (auto& e : n.neighbors) c->neighbors.push_back(remap(e));
+    return c;
+  };
+  auto sum_from = [](relation_pool<TestType>& pool, const Ptr& root) {
+    double sum = 0;
+    pool.for_each_reachable(root, [&](const Node& n) { sum += n.val; });
+    return sum;
+  };
+  {
+    relation_pool<TestType> source;
+    relation_pool<TestType> target;
+    // 0 -> 1 -> 2 -> 0, 1 -> 3 (twice), 3 -> 3, and unreachable -1 -> 0
+    auto entry = Ptr{new Node(0), source};
+    entry->neighbors.push_back(Ptr{new Node(1), entry});
+    auto& p1 = entry->neighbors[0];
+    p1->neighbors.push_back(Ptr{new Node(2), p1});
+    p1->neighbors[0]->neighbors.push_back(entry.get_owned(p1->neighbors[0]));
+    p1->neighbors.push_back(Ptr{new Node(3), p1});
+    p1->neighbors.push_back(p1->neighbors[1].get_owned(p1));
+    auto& p3 = p1->neighbors[1];
+    p3->neighbors.push_back(p3.get_owned(p3));
+    auto other = Ptr{new Node(-1), source};
+    other->neighbors.push_back(entry.get_owned(other));
+    REQUIRE(mynode_count == 5);
+    //
+    auto clone = source.clone_reachable(entry, target, copy_fn);
+    REQUIRE(clone);
+    REQUIRE(mynode_count == 9);
+    REQUIRE(clone.get() != entry.get());
+    REQUIRE(sum_from(target, clone) == 6);
+    REQUIRE(clone->neighbors[0]->neighbors.size() == 3);
+    auto& c1 = clone->neighbors[0];
+    REQUIRE(c1->neighbors[1].get() == c1->neighbors[2].get());
+    REQUIRE(c1->neighbors[0]->neighbors[0].get() == clone.get());
+    REQUIRE(target.owns_transitively(c1, clone));
+    // copies are independent from source
+    clone->val = 100;
+    REQUIRE(entry->val == 0);
+    // source is dropped: clone lives on
+    entry.reset();
+    other.reset();
+    source.getContext()->collect();
+    REQUIRE(mynode_count == 4);
+    REQUIRE(sum_from(target, clone) == 106);
+    // relations of clone behave as any other
+    c1->neighbors.pop_back();
+    c1->neighbors.pop_back();
+    target.getContext()->collect();
+    REQUIRE(mynode_count == 3);
+    // unowned copy of owned object as root: same object
+    auto copy = c1->neighbors[0].get_unowned();
+    auto clone2 = target.clone_reachable(copy, target, copy_fn);
+    REQUIRE(mynode_count == 6);
+    REQUIRE(sum_from(target, clone2) == 103);
+    REQUIRE(clone2->val == 2);
+    copy.reset();
+    clone.reset();
+    clone2.reset();
+    target.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+    // null root
+    Ptr null_ptr;
+    REQUIRE(!source.clone_reachable(null_ptr, target, copy_fn));
+  }
+  REQUIRE(mynode_count == 0);
+  {
+    relation_pool<TestType> source;
+    relation_pool<TestType> target;
+    // 0 -> 1 -> 2 -> 0
+    auto entry = Ptr{new Node(0), source};
+    entry->neighbors.push_back(Ptr{new Node(1), entry});
+    auto& p1 = entry->neighbors[0];
+    p1->neighbors.push_back(Ptr{new Node(2), p1});
+    p1->neighbors[0]->neighbors.push_back(entry.get_owned(p1->neighbors[0]));
+    REQUIRE(mynode_count == 3);
+    // relations remapped twice: second one is null
+    auto twice_fn = [](const Node& n, const auto& remap) {
+      auto* c = new Node(n.val);
+      for (auto& e : n.neighbors) {
+        c->neighbors.push_back(remap(e));
+        c->neighbors.push_back(remap(e));
+      }
+      return c;
+    };
+    auto clone = source.clone_reachable(entry, target, twice_fn);
+    REQUIRE(mynode_count == 6);
+    REQUIRE(clone->neighbors.size() == 2);
+    REQUIRE(clone->neighbors[0]);
+    REQUIRE(!clone->neighbors[1]);
+    REQUIRE(sum_from(target, clone) == 3);
+    // each copied relation is dropped once
+    clone.reset();
+    target.getContext()->collect();
+    REQUIRE(mynode_count == 3);
+    // relations never remapped: copies only held by them are dropped
+    auto skip_fn = [](const Node& n, const auto&) { return new Node(n.val); };
+    clone = source.clone_reachable(entry, target, skip_fn);
+    target.getContext()->collect();
+    REQUIRE(mynode_count == 4);
+    REQUIRE(clone->val == 0);
+    REQUIRE(clone->neighbors.empty());
+    REQUIRE(sum_from(target, clone) == 0);
+    clone.reset();
+    entry.reset();
+    source.getContext()->collect();
+    target.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 24 - MyGraph absorb", "",
+                   DynowForestV1, DynowForestTrace, DynowForestRC) {
+  std::cout << "begin MyGraph absorb" << std::endl;
+  using Node = MyNode<double, TestType>;
+  using Ptr = relation_ptr<Node, TestType>;
+  auto sum_from = [](relation_pool<TestType>& pool, const Ptr& root) {
+    double sum = 0;
+    pool.for_each_reachable(root, [&](const Node& n) { sum += n.val; });
+    return sum;
+  };
+  {
+    relation_pool<TestType> shared;
+    auto a = Ptr{new Node(1), shared};
+    // worker builds cycle 2 -> 3 -> 4 -> 2 on its private pool
+    relation_pool<TestType> worker;
+    Ptr b;
+    std::thread t([&]() {
+      b = Ptr{new Node(2), worker};
+      b->neighbors.push_back(Ptr{new Node(3), b});
+      auto& c = b->neighbors[0];
+      c->neighbors.push_back(Ptr{new Node(4), c});
+      c->neighbors[0]->neighbors.push_back(b.get_owned(c->neighbors[0]));
+    });
+    t.join();
+    REQUIRE(mynode_count == 4);
+    shared.absorb(std::move(worker));
+    REQUIRE(b.get_ctx() == shared.getContext());
+    REQUIRE(shared.getContext()->getForestSize() == 2);
+    // relations between objects of both pools
+    a->neighbors.push_back(b.get_owned(a));
+    REQUIRE(sum_from(shared, a) == 10);
+    REQUIRE(shared.owns_transitively(a, b->neighbors[0]));
+    // worker pool is empty and can be used again
+    auto w = Ptr{new Node(5), worker};
+    REQUIRE(w.get_ctx() == worker.getContext());
+    REQUIRE(w.get_ctx() != shared.getContext());
+    // absorbed twice: relations follow both moves
+    relation_pool<TestType> main_pool;
+    main_pool.absorb(std::move(shared));
+    REQUIRE(a.get_ctx() == main_pool.getContext());
+    REQUIRE(b.get_ctx() == main_pool.getContext());
+    // forwarding stays a single hop (context of worker is repointed)
+    REQUIRE(b.ctx->absorbed_by == main_pool.getContext());
+    b.reset();
+    main_pool.getContext()->collect();
+    REQUIRE(mynode_count == 5);
+    a->neighbors.clear();
+    main_pool.getContext()->collect();
+    REQUIRE(mynode_count == 2);
+    a.reset();
+    w.reset();
+    main_pool.getContext()->collect();
+    worker.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+  }
+  REQUIRE(mynode_count == 0);
+  {
+    // absorbed contexts are dropped with the pool that absorbed them
+    relation_pool<TestType> shared;
+    relation_pool<TestType> worker;
+    auto b = Ptr{new Node(2), worker};
+    b->neighbors.push_back(Ptr{new Node(3), b});
+    wptr<TestType> old_ctx = worker.getContext();
+    REQUIRE(shared.absorb(std::move(worker)));
+    REQUIRE(b.get_ctx() == shared.getContext());
+    b.reset();
+    REQUIRE(!old_ctx.expired());
+    shared.clear();
+    REQUIRE(old_ctx.expired());
+    REQUIRE(mynode_count == 0);
+    // also on move assignment
+    b = Ptr{new Node(4), worker};
+    old_ctx = worker.getContext();
+    REQUIRE(shared.absorb(std::move(worker)));
+    b.reset();
+    shared = relation_pool<TestType>{};
+    REQUIRE(old_ctx.expired());
+    REQUIRE(mynode_count == 0);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 25 - MyGraph transfer", "",
+                   DynowForestV1, DynowForestTrace, DynowForestRC) {
+  std::cout << "begin MyGraph transfer" << std::endl;
+  using Node = MyNode<double, TestType>;
+  using Ptr = relation_ptr<Node, TestType>;
+  auto rehome_fn = [](Node& n, const auto& rehome) {
+    for (auto& e : n.neighbors) rehome(e);
+  };
+  auto sum_from = [](relation_pool<TestType>& pool, const Ptr& root) {
+    double sum = 0;
+    pool.for_each_reachable(root, [&](const Node& n) { sum += n.val; });
+    return sum;
+  };
+  {
+    relation_pool<TestType> producer;
+    relation_pool<TestType> consumer;
+    auto c = Ptr{new Node(10), consumer};
+    // producer builds 1 -> 2 -> 3 -> 1 and 2 -> 2, and 4 -> 2 from outside
+    Ptr r;
+    Ptr x;
+    std::thread t([&]() {
+      r = Ptr{new Node(1), producer};
+      r->neighbors.push_back(Ptr{new Node(2), r});
+      auto& a = r->neighbors[0];
+      a->neighbors.push_back(Ptr{new Node(3), a});
+      a->neighbors[0]->neighbors.push_back(r.get_owned(a->neighbors[0]));
+      a->neighbors.push_back(a.get_owned(a));
+      x = Ptr{new Node(4), producer};
+      x->neighbors.push_back(a.get_owned(x));
+    });
+    t.join();
+    REQUIRE(mynode_count == 5);
+    // relation from 4 crosses the boundary: nothing is moved
+    long crossing = -1;
+    auto moved =
+        producer.transfer(std::move(r), consumer, rehome_fn, &crossing);
+    REQUIRE(!moved);
+    REQUIRE(crossing == 1);
+    REQUIRE(r);
+    REQUIRE(sum_from(producer, r) == 6);
+    // owned relation cannot be moved
+    REQUIRE(!producer.transfer(std::move(x->neighbors[0]), consumer, rehome_fn,
+                               &crossing));
+    REQUIRE(crossing == 1);
+    x->neighbors.clear();
+    moved = producer.transfer(std::move(r), consumer, rehome_fn, &crossing);
+    REQUIRE(moved);
+    REQUIRE(crossing == 0);
+    REQUIRE(!r);
+    REQUIRE(moved.get_ctx() == consumer.getContext());
+    REQUIRE(moved->neighbors[0]->neighbors[0].get_ctx() ==
+            consumer.getContext());
+    REQUIRE(producer.getContext()->getForestSize() == 1);
+    REQUIRE(consumer.getContext()->getForestSize() == 2);
+    REQUIRE(sum_from(consumer, moved) == 6);
+    REQUIRE(mynode_count == 5);
+    // moved relations behave as any other relation of consumer
+    moved->neighbors[0]->neighbors[0]->neighbors.push_back(
+        c.get_owned(moved->neighbors[0]->neighbors[0]));
+    REQUIRE(sum_from(consumer, moved) == 16);
+    x.reset();
+    producer.getContext()->collect();
+    REQUIRE(mynode_count == 4);
+    moved.reset();
+    consumer.getContext()->collect();
+    REQUIRE(mynode_count == 1);
+    c.reset();
+    consumer.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 26 - MyGraph cross-pool", "",
+                   DynowForestV1, DynowForestTrace, DynowForestRC) {
+  std::cout << "begin MyGraph cross-pool" << std::endl;
+  using Node = MyNode<double, TestType>;
+  using Ptr = relation_ptr<Node, TestType>;
+  {
+    relation_pool<TestType> shard_a;
+    relation_pool<TestType> shard_b;
+    auto a = Ptr{new Node(1), shard_a};
+    auto b = Ptr{new Node(2), shard_b};
+    b->neighbors.push_back(Ptr{new Node(3), b});
+    // 1 (shard a) owns 2 (shard b)
+    a->neighbors.push_back(b.get_owned_external(a));
+    REQUIRE(a->neighbors[0].get_ctx() == shard_b.getContext());
+    REQUIRE(a->neighbors[0]->val == 2);
+    // external anchor is hidden from forest size
+    REQUIRE(shard_b.getContext()->getForestSize() == 1);
+    REQUIRE(shard_b.getContext()->getExternalCount() == 1);
+    // shard b cannot be absorbed while shard a points into it
+    relation_pool<TestType> merged;
+    REQUIRE(!merged.absorb(std::move(shard_b)));
+    REQUIRE(a->neighbors[0].get_ctx() == shard_b.getContext());
+    b.reset();
+    shard_b.getContext()->collect();
+    REQUIRE(mynode_count == 3);
+    REQUIRE(a->neighbors[0]->neighbors[0]->val == 3);
+    // each shard works on its own thread: 1 is dropped on thread of shard
+    // a, while shard b keeps changing
+    std::thread ta([&]() {
+      a.reset();
+      shard_a.getContext()->collect();
+    });
+    std::thread tb([&]() {
+      for (int i = 0; i < 100; i++) {
+        auto tmp = Ptr{new Node(100 + i), shard_b};
+        tmp->neighbors.push_back(tmp.get_owned(tmp));
+      }
+      shard_b.getContext()->collect();
+    });
+    ta.join();
+    tb.join();
+    // removal queued by shard a is applied by shard b
+    shard_b.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+    // cross relation dropped on the pool that owns its target
+    auto c = Ptr{new Node(4), shard_a};
+    auto d = Ptr{new Node(5), shard_b};
+    c->neighbors.push_back(d.get_owned_external(c));
+    d.reset();
+    c->neighbors.clear();
+    shard_b.getContext()->collect();
+    c.reset();
+    shard_a.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+    // no cross-pool relation left: anchor is removed and shard b absorbed
+    REQUIRE(shard_b.getContext()->getExternalCount() == 0);
+    auto e = Ptr{new Node(6), shard_b};
+    REQUIRE(merged.absorb(std::move(shard_b)));
+    REQUIRE(e.get_ctx() == merged.getContext());
+    REQUIRE(merged.getContext()->getForestSize() == 1);
+    e.reset();
+    merged.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 27 - MyGraph snapshot", "",
+                   DynowForestV1, DynowForestTrace, DynowForestRC) {
+  std::cout << "begin MyGraph snapshot" << std::endl;
+  using Node = MyNode<double, TestType>;
+  using Ptr = relation_ptr<Node, TestType>;
+  struct Image {
+    double val;
+    int degree;
+  };
+  std::string path = "cycles_test_snapshot.bin";
+  auto project = [](const Node& n, const auto& link) {
+    int degree = 0;
+    for (auto& e : n.neighbors) degree += link(e);
+    return Image{n.val, degree};
+  };
+  auto restore = [](const Image& img, const auto& links) {
+    auto* n = new Node(img.val);
+    REQUIRE(links.size() == static_cast<std::size_t>(img.degree));
+    for (std::size_t k = 0; k < links.size(); k++)
+      n->neighbors.push_back(links(k));
+    return n;
+  };
+  auto sum_from = [](relation_pool<TestType>& pool, const Ptr& root) {
+    double sum = 0;
+    pool.for_each_reachable(root, [&](const Node& n) { sum += n.val; });
+    return sum;
+  };
+  {
+    relation_pool<TestType> source;
+    // 0 -> 1 -> 2 -> 0, 1 -> 3 (twice), 3 -> 3, and unreachable -1 -> 0
+    auto entry = Ptr{new Node(0), source};
+    entry->neighbors.push_back(Ptr{new Node(1), entry});
+    auto& p1 = entry->neighbors[0];
+    p1->neighbors.push_back(Ptr{new Node(2), p1});
+    p1->neighbors[0]->neighbors.push_back(entry.get_owned(p1->neighbors[0]));
+    p1->neighbors.push_back(Ptr{new Node(3), p1});
+    p1->neighbors.push_back(p1->neighbors[1].get_owned(p1));
+    auto& p3 = p1->neighbors[1];
+    p3->neighbors.push_back(p3.get_owned(p3));
+    auto other = Ptr{new Node(-1), source};
+    other->neighbors.push_back(entry.get_owned(other));
+    // unowned relation held by an object is not saved
+    p3->neighbors.push_back(other.get_unowned());
+    REQUIRE(mynode_count == 5);
+    REQUIRE(source.save_snapshot(entry, path, project));
+    p3->neighbors.pop_back();
+    entry.reset();
+    other.reset();
+    source.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+    //
+    relation_pool<TestType> target;
+    auto loaded = target.template load_snapshot<Node, Image>(path, restore);
+    REQUIRE(loaded);
+    REQUIRE(mynode_count == 4);
+    REQUIRE(loaded->val == 0);
+    REQUIRE(sum_from(target, loaded) == 6);
+    auto& c1 = loaded->neighbors[0];
+    REQUIRE(c1->neighbors.size() == 3);
+    REQUIRE(c1->neighbors[1].get() == c1->neighbors[2].get());
+    REQUIRE(c1->neighbors[0]->neighbors[0].get() == loaded.get());
+    REQUIRE(c1->neighbors[1]->neighbors[0].get() == c1->neighbors[1].get());
+    REQUIRE(target.owns_transitively(c1, loaded));
+    // loaded relations behave as any other
+    c1->neighbors.pop_back();
+    c1->neighbors.pop_back();
+    target.getContext()->collect();
+    REQUIRE(mynode_count == 3);
+    loaded.reset();
+    target.getContext()->collect();
+    REQUIRE(mynode_count == 0);
+    // payload type must match
+    struct Other {
+      float val;
+    };
+    REQUIRE(!target.template load_snapshot<Node, Other>(
+        path, [](const Other&, const auto&) { return new Node(0); }));
+    // stable ids must be distinct and non-zero (0 -> 1)
+    {
+      std::string ids_path = "cycles_test_snapshot_ids.bin";
+      Image img[2] = {{0.0, 1}, {1.0, 0}};
+      auto valid_ids = [&](std::vector<std::uint64_t> ids) {
+        SnapshotWriter::write(ids_path, {0, 1, 1}, {1}, ids, img,
+                              sizeof(Image), alignof(Image));
+        SnapshotImage image;
+        return image.open(ids_path);
+      };
+      REQUIRE(valid_ids({5, 7}));
+      REQUIRE(!valid_ids({5, 5}));
+      REQUIRE(!valid_ids({0, 7}));
+      std::remove(ids_path.c_str());
+    }
+    // truncated file, missing file, and null root
+    {
+      std::ifstream in(path, std::ios::binary);
+      std::string data((std::istreambuf_iterator<char>(in)),
+                       std::istreambuf_iterator<char>());
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      out.write(data.data(), static_cast<std::streamsize>(data.size() - 1));
+    }
+    REQUIRE(!target.template load_snapshot<Node, Image>(path, restore));
+    std::remove(path.c_str());
+    REQUIRE(!target.template load_snapshot<Node, Image>(path, restore));
+    Ptr null_ptr;
+    REQUIRE(!source.save_snapshot(null_ptr, path, project));
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEMPLATE_TEST_CASE("CyclesTestGraph: TEST_CASE 28 - MyGraph checkpoint_delta",
+                   "", DynowForestV1, DynowForestTrace, DynowForestRC) {
+  std::cout << "begin MyGraph checkpoint_delta" << std::endl;
+  using Node = MyNode<double, TestType>;
+  using Ptr = relation_ptr<Node, TestType>;
+  struct Image {
+    double val;
+  };
+  std::string base_path = "cycles_test_checkpoint.bin";
+  std::string compact_path = "cycles_test_compact.bin";
+  auto project = [](const Node& n, const auto& link) {
+    for (auto& e : n.neighbors) link(e);
+    return Image{n.val};
+  };
+  auto restore = [](const Image& img, const auto& links) {
+    auto* n = new Node(img.val);
+    for (std::size_t k = 0; k < links.size(); k++)
+      n->neighbors.push_back(links(k));
+    return n;
+  };
+  auto sum_from = [](relation_pool<TestType>& pool, const Ptr& root) {
+    double sum = 0;
+    pool.for_each_reachable(root, [&](const Node& n) { sum += n.val; });
+    return sum;
+  };
+  {
+    relation_pool<TestType> pool;
+    // 0 -> 1 -> 2 -> 0, 1 -> 3
+    auto entry = Ptr{new Node(0), pool};
+    entry->neighbors.push_back(Ptr{new Node(1), entry});
+    auto& p1 = entry->neighbors[0];
+    p1->neighbors.push_back(Ptr{new Node(2), p1});
+    p1->neighbors[0]->neighbors.push_back(entry.get_owned(p1->neighbors[0]));
+    p1->neighbors.push_back(Ptr{new Node(3), p1});
+    std::stringstream none;
+    REQUIRE(!pool.checkpoint_delta(entry, none, project));
+    pool.track_changes();
+    REQUIRE(pool.save_snapshot(entry, base_path, project));
+    // delta 1: new 4 owned by 3, and payload of 0 changed
+    auto& p3 = p1->neighbors[1];
+    p3->neighbors.push_back(Ptr{new Node(4), p3});
+    entry->val = 10;
+    pool.mark_changed(entry);
+    std::stringstream d1;
+    REQUIRE(pool.checkpoint_delta(entry, d1, project));
+    SnapshotDelta delta1;
+    REQUIRE(delta1.read(d1));
+    REQUIRE(delta1.ids.size() == 3);
+    REQUIRE(delta1.removed.empty());
+    REQUIRE(delta1.payload_size == sizeof(Image));
+    // nothing changed since
+    std::stringstream empty;
+    REQUIRE(pool.checkpoint_delta(entry, empty, project));
+    SnapshotDelta delta_empty;
+    REQUIRE(delta_empty.read(empty));
+    REQUIRE(delta_empty.ids.empty());
+    REQUIRE(delta_empty.root == delta1.root);
+    // delta 2: 1 drops 2 (2 is gone, 0 lost an owner)
+    p1->neighbors.erase(p1->neighbors.begin());
+    pool.getContext()->collect();
+    REQUIRE(mynode_count == 4);
+    std::stringstream d2;
+    REQUIRE(pool.checkpoint_delta(entry, d2, project));
+    SnapshotDelta delta2;
+    REQUIRE(delta2.read(d2));
+    REQUIRE(delta2.removed.size() == 1);
+    REQUIRE(delta2.ids.size() == 2);
+    // base and deltas fold into current graph
+    {
+      SnapshotImage base;
+      REQUIRE(base.open(base_path));
+      REQUIRE(base.header().nodes == 4);
+      REQUIRE(compactSnapshot(base, {delta1, delta_empty, delta2},
+                              compact_path));
+      SnapshotImage compact;
+      REQUIRE(compact.open(compact_path));
+      REQUIRE(compact.header().nodes == 4);
+      REQUIRE(compact.header().links == 3);
+      REQUIRE(compact.ids()[0] == delta2.root);
+      compact.close();
+      // payload type must match
+      SnapshotDelta other = delta2;
+      other.payload_size = 1;
+      other.payload.assign(other.ids.size(), 0);
+      REQUIRE(!compactSnapshot(base, {delta1, other}, "unused.bin"));
+      // without last delta, 2 is still there
+      std::string partial_path = "cycles_test_partial.bin";
+      REQUIRE(compactSnapshot(base, {delta1}, partial_path));
+      REQUIRE(compact.open(partial_path));
+      REQUIRE(compact.header().nodes == 5);
+      compact.close();
+      std::remove(partial_path.c_str());
+    }
+    relation_pool<TestType> restored;
+    auto loaded = restored.template load_snapshot<Node, Image>(compact_path,
+                                                               restore);
+    REQUIRE(loaded);
+    REQUIRE(mynode_count == 8);
+    REQUIRE(sum_from(restored, loaded) == 18);
+    REQUIRE(loaded->neighbors[0]->neighbors.size() == 1);
+    REQUIRE(loaded->neighbors[0]->neighbors[0]->neighbors[0]->val == 4);
+    // checkpoints go on from loaded snapshot, with same ids
+    restored.track_changes();
+    loaded->neighbors[0]->neighbors[0]->neighbors.clear();
+    restored.getContext()->collect();
+    std::stringstream d3;
+    REQUIRE(restored.checkpoint_delta(loaded, d3, project));
+    SnapshotDelta delta3;
+    REQUIRE(delta3.read(d3));
+    REQUIRE(delta3.removed.size() == 1);
+    REQUIRE(std::find(delta1.ids.begin(), delta1.ids.end(),
+                      delta3.removed[0]) != delta1.ids.end());
+    // truncated delta
+    std::string data = d3.str();
+    std::stringstream cut{data.substr(0, data.size() - 1)};
+    SnapshotDelta broken;
+    REQUIRE(!broken.read(cut));
+    // huge counts are read up to end of stream (never allocated upfront)
+    for (std::size_t at : {32, 40, 48}) {
+      std::string huge = data;
+      std::uint64_t count = std::uint64_t{1} << 60;
+      std::memcpy(&huge[at], &count, 8);
+      std::stringstream in{huge};
+      REQUIRE(!broken.read(in));
+    }
+    loaded.reset();
+    entry.reset();
+    std::remove(base_path.c_str());
+    std::remove(compact_path.c_str());
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 29 - MyGraph owner holds node twice") {
+  std::cout << "begin MyGraph owner holds node twice" << std::endl;
+  {
+    MyGraph<double> G;
+    auto ctx = G.my_ctx().lock();
+    G.entry = G.make_node(-1.0);
+    // -1 -> 1 (tree edge) and -1 -> 1 (weak link)
+    G.entry->neighbors.push_back(G.make_node_owned(1.0, G.entry));
+    G.entry->neighbors.push_back(G.entry->neighbors[0].get_owned(G.entry));
+    auto node_entry = G.entry.arrow.remote_node.lock();
+    auto node1 = G.entry->neighbors[0].arrow.remote_node.lock();
+    REQUIRE(node1->parent.lock() == node_entry);
+    REQUIRE(node1->owned_by.size() == 1);
+    // drop tree edge: old parent is new owner (node detached before search)
+    G.entry->neighbors[0].reset();
+    REQUIRE(mynode_count == 2);
+    REQUIRE(node1->parent.lock() == node_entry);
+    REQUIRE(node1->owned_by.size() == 0);
+    REQUIRE(node_entry->children.size() == 1);
+    REQUIRE(G.entry->neighbors[1]->val == 1.0);
+    node1 = nullptr;
+    G.entry->neighbors[1].reset();
+    REQUIRE(mynode_count == 1);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 30 - MyGraph rescued child one parent") {
+  std::cout << "begin MyGraph rescued child one parent" << std::endl;
+  {
+    MyGraph<double> G;
+    auto ctx = G.my_ctx().lock();
+    G.entry = G.make_node(-1.0);
+    // -1 -> 1 -> 2 (tree edges), -1 -> 3, -1 -> 4, 3 -> 2 and 4 -> 2
+    G.entry->neighbors.reserve(3);  // references below are kept
+    G.entry->neighbors.push_back(G.make_node_owned(1.0, G.entry));
+    auto& ptr1 = G.entry->neighbors[0];
+    ptr1->neighbors.push_back(G.make_node_owned(2.0, ptr1));
+    G.entry->neighbors.push_back(G.make_node_owned(3.0, G.entry));
+    G.entry->neighbors.push_back(G.make_node_owned(4.0, G.entry));
+    auto& ptr3 = G.entry->neighbors[1];
+    auto& ptr4 = G.entry->neighbors[2];
+    ptr3->neighbors.push_back(ptr1->neighbors[0].get_owned(ptr3));
+    ptr4->neighbors.push_back(ptr1->neighbors[0].get_owned(ptr4));
+    auto node2 = ptr3->neighbors[0].arrow.remote_node.lock();
+    auto node3 = ptr3.arrow.remote_node.lock();
+    auto node4 = ptr4.arrow.remote_node.lock();
+    // kill 1: child 2 is rescued by a single new parent
+    ptr1.reset();
+    REQUIRE(mynode_count == 4);
+    REQUIRE(node2->parent.lock() == node3);
+    REQUIRE(node3->children.size() == 1);
+    REQUIRE(node4->children.size() == 0);
+    REQUIRE(node2->owned_by.size() == 1);
+    // drop 3 -> 2: 4 -> 2 still holds it
+    ptr3->neighbors[0].reset();
+    REQUIRE(mynode_count == 4);
+    REQUIRE(node2->parent.lock() == node4);
+    REQUIRE(ptr4->neighbors[0]->val == 2.0);
+    node2 = nullptr;
+    ptr4->neighbors[0].reset();
+    REQUIRE(mynode_count == 3);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
+
+TEST_CASE("CyclesTestGraph: TEST_CASE 31 - MyGraph pending removals") {
+  std::cout << "begin MyGraph pending removals" << std::endl;
+  for (bool held : {false, true}) {
+    MyGraph<double> G;
+    auto ctx = G.my_ctx().lock();
+    ctx->setAutoCollect(false);
+    G.entry = G.make_node(-1.0);
+    // -1 -> 1 -> 2 (tree edges), -1 -> 3 -> 2 (and -1 -> 2, if 'held')
+    G.entry->neighbors.reserve(3);  // references below are kept
+    G.entry->neighbors.push_back(G.make_node_owned(1.0, G.entry));
+    G.entry->neighbors.push_back(G.make_node_owned(3.0, G.entry));
+    auto& ptr1 = G.entry->neighbors[0];
+    auto& ptr3 = G.entry->neighbors[1];
+    ptr1->neighbors.push_back(G.make_node_owned(2.0, ptr1));
+    ptr3->neighbors.push_back(ptr1->neighbors[0].get_owned(ptr3));
+    if (held)
+      G.entry->neighbors.push_back(ptr1->neighbors[0].get_owned(G.entry));
+    // without auto collect, both removals wait on pending list: 2 may be
+    // re-parented to pending 3, and looks for an owner again when 3 dies
+    ptr1.reset();
+    ptr3.reset();
+    REQUIRE(mynode_count == 4);
+    ctx->collect();
+    REQUIRE(mynode_count == (held ? 2 : 1));
+    if (held) REQUIRE(G.entry->neighbors[2]->val == 2.0);
+    REQUIRE(ctx->getForestSize() == 1);
+  }
+  // SHOULD NOT LEAK
+  REQUIRE(mynode_count == 0);
+}
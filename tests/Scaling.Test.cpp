@@ -0,0 +1,309 @@
+// #define CATCH_CONFIG_MAIN // This tells Catch to provide a main()
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+//
+#ifdef HEADER_ONLY
+#include <catch2/catch_amalgamated.hpp>
+#else
+#include <catch2/catch_all.hpp>
+#endif
+#include <cycles/detail/rc/DynowForestRC.hpp>
+#include <cycles/detail/trace/DynowForestTrace.hpp>
+#include <cycles/relation_ptr.hpp>
+
+using namespace std;     // NOLINT
+using namespace cycles;  // NOLINT
+
+// ==========================================================
+// asymptotic scaling tests (catch accidental O(n^2) paths)
+// ==========================================================
+// Default run: repair work of DynowForestV1 (owners tried as new parent and
+// ancestors visited on descendent checks, see ForestStats) is counted at
+// sizes n and 8n. Counts are exact, so growth exponent
+// log(W(8n)/W(n))/log(8) is checked against a tight bound on every run.
+//
+// Timed run (hidden, tag [scaling]: ./test_scaling "[scaling]"): each
+// operation family runs at sizes n and 8n on every forest (n doubles until a
+// run takes at least SCALING_MIN_MS, so timer noise is small on any machine
+// or build). Median of SCALING_REPS runs gives growth exponent
+// log(T(8n)/T(n))/log(8), which must stay below expected + slack (linear:
+// 1 + 0.5, quadratic gives 2). A wide span dilutes steps of constant
+// factors (caches, thresholds). Failing families are measured once more
+// before failing, as a single slow sample may come from a busy machine.
+// Wall-clock results depend on machine load, so this run is not part of
+// default test suites.
+// Slack can be configured by environment: CYCLES_SCALING_SLACK=0.8
+
+namespace scaling {
+
+constexpr int SCALING_REPS = 5;
+constexpr double SCALING_MIN_MS = 0.5;
+constexpr int SCALING_FACTOR = 8;
+constexpr int SCALING_MAX_N = 1 << 18;
+
+double slack() {
+  const char* env = std::getenv("CYCLES_SCALING_SLACK");
+  return env ? std::atof(env) : 0.5;
+}
+
+// family(n) returns elapsed milliseconds of its timed part
+using Family = std::function<double(int)>;
+
+double median_ms(const Family& family, int n) {
+  std::vector<double> v;
+  for (int i = 0; i < SCALING_REPS; i++) v.push_back(family(n));
+  std::sort(v.begin(), v.end());
+  return v[v.size() / 2];
+}
+
+double exponent(const std::string& name, const Family& family, int n0) {
+  int n = n0;
+  while (n < SCALING_MAX_N && median_ms(family, n) < SCALING_MIN_MS) n *= 2;
+  double t1 = median_ms(family, n);
+  double tk = median_ms(family, SCALING_FACTOR * n);
+  double e = std::log(tk / t1) / std::log(SCALING_FACTOR);
+  std::cout << "scaling " << name << ": n=" << n << " T(n)=" << t1
+            << "ms T(" << SCALING_FACTOR << "n)=" << tk << "ms exponent=" << e
+            << std::endl;
+  return e;
+}
+
+// growth exponent of family must not exceed 'expected' (plus slack)
+bool check(const std::string& name, const Family& family, double expected,
+           int n0 = 256) {
+  double limit = expected + slack();
+  if (exponent(name, family, n0) <= limit) return true;
+  std::cout << "scaling " << name << ": over limit " << limit
+            << ". measuring again..." << std::endl;
+  return exponent(name, family, n0) <= limit;
+}
+
+template <class F>
+double time_ms(F f) {
+  using namespace std::chrono;  // NOLINT
+  auto c = steady_clock::now();
+  f();
+  return duration<double, std::milli>(steady_clock::now() - c).count();
+}
+
+sptr<TNodeData> data(int v) { return TNodeData::make_sptr(new int{v}); }
+
+// ========= operation families (on any IDynowForest) =========
+
+// n independent roots (op1), then removed in creation order (op4)
+template <class DOF>
+double roots(int n) {
+  sptr<DOF> forest{new DOF{}};
+  std::vector<typename DOF::DynowArrowType> arrows;
+  arrows.reserve(n);
+  double elapsed = time_ms([&]() {
+    for (int i = 0; i < n; i++)
+      arrows.push_back(forest->op1_addNodeToNewTree(data(i)));
+    for (auto& arrow : arrows) forest->op4_remove(arrow);
+  });
+  forest->destroyAll();
+  return elapsed;
+}
+
+// chain of n strong children (op2), released from its root (op4)
+template <class DOF>
+double chain(int n) {
+  sptr<DOF> forest{new DOF{}};
+  auto root = forest->op1_addNodeToNewTree(data(0));
+  double elapsed = time_ms([&]() {
+    auto last = root;
+    for (int i = 1; i < n; i++)
+      last = forest->op2_addChildStrong(last, data(i));
+    forest->op4_remove(root);
+  });
+  forest->destroyAll();
+  return elapsed;
+}
+
+// root with n strong children (op2), released from its root (op4)
+template <class DOF>
+double wide(int n) {
+  sptr<DOF> forest{new DOF{}};
+  auto root = forest->op1_addNodeToNewTree(data(0));
+  double elapsed = time_ms([&]() {
+    for (int i = 1; i < n; i++) forest->op2_addChildStrong(root, data(i));
+    forest->op4_remove(root);
+  });
+  forest->destroyAll();
+  return elapsed;
+}
+
+// hub weakly owns n nodes of another tree (op3), then hub dies (op4)
+template <class DOF>
+double hub(int n) {
+  sptr<DOF> forest{new DOF{}};
+  auto base = forest->op1_addNodeToNewTree(data(0));
+  auto hub = forest->op1_addNodeToNewTree(data(-1));
+  std::vector<typename DOF::DynowArrowType> children;
+  children.reserve(n);
+  for (int i = 1; i <= n; i++)
+    children.push_back(forest->op2_addChildStrong(base, data(i)));
+  double elapsed = time_ms([&]() {
+    for (auto& child : children) forest->op3_weakSetOwnedBy(child, hub);
+    forest->op4_remove(hub);
+  });
+  forest->destroyAll();
+  return elapsed;
+}
+
+// unowned copies (op5) of n owned grandchildren, removed afterwards (op4).
+// Each node has its own parent: links of a single node are plain lists on
+// V1, so n siblings would measure O(degree) costs instead of forest size.
+template <class DOF>
+double copies(int n) {
+  sptr<DOF> forest{new DOF{}};
+  auto root = forest->op1_addNodeToNewTree(data(0));
+  std::vector<typename DOF::DynowArrowType> children;
+  std::vector<typename DOF::DynowArrowType> arrows;
+  children.reserve(n);
+  arrows.reserve(n);
+  for (int i = 1; i <= n; i++) {
+    auto parent = forest->op2_addChildStrong(root, data(i));
+    children.push_back(forest->op2_addChildStrong(parent, data(-i)));
+  }
+  double elapsed = time_ms([&]() {
+    for (auto& child : children)
+      arrows.push_back(forest->op5_copyNodeToNewTree(child));
+    for (auto& arrow : arrows) forest->op4_remove(arrow);
+  });
+  forest->destroyAll();
+  return elapsed;
+}
+
+// n garbage 2-cycles (a <-> b) below a dropped root, then collect()
+template <class DOF>
+double cycles(int n) {
+  sptr<DOF> forest{new DOF{}};
+  forest->setAutoCollect(false);
+  auto garbage = forest->op1_addNodeToNewTree(data(-1));
+  for (int i = 0; i < n; i++) {
+    auto a = forest->op2_addChildStrong(garbage, data(i));
+    auto b = forest->op2_addChildStrong(a, data(-i));
+    forest->op3_weakSetOwnedBy(a, b);
+  }
+  forest->op4_remove(garbage);
+  double elapsed = time_ms([&]() { forest->collect(); });
+  forest->setAutoCollect(true);
+  forest->destroyAll();
+  return elapsed;
+}
+
+// ========= repair work of DynowForestV1 (deterministic) =========
+
+// work(n) returns repair work of its operations (see repair_work)
+using WorkFamily = std::function<long(int)>;
+
+long repair_work(const ForestStats& st) {
+  return st.reparent_attempts + st.descendent_steps;
+}
+
+// growth exponent of exact work counts must not exceed 'expected' (a linear
+// family has constant terms only below 1.0)
+bool check_work(const std::string& name, const WorkFamily& work,
+                double expected, int n = 1024) {
+  long w1 = work(n);
+  long wk = work(SCALING_FACTOR * n);
+  double e = std::log(static_cast<double>(wk) / std::max(1L, w1)) /
+             std::log(SCALING_FACTOR);
+  std::cout << "work " << name << ": n=" << n << " W(n)=" << w1 << " W("
+            << SCALING_FACTOR << "n)=" << wk << " exponent=" << e
+            << std::endl;
+  return (w1 > 0) && (e <= expected + 0.05);
+}
+
+// root with n children, each weakly owned by a second root: removal of
+// first root rescues every child
+long rescue_work(int n) {
+  sptr<DynowForestV1> forest{new DynowForestV1{}};
+  auto root = forest->op1_addNodeToNewTree(data(0));
+  auto keeper = forest->op1_addNodeToNewTree(data(-1));
+  for (int i = 1; i <= n; i++) {
+    auto child = forest->op2_addChildStrong(root, data(i));
+    forest->op3_weakSetOwnedBy(child, keeper);
+  }
+  forest->op4_remove(root);
+  long work = repair_work(forest->getStats());
+  forest->destroyAll();
+  return work;
+}
+
+// doubly linked list of n nodes (tree edges forward, weak links backward),
+// released from its head: each owner found is a descendent
+long list_work(int n) {
+  sptr<DynowForestV1> forest{new DynowForestV1{}};
+  auto head = forest->op1_addNodeToNewTree(data(0));
+  auto last = head;
+  for (int i = 1; i < n; i++) {
+    auto next = forest->op2_addChildStrong(last, data(i));
+    forest->op3_weakSetOwnedBy(last, next);
+    last = next;
+  }
+  forest->op4_remove(head);
+  long work = repair_work(forest->getStats());
+  forest->destroyAll();
+  return work;
+}
+
+// n garbage 2-cycles (a <-> b) below a dropped root, then collect()
+long cycles_work(int n) {
+  sptr<DynowForestV1> forest{new DynowForestV1{}};
+  forest->setAutoCollect(false);
+  auto garbage = forest->op1_addNodeToNewTree(data(-1));
+  for (int i = 0; i < n; i++) {
+    auto a = forest->op2_addChildStrong(garbage, data(i));
+    auto b = forest->op2_addChildStrong(a, data(-i));
+    forest->op3_weakSetOwnedBy(a, b);
+  }
+  forest->op4_remove(garbage);
+  forest->collect();
+  long work = repair_work(forest->getStats());
+  forest->setAutoCollect(true);
+  forest->destroyAll();
+  return work;
+}
+
+// ========= timed families on every forest =========
+
+template <class DOF>
+void check_all(const std::string& impl) {
+  CHECK(check(impl + " op1/op4 roots", roots<DOF>, 1.0));
+  CHECK(check(impl + " op2 chain", chain<DOF>, 1.0));
+  CHECK(check(impl + " op2 wide", wide<DOF>, 1.0));
+  CHECK(check(impl + " op3 hub", hub<DOF>, 1.0));
+  CHECK(check(impl + " collect cycles", cycles<DOF>, 1.0));
+}
+
+}  // namespace scaling
+
+TEST_CASE("Scaling: DynowForestV1 repair work grows linearly") {
+  using namespace scaling;  // NOLINT
+  CHECK(check_work("DynowForestV1 rescue", rescue_work, 1.0));
+  CHECK(check_work("DynowForestV1 list release", list_work, 1.0));
+  CHECK(check_work("DynowForestV1 collect cycles", cycles_work, 1.0));
+}
+
+TEST_CASE("Scaling: DynowForestV1 operations grow linearly", "[.scaling]") {
+  using namespace scaling;  // NOLINT
+  check_all<DynowForestV1>("DynowForestV1");
+  CHECK(check("DynowForestV1 op5 copies", copies<DynowForestV1>, 1.0));
+}
+
+TEST_CASE("Scaling: DynowForestTrace operations grow linearly",
+          "[.scaling]") {
+  scaling::check_all<DynowForestTrace>("DynowForestTrace");
+}
+
+TEST_CASE("Scaling: DynowForestRC operations grow linearly", "[.scaling]") {
+  scaling::check_all<DynowForestRC>("DynowForestRC");
+}
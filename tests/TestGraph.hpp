@@ -154,19 +154,6 @@ struct Node {
 
   explicit Node(const std::string& datum) : datum{datum}, edges{} {}
 
-  void traverse(std::function<void(const std::string&)> f,
-                std::set<std::string>& seen) const {
-    //
-    if (seen.find(this->datum) == seen.end()) {
-      return;
-    }
-    f(this->datum);
-    seen.insert(this->datum);
-    for (auto& n : this->edges) {
-      n->traverse(f, seen);
-    }
-  }
-
   // TODO(igormcoelho): this part could be improved with delegated sptr
   Node* first() const { return this->edges.at(0).get(); }
 
@@ -206,8 +193,8 @@ std::pair<relation_pool<>, relation_ptr<Node>> init() {
 void test_main() {
   auto gpair = init();
   const auto& gref = *(gpair.second.get());
-  std::set<std::string> seen;
-  gref.traverse([&](const std::string& d) { std::cout << d; }, seen);
+  gpair.first.for_each_reachable(
+      gpair.second, [](const Node& n) { std::cout << n.datum; });
   Node* f = gref.first();
   foo(*f);
 }
@@ -237,19 +224,6 @@ struct Node {
 
   explicit Node(const std::string& datum) : datum{datum}, edges{} {}
 
-  void traverse(std::function<void(const std::string&)> f,
-                std::set<std::string>& seen) const {
-    //
-    if (seen.find(this->datum) == seen.end()) {
-      return;
-    }
-    f(this->datum);
-    seen.insert(this->datum);
-    for (auto& n : this->edges) {
-      n->traverse(f, seen);
-    }
-  }
-
   // TODO(igormcoelho): this part could be improved with delegated sptr
   Node* first() const { return this->edges.at(0).get(); }
 
@@ -289,8 +263,8 @@ void test_main() {
   auto arena = TypedArenaCycles<Node>{};
   auto ptr = init(arena);
   const auto& gref = *(ptr.get());
-  std::set<std::string> seen;
-  gref.traverse([&](const std::string& d) { std::cout << d; }, seen);
+  arena.pool.for_each_reachable(
+      ptr, [](const Node& n) { std::cout << n.datum; });
   Node* f = gref.first();
   foo(*f);
 }
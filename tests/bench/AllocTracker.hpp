@@ -0,0 +1,115 @@
+#pragma once
+
+// C++
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// ==============================================
+// AllocTracker: global allocation counters
+// ==============================================
+// Replaces global operator new/delete, so it must be included by exactly one
+// translation unit (the benchmark main file).
+// Each block carries its size on a 16-byte header, so current and peak bytes
+// requested by program are known (allocator overhead is not included).
+// Counters are cumulative: differences of snapshot() give costs of a phase.
+
+namespace bench {
+
+class AllocTracker {
+ public:
+  static constexpr std::size_t HEADER = 16;
+
+  static std::atomic<long>& current() {
+    static std::atomic<long> bytes{0};
+    return bytes;
+  }
+
+  static std::atomic<long>& peak() {
+    static std::atomic<long> bytes{0};
+    return bytes;
+  }
+
+  static std::atomic<long>& allocs() {
+    static std::atomic<long> count{0};
+    return count;
+  }
+
+  static std::atomic<long>& frees() {
+    static std::atomic<long> count{0};
+    return count;
+  }
+
+  // cumulative bytes of all allocations (and of all releases)
+  static std::atomic<long>& allocated() {
+    static std::atomic<long> bytes{0};
+    return bytes;
+  }
+
+  static std::atomic<long>& freed() {
+    static std::atomic<long> bytes{0};
+    return bytes;
+  }
+
+  struct Snapshot {
+    long allocs;
+    long frees;
+    long allocated;
+    long freed;
+  };
+
+  static Snapshot snapshot() {
+    return {allocs().load(), frees().load(), allocated().load(),
+            freed().load()};
+  }
+
+  // peak restarts from current usage
+  static void resetPeak() { peak().store(current().load()); }
+
+  static void* allocate(std::size_t size) {
+    void* p = std::malloc(size + HEADER);
+    if (!p) throw std::bad_alloc{};
+    *static_cast<std::size_t*>(p) = size;
+    allocs().fetch_add(1, std::memory_order_relaxed);
+    allocated().fetch_add(static_cast<long>(size), std::memory_order_relaxed);
+    long now = current().fetch_add(static_cast<long>(size),
+                                   std::memory_order_relaxed) +
+               static_cast<long>(size);
+    long old = peak().load(std::memory_order_relaxed);
+    while (now > old && !peak().compare_exchange_weak(old, now)) {
+    }
+    return static_cast<char*>(p) + HEADER;
+  }
+
+  static void release(void* ptr) {
+    if (!ptr) return;
+    void* p = static_cast<char*>(ptr) - HEADER;
+    std::size_t size = *static_cast<std::size_t*>(p);
+    frees().fetch_add(1, std::memory_order_relaxed);
+    freed().fetch_add(static_cast<long>(size), std::memory_order_relaxed);
+    current().fetch_sub(static_cast<long>(size), std::memory_order_relaxed);
+    std::free(p);
+  }
+};
+
+}  // namespace bench
+
+void* operator new(std::size_t size) {
+  return bench::AllocTracker::allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+  return bench::AllocTracker::allocate(size);
+}
+
+void operator delete(void* p) noexcept { bench::AllocTracker::release(p); }
+
+void operator delete[](void* p) noexcept { bench::AllocTracker::release(p); }
+
+void operator delete(void* p, std::size_t) noexcept {
+  bench::AllocTracker::release(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  bench::AllocTracker::release(p);
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+//
+#include "PerfCounters.hpp"
+
+// ==============================================
+// BenchReport: repetitions and report of timings
+// ==============================================
+// Shared by benchmark executables on tests/bench/
+// - each measured function is one full experiment (build and teardown)
+// - warmup runs are discarded
+// - results are written as JSON (array of objects) or CSV
+// - with --perf, hardware counters per unit of n (e.g., cycles_per_op) are
+//   added to results, when perf events are permitted (see PerfCounters)
+
+namespace bench {
+
+struct BenchOptions {
+  bool quick{false};
+  int reps{5};
+  int warmup{1};
+  std::string format{"json"};  // json or csv
+  std::string out;             // empty: stdout
+  std::string suite;           // only suites containing this string
+  std::string impl;            // only impls containing this string
+  // larger sizes of a suite/impl are skipped once a median exceeds budget
+  double budget_ms{10000};
+  // hardware counters (Linux perf_event_open), when permitted
+  bool perf{false};
+};
+
+// parses common options. Returns false (after printing usage) on error.
+inline bool parseOptions(int argc, char** argv, BenchOptions& opts) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = (i + 1 < argc);
+    if (arg == "--quick") {
+      opts.quick = true;
+    } else if (arg == "--reps" && has_value) {
+      opts.reps = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--warmup" && has_value) {
+      opts.warmup = std::max(0, std::atoi(argv[++i]));
+    } else if (arg == "--format" && has_value) {
+      opts.format = argv[++i];
+      if (opts.format != "json" && opts.format != "csv") {
+        std::cerr << "unknown format: " << opts.format << std::endl;
+        return false;
+      }
+    } else if (arg == "--out" && has_value) {
+      opts.out = argv[++i];
+    } else if (arg == "--suite" && has_value) {
+      opts.suite = argv[++i];
+    } else if (arg == "--impl" && has_value) {
+      opts.impl = argv[++i];
+    } else if (arg == "--budget-ms" && has_value) {
+      opts.budget_ms = std::atof(argv[++i]);
+    } else if (arg == "--perf") {
+      opts.perf = true;
+    } else {
+      std::cerr << "usage: " << argv[0]
+                << " [--quick] [--reps N] [--warmup N] [--format json|csv]"
+                << " [--out FILE] [--suite NAME] [--impl NAME]"
+                << " [--budget-ms MS] [--perf]" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+struct BenchResult {
+  std::string suite;
+  std::string impl;
+  long n{0};  // number of nodes
+  long e{0};  // number of edges (graphs only)
+  std::vector<double> samples_ms;
+  // optional extra columns (e.g., allocations, bytes)
+  std::vector<std::pair<std::string, double>> extras;
+
+  double median() const {
+    if (samples_ms.empty()) return 0;
+    auto v = samples_ms;
+    std::sort(v.begin(), v.end());
+    std::size_t m = v.size() / 2;
+    return (v.size() % 2 == 1) ? v[m] : (v[m - 1] + v[m]) / 2;
+  }
+
+  double min() const {
+    return samples_ms.empty()
+               ? 0
+               : *std::min_element(samples_ms.begin(), samples_ms.end());
+  }
+
+  double max() const {
+    return samples_ms.empty()
+               ? 0
+               : *std::max_element(samples_ms.begin(), samples_ms.end());
+  }
+
+  double mean() const {
+    if (samples_ms.empty()) return 0;
+    double sum = 0;
+    for (double s : samples_ms) sum += s;
+    return sum / samples_ms.size();
+  }
+
+  double stddev() const {
+    if (samples_ms.size() < 2) return 0;
+    double avg = mean();
+    double sq = 0;
+    for (double s : samples_ms) sq += (s - avg) * (s - avg);
+    return std::sqrt(sq / (samples_ms.size() - 1));
+  }
+};
+
+class BenchReport {
+ public:
+  BenchOptions opts;
+  std::vector<BenchResult> results;
+  // suite/impl pairs that exceeded time budget
+  std::vector<std::pair<std::string, std::string>> over_budget;
+
+  explicit BenchReport(BenchOptions _opts) : opts{std::move(_opts)} {
+    if (opts.perf) opts.perf = PerfCounters::instance().open();
+  }
+
+  bool selected(const std::string& suite, const std::string& impl) const {
+    auto key = std::make_pair(suite, impl);
+    if (std::find(over_budget.begin(), over_budget.end(), key) !=
+        over_budget.end())
+      return false;
+    return (suite.find(opts.suite) != std::string::npos) &&
+           (impl.find(opts.impl) != std::string::npos);
+  }
+
+  // runs f() warmup+reps times, keeping reps timings (in milliseconds).
+  // Progress goes to std::cerr, so stdout only has report.
+  BenchResult& measure(const std::string& suite, const std::string& impl,
+                       long n, long e, const std::function<void()>& f) {
+    return measureTimed(suite, impl, n, e, [&f]() {
+      using namespace std::chrono;  // NOLINT
+      auto c = steady_clock::now();
+      f();
+      return duration<double, std::milli>(steady_clock::now() - c).count();
+    });
+  }
+
+  // same as measure, but f() returns its own elapsed milliseconds (so setup
+  // and cleanup can be left out of the timed region). Hardware counters
+  // cover PerfRegion scopes of f(), or whole f() if it has none.
+  BenchResult& measureTimed(const std::string& suite, const std::string& impl,
+                            long n, long e, const std::function<double()>& f) {
+    BenchResult r;
+    r.suite = suite;
+    r.impl = impl;
+    r.n = n;
+    r.e = e;
+    for (int i = 0; i < opts.warmup; i++) f();
+    auto& perf = PerfCounters::instance();
+    PerfSample counts;
+    for (int i = 0; i < opts.reps; i++) {
+      perf.clearRegions();
+      PerfSample begin = opts.perf ? perf.read() : PerfSample{};
+      r.samples_ms.push_back(f());
+      if (!opts.perf) continue;
+      counts += (perf.region_count > 0) ? perf.regions : perf.read() - begin;
+    }
+    if (opts.perf) addPerf(r, counts);
+    std::cerr << suite << " " << impl << " n=" << n << " e=" << e
+              << " median=" << r.median() << "ms" << std::endl;
+    if (r.median() > opts.budget_ms) {
+      std::cerr << "over budget: skipping larger " << suite << " " << impl
+                << std::endl;
+      over_budget.emplace_back(suite, impl);
+    }
+    results.push_back(std::move(r));
+    return results.back();
+  }
+
+  // mean counts per rep, per unit of n, and instructions per cycle
+  void addPerf(BenchResult& r, const PerfSample& counts) const {
+    const auto& perf = PerfCounters::instance();
+    double units = static_cast<double>(opts.reps) * std::max(1L, r.n);
+    for (int i = 0; i < PERF_EVENTS; i++)
+      if (perf.has(i))
+        r.extras.emplace_back(std::string{perfEventName(i)} + "_per_op",
+                              counts.value[i] / units);
+    if (perf.has(PERF_CYCLES) && perf.has(PERF_INSTRUCTIONS) &&
+        counts.value[PERF_CYCLES] > 0)
+      r.extras.emplace_back("ipc", counts.value[PERF_INSTRUCTIONS] /
+                                       counts.value[PERF_CYCLES]);
+  }
+
+  void write(std::ostream& os) const {
+    if (opts.format == "csv")
+      writeCSV(os);
+    else
+      writeJSON(os);
+  }
+
+  // writes to opts.out (or stdout)
+  bool write() const {
+    if (opts.out.empty()) {
+      write(std::cout);
+      return true;
+    }
+    std::ofstream fout(opts.out);
+    if (!fout) return false;
+    write(fout);
+    return static_cast<bool>(fout);
+  }
+
+  void writeJSON(std::ostream& os) const {
+    os << "[";
+    for (std::size_t i = 0; i < results.size(); i++) {
+      const auto& r = results[i];
+      if (i > 0) os << ",";
+      os << "\n{\"suite\":\"" << r.suite << "\",\"impl\":\"" << r.impl
+         << "\",\"n\":" << r.n << ",\"e\":" << r.e
+         << ",\"reps\":" << r.samples_ms.size()
+         << ",\"median_ms\":" << r.median() << ",\"min_ms\":" << r.min()
+         << ",\"max_ms\":" << r.max() << ",\"mean_ms\":" << r.mean()
+         << ",\"stddev_ms\":" << r.stddev();
+      for (const auto& [key, value] : r.extras)
+        os << ",\"" << key << "\":" << value;
+      os << ",\"samples_ms\":[";
+      for (std::size_t j = 0; j < r.samples_ms.size(); j++)
+        os << (j > 0 ? "," : "") << r.samples_ms[j];
+      os << "]}";
+    }
+    os << "\n]" << std::endl;
+  }
+
+  void writeCSV(std::ostream& os) const {
+    // union of extra columns, in order of appearance
+    std::vector<std::string> keys;
+    for (const auto& r : results)
+      for (const auto& kv : r.extras)
+        if (std::find(keys.begin(), keys.end(), kv.first) == keys.end())
+          keys.push_back(kv.first);
+    os << "suite,impl,n,e,reps,median_ms,min_ms,max_ms,mean_ms,stddev_ms";
+    for (const auto& key : keys) os << "," << key;
+    os << std::endl;
+    for (const auto& r : results) {
+      os << r.suite << "," << r.impl << "," << r.n << "," << r.e << ","
+         << r.samples_ms.size() << "," << r.median() << "," << r.min() << ","
+         << r.max() << "," << r.mean() << "," << r.stddev();
+      for (const auto& key : keys) {
+        os << ",";
+        for (const auto& kv : r.extras)
+          if (kv.first == key) os << kv.second;
+      }
+      os << std::endl;
+    }
+  }
+};
+
+}  // namespace bench
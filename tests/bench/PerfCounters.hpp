@@ -0,0 +1,216 @@
+#pragma once
+
+// C++
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+//
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// ==============================================
+// PerfCounters: hardware counters (Linux perf)
+// ==============================================
+// Counters of calling process (and threads it creates), on user space only,
+// opened once and left running: a region is the difference of two reads.
+// Each event is opened separately, so unsupported events are just skipped,
+// and values are scaled when the kernel multiplexes counters.
+// Without permission (e.g., containers with perf_event_paranoid > 2 or
+// seccomp), no event opens and benchmarks report wall-clock only.
+
+namespace bench {
+
+enum PerfEvent {
+  PERF_CYCLES,
+  PERF_INSTRUCTIONS,
+  PERF_L1D_MISSES,
+  PERF_LLC_MISSES,
+  PERF_BRANCH_MISSES,
+  PERF_DTLB_MISSES,
+  PERF_EVENTS
+};
+
+inline const char* perfEventName(int event) {
+  static const char* names[PERF_EVENTS] = {
+      "cycles",      "instructions",  "l1d_misses",
+      "llc_misses",  "branch_misses", "dtlb_misses"};
+  return names[event];
+}
+
+struct PerfSample {
+  std::array<double, PERF_EVENTS> value{};
+
+  PerfSample operator-(const PerfSample& other) const {
+    PerfSample r;
+    for (int i = 0; i < PERF_EVENTS; i++)
+      r.value[i] = value[i] - other.value[i];
+    return r;
+  }
+
+  PerfSample& operator+=(const PerfSample& other) {
+    for (int i = 0; i < PERF_EVENTS; i++) value[i] += other.value[i];
+    return *this;
+  }
+};
+
+class PerfCounters {
+ public:
+  // single set of counters per process
+  static PerfCounters& instance() {
+    static PerfCounters counters;
+    return counters;
+  }
+
+  ~PerfCounters() { close(); }
+
+  // opens available events. Returns false (with reason on std::cerr) when
+  // none is available.
+  bool open() {
+    if (available()) return true;
+#ifdef __linux__
+    int error = 0;
+    for (int i = 0; i < PERF_EVENTS; i++) {
+      fd[i] = openEvent(i);
+      if (fd[i] < 0) error = errno;
+    }
+    if (available()) return true;
+    std::cerr << "perf events not available (" << std::strerror(error)
+              << "): wall-clock only" << std::endl;
+#else
+    std::cerr << "perf events only supported on Linux: wall-clock only"
+              << std::endl;
+#endif
+    return false;
+  }
+
+  void close() {
+#ifdef __linux__
+    for (auto& f : fd) {
+      if (f >= 0) ::close(f);
+      f = -1;
+    }
+#endif
+  }
+
+  bool available() const { return count() > 0; }
+
+  bool has(int event) const { return fd[event] >= 0; }
+
+  int count() const {
+    int n = 0;
+    for (int f : fd) n += (f >= 0);
+    return n;
+  }
+
+  // current values (zero for unavailable events)
+  PerfSample read() const {
+    PerfSample s;
+#ifdef __linux__
+    for (int i = 0; i < PERF_EVENTS; i++) {
+      if (fd[i] < 0) continue;
+      // value, time enabled, time running
+      std::uint64_t buf[3] = {0, 0, 0};
+      if (::read(fd[i], buf, sizeof(buf)) != sizeof(buf)) continue;
+      double v = static_cast<double>(buf[0]);
+      if (buf[2] > 0 && buf[2] < buf[1])
+        v *= static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+      s.value[i] = v;
+    }
+#endif
+    return s;
+  }
+
+  // counts of PerfRegion scopes since last clearRegions()
+  PerfSample regions;
+  int region_count{0};
+
+  void clearRegions() {
+    regions = PerfSample{};
+    region_count = 0;
+  }
+
+ private:
+  std::array<int, PERF_EVENTS> fd{-1, -1, -1, -1, -1, -1};
+
+  PerfCounters() = default;
+
+#ifdef __linux__
+  static int openEvent(int event) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    auto cache = [](int id, int op, int result) {
+      return static_cast<std::uint64_t>(id | (op << 8) | (result << 16));
+    };
+    switch (event) {
+      case PERF_CYCLES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+      case PERF_INSTRUCTIONS:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+      case PERF_L1D_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config =
+            cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS);
+        break;
+      case PERF_LLC_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+      case PERF_BRANCH_MISSES:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+      case PERF_DTLB_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config =
+            cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                  PERF_COUNT_HW_CACHE_RESULT_MISS);
+        break;
+      default:
+        return -1;
+    }
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.inherit = 1;
+    // this process, any cpu
+    long f = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    return static_cast<int>(f);
+  }
+#endif
+};
+
+// scope of a measured region (e.g., timed part of an experiment). When an
+// experiment has regions, BenchReport reports their counts instead of the
+// counts of whole experiment.
+class PerfRegion {
+ public:
+  PerfRegion() {
+    auto& perf = PerfCounters::instance();
+    if (perf.available()) start = perf.read();
+  }
+
+  ~PerfRegion() {
+    auto& perf = PerfCounters::instance();
+    if (!perf.available()) return;
+    perf.regions += perf.read() - start;
+    perf.region_count++;
+  }
+
+ private:
+  PerfSample start;
+};
+
+}  // namespace bench
@@ -0,0 +1,613 @@
+#pragma once
+
+// C++
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+//
+#include <cycles/detail/rc/DynowForestRC.hpp>
+#include <cycles/detail/trace/DynowForestTrace.hpp>
+#include <cycles/relation_ptr.hpp>
+//
+#include "BenchReport.hpp"
+//
+// allocation counting mode: replaces global operator new/delete
+#ifdef BENCH_COUNT_ALLOCS
+#include "AllocTracker.hpp"
+#endif
+//
+// hsutter gcpp is an optional git submodule (tests/thirdparty)
+#if __has_include(<hsutter-gcpp/deferred_allocator.h>)
+#include <hsutter-gcpp/deferred_allocator.h>
+#define MACRO_BENCH_GCPP 1
+#endif
+
+// ====================================================
+// Workloads: lists, trees, graphs and scalar objects
+// ====================================================
+// Shared by macro_bench (time and allocations) and memory_bench (footprint).
+// Each workload builds a structure and tears it down completely (including
+// collection for deferred strategies), for:
+// - unique_ptr and shared_ptr (lists and trees, since graphs have cycles)
+// - arena (nodes owned by a vector, edges are raw pointers)
+// - relation_ptr, with each forest (and adaptive collection on V1)
+// - gcpp deferred_ptr (when submodule is available)
+// Strategies of each suite are listed by its impls(run) function.
+
+using namespace cycles;  // NOLINT
+
+// ========= allocation counting (BENCH_COUNT_ALLOCS) =========
+
+// Workloads mark boundaries of their phases. Lists and trees create nodes
+// already owned by their parents, so their make phase includes the link.
+namespace phase {
+
+enum { BEGIN, MADE, LINKED, END, COUNT };
+
+#ifdef BENCH_COUNT_ALLOCS
+// fixed storage: marking a phase does not allocate
+inline std::array<bench::AllocTracker::Snapshot, COUNT> marks;
+inline void mark(int p) { marks[p] = bench::AllocTracker::snapshot(); }
+#else
+inline void mark(int) {}
+#endif
+
+// nodes were created together with their relations
+inline void built() {
+  mark(MADE);
+  mark(LINKED);
+}
+
+// per-phase counters of last run, as extra columns of result
+inline void report(bench::BenchResult& r) {
+#ifdef BENCH_COUNT_ALLOCS
+  auto per = [](long v, long n) { return n > 0 ? double(v) / n : 0.0; };
+  const auto& m = marks;
+  r.extras.emplace_back("make_allocs",
+                        per(m[MADE].allocs - m[BEGIN].allocs, r.n));
+  r.extras.emplace_back("make_bytes",
+                        per(m[MADE].allocated - m[BEGIN].allocated, r.n));
+  r.extras.emplace_back("link_allocs",
+                        per(m[LINKED].allocs - m[MADE].allocs, r.e));
+  r.extras.emplace_back("link_bytes",
+                        per(m[LINKED].allocated - m[MADE].allocated, r.e));
+  r.extras.emplace_back("destroy_frees",
+                        per(m[END].frees - m[LINKED].frees, r.n));
+  r.extras.emplace_back("destroy_bytes",
+                        per(m[END].freed - m[LINKED].freed, r.n));
+  // should be zero: everything built by run was released (one-time static
+  // allocations, such as type descriptors, only appear without warmup)
+  r.extras.emplace_back("leaked_bytes",
+                        (m[END].allocated - m[BEGIN].allocated) -
+                            (m[END].freed - m[BEGIN].freed));
+#endif
+}
+
+// forest metadata of last built V1 pool, from relation_pool::memory_report()
+// (only collected when 'inspect_forest' is set, see memory_bench)
+struct ForestBytes {
+  long objects{0};
+  long nodes{0};
+  long trees{0};
+  long links{0};
+};
+
+inline bool inspect_forest{false};
+inline ForestBytes forest_bytes;
+
+template <class DOF>
+void inspect(relation_pool<DOF>& pool) {
+  if constexpr (std::is_same_v<DOF, DynowForestV1>) {
+    if (!inspect_forest) return;
+    auto r = pool.memory_report();
+    forest_bytes = {r.object_bytes, r.node_bytes, r.tree_bytes, r.link_bytes};
+  }
+}
+
+}  // namespace phase
+
+// used for every relation_ptr experiment
+template <class DOF>
+void setupPool(relation_pool<DOF>& pool, bool adaptive) {
+  if constexpr (std::is_same_v<DOF, DynowForestV1>) pool.setAdaptive(adaptive);
+}
+
+template <class DOF>
+void finishPool(relation_pool<DOF>& pool) {
+  // deferred strategies only free memory on collect
+  pool.getContext()->collect();
+}
+
+// generate experiment to replicate on all graph types (see long_bench_graph)
+inline std::vector<std::vector<int>> gen_experiment(int v, int e, int seed) {
+  srand(seed);
+  std::vector<std::vector<int>> v_index(v);
+  for (int c = 0; c < e; c++) {
+    int i = ::rand() % v;
+    int j = ::rand() % v;
+    v_index[i].push_back(j);
+  }
+  // remove edge duplicates
+  for (int i = 0; i < v; i++) {
+    std::sort(v_index[i].begin(), v_index[i].end());
+    auto last = std::unique(v_index[i].begin(), v_index[i].end());
+    v_index[i].erase(last, v_index[i].end());
+  }
+  return v_index;
+}
+
+inline long count_edges(const std::vector<std::vector<int>>& v_index) {
+  long e = 0;
+  for (const auto& edges : v_index) e += edges.size();
+  return e;
+}
+
+// ================= lists =================
+
+namespace macro_list {
+
+struct UNode {
+  int v;
+  std::unique_ptr<UNode> next;
+  // iterative destruction (avoids stack overflow on long lists)
+  ~UNode() {
+    for (auto current = std::move(next); current;
+         current = std::move(current->next)) {
+    }
+  }
+};
+
+struct SNode {
+  int v;
+  std::shared_ptr<SNode> next;
+  ~SNode() {
+    for (auto current = std::move(next); current;
+         current = std::move(current->next)) {
+    }
+  }
+};
+
+struct ANode {
+  int v;
+  ANode* next{nullptr};
+};
+
+template <class DOF>
+struct CNode {
+  int v;
+  relation_ptr<CNode<DOF>, DOF> next;
+};
+
+inline void run_uptr(long n) {
+  phase::mark(phase::BEGIN);
+  {
+    std::unique_ptr<UNode> entry{new UNode{0}};  // NOLINT
+    UNode* node = entry.get();
+    for (long i = 1; i < n; i++) {
+      node->next.reset(new UNode{static_cast<int>(i)});  // NOLINT
+      node = node->next.get();
+    }
+    phase::built();
+  }
+  phase::mark(phase::END);
+}
+
+inline void run_sptr(long n) {
+  phase::mark(phase::BEGIN);
+  {
+    std::shared_ptr<SNode> entry{new SNode{0}};  // NOLINT
+    SNode* node = entry.get();
+    for (long i = 1; i < n; i++) {
+      node->next.reset(new SNode{static_cast<int>(i)});  // NOLINT
+      node = node->next.get();
+    }
+    phase::built();
+  }
+  phase::mark(phase::END);
+}
+
+inline void run_arena(long n) {
+  phase::mark(phase::BEGIN);
+  {
+    std::vector<std::unique_ptr<ANode>> arena;
+    arena.push_back(std::make_unique<ANode>(ANode{0}));
+    for (long i = 1; i < n; i++) {
+      arena.push_back(std::make_unique<ANode>(ANode{static_cast<int>(i)}));
+      arena[i - 1]->next = arena[i].get();
+    }
+    phase::built();
+  }
+  phase::mark(phase::END);
+}
+
+template <class DOF>
+void run_rptr(long n, bool adaptive = false) {
+  using Node = CNode<DOF>;
+  phase::mark(phase::BEGIN);
+  {
+    relation_pool<DOF> pool;
+    setupPool(pool, adaptive);
+    {
+      relation_ptr<Node, DOF> entry{new Node{0}, pool};  // NOLINT
+      relation_ptr<Node, DOF>* current = &entry;
+      for (long i = 1; i < n; i++) {
+        auto* node = new Node{static_cast<int>(i)};  // NOLINT
+        (*current)->next = relation_ptr<Node, DOF>{node, *current};
+        current = &((*current)->next);
+      }
+      phase::built();
+      phase::inspect(pool);
+    }
+    finishPool(pool);
+  }
+  phase::mark(phase::END);
+}
+
+#ifdef MACRO_BENCH_GCPP
+struct GNode {
+  int v;
+  gcpp::deferred_ptr<GNode> next;
+};
+
+inline void run_gcpp(long n) {
+  phase::mark(phase::BEGIN);
+  {
+    gcpp::deferred_heap heap;
+    auto entry = heap.make<GNode>();
+    GNode* node = entry.get();
+    for (long i = 1; i < n; i++) {
+      node->next = heap.make<GNode>();
+      node = node->next.get();
+      node->v = static_cast<int>(i);
+    }
+    phase::built();
+    entry = nullptr;
+    heap.collect();
+  }
+  phase::mark(phase::END);
+}
+#endif
+
+// run(impl, f) for each strategy, where f(n) runs a list of n nodes
+template <class Visit>
+void impls(Visit&& run) {
+  run("unique_ptr", run_uptr);
+  run("shared_ptr", run_sptr);
+  run("arena", run_arena);
+  run("relation_ptr", [](long n) { run_rptr<DynowForestV1>(n); });
+  run("relation_ptr_adaptive",
+      [](long n) { run_rptr<DynowForestV1>(n, true); });
+  run("relation_ptr_trace", [](long n) { run_rptr<DynowForestTrace>(n); });
+  run("relation_ptr_rc", [](long n) { run_rptr<DynowForestRC>(n); });
+#ifdef MACRO_BENCH_GCPP
+  run("gcpp", run_gcpp);
+#endif
+}
+
+}  // namespace macro_list
+
+// ================= trees =================
+
+namespace macro_tree {
+
+// complete binary trees with h levels (2^h - 1 nodes)
+
+struct UNode {
+  int v;
+  std::vector<std::unique_ptr<UNode>> children;
+};
+
+struct SNode {
+  int v;
+  std::vector<std::shared_ptr<SNode>> children;
+};
+
+struct ANode {
+  int v;
+  std::vector<ANode*> children;
+};
+
+template <class DOF>
+struct CNode {
+  int v;
+  std::vector<relation_ptr<CNode<DOF>, DOF>> children;
+};
+
+template <class Node, class Make>
+void grow(Node& node, int h, int& n, const Make& make) {
+  if (h <= 1) return;
+  node.children.push_back(make(n++));
+  node.children.push_back(make(n++));
+  for (auto& child : node.children) grow(*child, h - 1, n, make);
+}
+
+inline void run_uptr(int h) {
+  phase::mark(phase::BEGIN);
+  {
+    int n = 0;
+    auto root = std::make_unique<UNode>(UNode{n++});
+    grow(*root, h, n,
+         [](int v) { return std::make_unique<UNode>(UNode{v}); });
+    phase::built();
+  }
+  phase::mark(phase::END);
+}
+
+inline void run_sptr(int h) {
+  phase::mark(phase::BEGIN);
+  {
+    int n = 0;
+    auto root = std::make_shared<SNode>(SNode{n++});
+    grow(*root, h, n,
+         [](int v) { return std::make_shared<SNode>(SNode{v}); });
+    phase::built();
+  }
+  phase::mark(phase::END);
+}
+
+inline void run_arena(int h) {
+  phase::mark(phase::BEGIN);
+  {
+    std::vector<std::unique_ptr<ANode>> arena;
+    int n = 0;
+    arena.push_back(std::make_unique<ANode>(ANode{n++}));
+    grow(*arena[0], h, n, [&arena](int v) {
+      arena.push_back(std::make_unique<ANode>(ANode{v}));
+      return arena.back().get();
+    });
+    phase::built();
+  }
+  phase::mark(phase::END);
+}
+
+template <class DOF>
+void grow_rptr(relation_ptr<CNode<DOF>, DOF>& owner, int h, int& n) {
+  using Node = CNode<DOF>;
+  if (h <= 1) return;
+  owner->children.reserve(2);
+  for (int k = 0; k < 2; k++) {
+    auto* node = new Node{n++};  // NOLINT
+    owner->children.push_back(relation_ptr<Node, DOF>{node, owner});
+  }
+  for (auto& child : owner->children) grow_rptr(child, h - 1, n);
+}
+
+template <class DOF>
+void run_rptr(int h, bool adaptive = false) {
+  using Node = CNode<DOF>;
+  phase::mark(phase::BEGIN);
+  {
+    relation_pool<DOF> pool;
+    setupPool(pool, adaptive);
+    {
+      int n = 0;
+      relation_ptr<Node, DOF> root{new Node{n++}, pool};  // NOLINT
+      grow_rptr(root, h, n);
+      phase::built();
+      phase::inspect(pool);
+    }
+    finishPool(pool);
+  }
+  phase::mark(phase::END);
+}
+
+#ifdef MACRO_BENCH_GCPP
+struct GNode {
+  int v;
+  gcpp::deferred_vector<gcpp::deferred_ptr<GNode>> children;
+  GNode(int _v, gcpp::deferred_heap& heap) : v{_v}, children{heap} {}
+};
+
+inline void run_gcpp(int h) {
+  phase::mark(phase::BEGIN);
+  {
+    gcpp::deferred_heap heap;
+    int n = 0;
+    auto root = heap.make<GNode>(n++, heap);
+    grow(*root, h, n, [&heap](int v) { return heap.make<GNode>(v, heap); });
+    phase::built();
+    root = nullptr;
+    heap.collect();
+  }
+  phase::mark(phase::END);
+}
+#endif
+
+// run(impl, f) for each strategy, where f(h) runs a tree of height h
+template <class Visit>
+void impls(Visit&& run) {
+  run("unique_ptr", run_uptr);
+  run("shared_ptr", run_sptr);
+  run("arena", run_arena);
+  run("relation_ptr", [](int h) { run_rptr<DynowForestV1>(h); });
+  run("relation_ptr_adaptive", [](int h) { run_rptr<DynowForestV1>(h, true); });
+  run("relation_ptr_trace", [](int h) { run_rptr<DynowForestTrace>(h); });
+  run("relation_ptr_rc", [](int h) { run_rptr<DynowForestRC>(h); });
+#ifdef MACRO_BENCH_GCPP
+  run("gcpp", run_gcpp);
+#endif
+}
+
+}  // namespace macro_tree
+
+// ================= graphs =================
+
+namespace macro_graph {
+
+// random digraph (with cycles), only first vertex is kept as root
+
+struct ANode {
+  int v;
+  std::vector<ANode*> edges;
+};
+
+template <class DOF>
+struct CNode {
+  int v;
+  std::vector<relation_ptr<CNode<DOF>, DOF>> edges;
+};
+
+inline void run_arena(const std::vector<std::vector<int>>& v_index) {
+  phase::mark(phase::BEGIN);
+  {
+    std::vector<std::unique_ptr<ANode>> arena;
+    for (int i = 0; i < static_cast<int>(v_index.size()); i++)
+      arena.push_back(std::make_unique<ANode>(ANode{i}));
+    phase::mark(phase::MADE);
+    for (int i = 0; i < static_cast<int>(v_index.size()); i++)
+      for (int j : v_index[i]) arena[i]->edges.push_back(arena[j].get());
+    phase::mark(phase::LINKED);
+  }
+  phase::mark(phase::END);
+}
+
+template <class DOF>
+void run_rptr(const std::vector<std::vector<int>>& v_index,
+              bool adaptive = false) {
+  using Node = CNode<DOF>;
+  phase::mark(phase::BEGIN);
+  {
+    relation_pool<DOF> pool;
+    setupPool(pool, adaptive);
+    {
+      std::vector<relation_ptr<Node, DOF>> vertex;
+      for (int i = 0; i < static_cast<int>(v_index.size()); i++)
+        vertex.push_back(
+            relation_ptr<Node, DOF>{new Node{i}, pool});  // NOLINT
+      phase::mark(phase::MADE);
+      for (int i = 0; i < static_cast<int>(v_index.size()); i++)
+        for (int j : v_index[i])
+          vertex[i]->edges.push_back(vertex[j].get_owned(vertex[i]));
+      phase::mark(phase::LINKED);
+      phase::inspect(pool);
+      // only root remains
+      auto root = std::move(vertex[0]);
+      vertex.clear();
+    }
+    finishPool(pool);
+  }
+  phase::mark(phase::END);
+}
+
+#ifdef MACRO_BENCH_GCPP
+struct GNode {
+  int v;
+  gcpp::deferred_vector<gcpp::deferred_ptr<GNode>> edges;
+  GNode(int _v, gcpp::deferred_heap& heap) : v{_v}, edges{heap} {}
+};
+
+inline void run_gcpp(const std::vector<std::vector<int>>& v_index) {
+  phase::mark(phase::BEGIN);
+  {
+    gcpp::deferred_heap heap;
+    {
+      gcpp::deferred_vector<gcpp::deferred_ptr<GNode>> vertex{heap};
+      for (int i = 0; i < static_cast<int>(v_index.size()); i++)
+        vertex.push_back(heap.make<GNode>(i, heap));
+      phase::mark(phase::MADE);
+      for (int i = 0; i < static_cast<int>(v_index.size()); i++)
+        for (int j : v_index[i]) vertex[i]->edges.push_back(vertex[j]);
+      phase::mark(phase::LINKED);
+    }
+    heap.collect();
+  }
+  phase::mark(phase::END);
+}
+#endif
+
+// run(impl, f) for each strategy, where f(v_index) runs a graph
+template <class Visit>
+void impls(Visit&& run) {
+  using VIndex = std::vector<std::vector<int>>;
+  run("arena", run_arena);
+  run("relation_ptr", [](const VIndex& g) { run_rptr<DynowForestV1>(g); });
+  run("relation_ptr_adaptive",
+      [](const VIndex& g) { run_rptr<DynowForestV1>(g, true); });
+  run("relation_ptr_trace",
+      [](const VIndex& g) { run_rptr<DynowForestTrace>(g); });
+  run("relation_ptr_rc", [](const VIndex& g) { run_rptr<DynowForestRC>(g); });
+#ifdef MACRO_BENCH_GCPP
+  run("gcpp", run_gcpp);
+#endif
+}
+
+}  // namespace macro_graph
+
+// ================= scalars =================
+
+namespace macro_sptr {
+
+// n independent objects of mixed scalar types, held by a vector of type
+// erased pointers (same workload of quick_bench_sptr)
+
+template <class Ptr, class Make>
+void fill(std::vector<Ptr>& data, const Make& make) {
+  for (std::size_t i = 0; i < data.size(); i++) {
+    switch (i % 6) {
+      case 0:
+        data[i] = make(char{});
+        break;
+      case 1:
+        data[i] = make(int16_t{});
+        break;
+      case 2:
+        data[i] = make(int{});
+        break;
+      case 3:
+        data[i] = make(int64_t{});
+        break;
+      case 4:
+        data[i] = make(float{});
+        break;
+      case 5:
+        data[i] = make(double{});
+        break;
+    }
+  }
+}
+
+inline void run_sptr(long n) {
+  phase::mark(phase::BEGIN);
+  {
+    std::vector<std::shared_ptr<void>> data(n);
+    fill(data, [](auto v) { return std::make_shared<decltype(v)>(v); });
+    phase::built();
+  }
+  phase::mark(phase::END);
+}
+
+template <class DOF>
+void run_rptr(long n, bool adaptive = false) {
+  phase::mark(phase::BEGIN);
+  {
+    relation_pool<DOF> pool;
+    setupPool(pool, adaptive);
+    {
+      std::vector<relation_ptr<void, DOF>> data(n);
+      fill(data,
+           [&pool](auto v) { return pool.template make<decltype(v)>(v); });
+      phase::built();
+      phase::inspect(pool);
+    }
+    finishPool(pool);
+  }
+  phase::mark(phase::END);
+}
+
+// run(impl, f) for each strategy, where f(n) runs n objects
+template <class Visit>
+void impls(Visit&& run) {
+  run("shared_ptr", run_sptr);
+  run("relation_ptr", [](long n) { run_rptr<DynowForestV1>(n); });
+  run("relation_ptr_adaptive",
+      [](long n) { run_rptr<DynowForestV1>(n, true); });
+  run("relation_ptr_trace", [](long n) { run_rptr<DynowForestTrace>(n); });
+  run("relation_ptr_rc", [](long n) { run_rptr<DynowForestRC>(n); });
+}
+
+}  // namespace macro_sptr
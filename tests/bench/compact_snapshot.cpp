@@ -0,0 +1,72 @@
+// C++
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+//
+#include <cycles/detail/Snapshot.hpp>
+
+// ====================================================
+// compaction of snapshot checkpoints
+// ====================================================
+// Folds delta files of relation_pool::checkpoint_delta (in order of
+// arguments) into base snapshot of relation_pool::save_snapshot, writing a
+// new base snapshot (see compactSnapshot), so older deltas can be dropped.
+// Objects no longer reachable from root are left out.
+//
+// Example:
+//   ./compact_snapshot base.bin delta1.bin delta2.bin --out base2.bin
+
+using namespace cycles::detail;  // NOLINT
+
+int main(int argc, char** argv) {
+  std::string out_path;
+  std::vector<std::string> inputs;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--out" && i + 1 < argc)
+      out_path = argv[++i];
+    else
+      inputs.push_back(arg);
+  }
+  if (inputs.empty() || out_path.empty()) {
+    std::cerr << "usage: " << argv[0] << " BASE [DELTA...] --out SNAPSHOT"
+              << std::endl;
+    return 1;
+  }
+  SnapshotImage base;
+  if (!base.open(inputs[0])) {
+    std::cerr << "invalid snapshot: " << inputs[0] << std::endl;
+    return 1;
+  }
+  std::vector<SnapshotDelta> deltas(inputs.size() - 1);
+  for (std::size_t k = 0; k < deltas.size(); k++) {
+    std::ifstream in(inputs[k + 1], std::ios::binary);
+    if (!in || !deltas[k].read(in)) {
+      std::cerr << "invalid delta: " << inputs[k + 1] << std::endl;
+      return 1;
+    }
+  }
+  using namespace std::chrono;  // NOLINT
+  auto c = steady_clock::now();
+  if (!compactSnapshot(base, deltas, out_path)) {
+    std::cerr << "cannot compact into " << out_path
+              << " (payload mismatch, dangling relation or write error)"
+              << std::endl;
+    return 1;
+  }
+  double ms = duration<double, std::milli>(steady_clock::now() - c).count();
+  SnapshotImage result;
+  if (!result.open(out_path)) {
+    std::cerr << "cannot read back " << out_path << std::endl;
+    return 1;
+  }
+  std::cout << "base: " << base.header().nodes << " objects, "
+            << base.header().links << " relations" << std::endl
+            << "deltas: " << deltas.size() << std::endl
+            << "result: " << result.header().nodes << " objects, "
+            << result.header().links << " relations (" << ms << " ms)"
+            << std::endl;
+  return 0;
+}
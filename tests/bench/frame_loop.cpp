@@ -0,0 +1,263 @@
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+//
+#include <cycles/detail/PauseHistogram.hpp>
+#include <cycles/detail/rc/DynowForestRC.hpp>
+#include <cycles/detail/trace/DynowForestTrace.hpp>
+#include <cycles/relation_ptr.hpp>
+//
+#include "BenchReport.hpp"
+
+// ====================================================
+// frame loop: per-tick latency of a churning graph
+// ====================================================
+// A graph of 'vertices' unowned nodes is mutated at a fixed tick rate: each
+// tick makes 'ops' random edge insertions, edge removals and vertex
+// replacements (which leave garbage cycles), then sleeps until next tick.
+// Busy time of each tick (including any collection) goes to a histogram, on
+// three collection modes:
+// - on: auto collect (a removal may pause)
+// - off: no collection during the loop (garbage piles up)
+// - budgeted: auto collect off, and collect() at the end of a tick when the
+//   expected collection time (moving average) fits on what is left of tick
+//   budget, or after 'max_defer' ticks without collection
+// Reported: tick percentiles and jitter (p99 - p50) in microseconds, missed
+// deadlines, loop collections, and for DynowForestV1 the pause histograms
+// of pool (pause_stats) and live nodes at the end of the loop.
+//
+// Examples:
+//   ./frame_loop --quick --format csv
+//   ./frame_loop --hz 120 --ticks 1200 --impl DynowForestV1_budgeted
+
+using namespace cycles;  // NOLINT
+
+struct FrameConfig {
+  int hz{500};
+  int ticks{1000};
+  int vertices{1000};
+  int ops{50};           // mutations per tick
+  double budget{0.5};    // fraction of tick period for work and collection
+  int max_defer{16};     // budgeted: forced collection after these ticks
+};
+
+enum class CollectMode { ON, OFF, BUDGETED };
+
+const char* modeName(CollectMode mode) {
+  switch (mode) {
+    case CollectMode::ON:
+      return "on";
+    case CollectMode::OFF:
+      return "off";
+    default:
+      return "budgeted";
+  }
+}
+
+template <class DOF>
+struct Node {
+  int v;
+  std::vector<relation_ptr<Node, DOF>> edges;
+  explicit Node(int _v) : v{_v} {}
+};
+
+struct FrameResult {
+  PauseHistogram ticks;
+  long missed{0};       // ticks longer than period
+  long collections{0};  // collect() invoked by loop (budgeted)
+  PauseStats pauses;    // DynowForestV1 only
+  long live_nodes{0};   // DynowForestV1 only (end of loop)
+
+  void merge(const FrameResult& other) {
+    ticks.merge(other.ticks);
+    missed += other.missed;
+    collections += other.collections;
+    pauses.collect.merge(other.pauses.collect);
+    pauses.remove.merge(other.pauses.remove);
+    live_nodes = std::max(live_nodes, other.live_nodes);
+  }
+};
+
+// runs the loop, returning busy milliseconds (sum of ticks)
+template <class DOF>
+double run_loop(const FrameConfig& cfg, CollectMode mode, int seed,
+                FrameResult& out) {
+  using namespace std::chrono;  // NOLINT
+  using Ptr = relation_ptr<Node<DOF>, DOF>;
+  relation_pool<DOF> pool;
+  if (mode != CollectMode::ON) pool.setAutoCollect(false);
+  srand(seed);
+  std::vector<Ptr> vertex;
+  int next_id = 0;
+  for (int i = 0; i < cfg.vertices; i++)
+    vertex.push_back(pool.template make<Node<DOF>>(next_id++));
+  auto mutate = [&]() {
+    int i = ::rand() % cfg.vertices;
+    int j = ::rand() % cfg.vertices;
+    int action = ::rand() % 10;
+    if (action < 5) {
+      vertex[i]->edges.push_back(vertex[j].get_owned(vertex[i]));
+    } else if (action < 9) {
+      auto& edges = vertex[i]->edges;
+      if (!edges.empty()) {
+        std::swap(edges[::rand() % edges.size()], edges.back());
+        edges.pop_back();
+      }
+    } else {
+      vertex[i] = pool.template make<Node<DOF>>(next_id++);
+    }
+  };
+  // initial graph: two edges per vertex (without action of third kind)
+  for (int k = 0; k < 2 * cfg.vertices; k++) {
+    int i = ::rand() % cfg.vertices;
+    int j = ::rand() % cfg.vertices;
+    vertex[i]->edges.push_back(vertex[j].get_owned(vertex[i]));
+  }
+  if constexpr (std::is_same_v<DOF, DynowForestV1>) pool.reset_pause_stats();
+
+  const nanoseconds period{1'000'000'000L / cfg.hz};
+  const double budget_ns = cfg.budget * period.count();
+  double estimate_ns = 0;
+  int idle_ticks = 0;
+  double busy_ms = 0;
+  {
+    bench::PerfRegion region;  // sleeping is not counted (user space only)
+    auto deadline = steady_clock::now();
+    for (int t = 0; t < cfg.ticks; t++) {
+      auto begin = steady_clock::now();
+      for (int k = 0; k < cfg.ops; k++) mutate();
+      if (mode == CollectMode::BUDGETED) {
+        double used_ns =
+            duration<double, std::nano>(steady_clock::now() - begin).count();
+        idle_ticks++;
+        if ((used_ns + estimate_ns <= budget_ns) ||
+            (idle_ticks >= cfg.max_defer)) {
+          auto c = steady_clock::now();
+          pool.getContext()->collect();
+          double ns =
+              duration<double, std::nano>(steady_clock::now() - c).count();
+          estimate_ns = (out.collections == 0)
+                            ? ns
+                            : estimate_ns + 0.25 * (ns - estimate_ns);
+          out.collections++;
+          idle_ticks = 0;
+        }
+      }
+      auto end = steady_clock::now();
+      out.ticks.record(duration_cast<nanoseconds>(end - begin).count());
+      busy_ms += duration<double, std::milli>(end - begin).count();
+      deadline += period;
+      if (end > deadline) {
+        out.missed++;
+        deadline = end;
+      } else {
+        std::this_thread::sleep_until(deadline);
+      }
+    }
+  }
+  if constexpr (std::is_same_v<DOF, DynowForestV1>) {
+    out.pauses = pool.pause_stats();
+    out.live_nodes = pool.stats().nodes;
+  }
+  vertex.clear();
+  pool.getContext()->collect();
+  return busy_ms;
+}
+
+template <class DOF>
+void run_forest(bench::BenchReport& report, const FrameConfig& cfg,
+                const std::string& impl) {
+  for (auto mode :
+       {CollectMode::ON, CollectMode::OFF, CollectMode::BUDGETED}) {
+    std::string name = impl + "_" + modeName(mode);
+    if (!report.selected("frame", name)) continue;
+    FrameResult total;
+    int runs = 0;
+    auto& r = report.measureTimed("frame", name, cfg.ticks, 0, [&]() {
+      FrameResult fr;
+      double busy_ms = run_loop<DOF>(cfg, mode, 999999, fr);
+      // warmup runs are not reported
+      if (runs++ >= report.opts.warmup) total.merge(fr);
+      return busy_ms;
+    });
+    auto us = [](long ns) { return ns / 1000.0; };
+    r.extras.emplace_back("hz", cfg.hz);
+    r.extras.emplace_back("vertices", cfg.vertices);
+    r.extras.emplace_back("ops_per_tick", cfg.ops);
+    r.extras.emplace_back("tick_p50_us", us(total.ticks.p50Ns()));
+    r.extras.emplace_back("tick_p99_us", us(total.ticks.p99Ns()));
+    r.extras.emplace_back("tick_p999_us", us(total.ticks.p999Ns()));
+    r.extras.emplace_back("tick_max_us", us(total.ticks.maxNs()));
+    r.extras.emplace_back(
+        "jitter_us", us(total.ticks.p99Ns() - total.ticks.p50Ns()));
+    r.extras.emplace_back("missed", total.missed);
+    r.extras.emplace_back("loop_collections", total.collections);
+    if constexpr (!std::is_same_v<DOF, DynowForestV1>) continue;
+    const auto& ps = total.pauses;
+    r.extras.emplace_back("collect_pauses", ps.collect.count());
+    r.extras.emplace_back("collect_p99_us", us(ps.collect.p99Ns()));
+    r.extras.emplace_back("collect_max_us", us(ps.collect.maxNs()));
+    r.extras.emplace_back("remove_pauses", ps.remove.count());
+    r.extras.emplace_back("remove_p99_us", us(ps.remove.p99Ns()));
+    r.extras.emplace_back("remove_max_us", us(ps.remove.maxNs()));
+    r.extras.emplace_back("live_nodes", total.live_nodes);
+  }
+}
+
+int main(int argc, char** argv) {
+  // own arguments: loop configuration
+  FrameConfig cfg;
+  std::vector<char*> args{argv[0]};
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = (i + 1 < argc);
+    if (arg == "--hz" && has_value)
+      cfg.hz = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--ticks" && has_value)
+      cfg.ticks = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--vertices" && has_value)
+      cfg.vertices = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--ops" && has_value)
+      cfg.ops = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--budget" && has_value)
+      cfg.budget = std::atof(argv[++i]);
+    else if (arg == "--max-defer" && has_value)
+      cfg.max_defer = std::max(1, std::atoi(argv[++i]));
+    else
+      args.push_back(argv[i]);
+  }
+  bench::BenchOptions opts;
+  // each run takes ticks/hz seconds: a single run per mode by default
+  opts.reps = 1;
+  opts.warmup = 0;
+  if (!bench::parseOptions(static_cast<int>(args.size()), args.data(),
+                           opts)) {
+    std::cerr << "loop options: [--hz N] [--ticks N] [--vertices N] [--ops N]"
+              << " [--budget FRACTION] [--max-defer N]" << std::endl;
+    return 1;
+  }
+  if (opts.quick) {
+    cfg.ticks = 250;
+    cfg.vertices = 300;
+  }
+  std::cerr << "frame loop: hz=" << cfg.hz << " ticks=" << cfg.ticks
+            << " vertices=" << cfg.vertices << " ops=" << cfg.ops
+            << " budget=" << cfg.budget << std::endl;
+
+  bench::BenchReport report{opts};
+  run_forest<DynowForestV1>(report, cfg, "DynowForestV1");
+  run_forest<DynowForestTrace>(report, cfg, "DynowForestTrace");
+  run_forest<DynowForestRC>(report, cfg, "DynowForestRC");
+
+  if (!report.write()) {
+    std::cerr << "cannot write report: " << opts.out << std::endl;
+    return 1;
+  }
+  return 0;
+}
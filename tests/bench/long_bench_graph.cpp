@@ -1,11 +1,15 @@
 
 // C++
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 //
+#include <cycles/detail/rc/DynowForestRC.hpp>
+#include <cycles/detail/trace/DynowForestTrace.hpp>
 #include <cycles/relation_ptr.hpp>
 //
 #include "../TestGraph.hpp"
@@ -127,9 +131,11 @@ void test_main1(int V, int E, int SEED) {
 namespace cycles_example1 {
 
 std::pair<relation_pool<>, relation_ptr<Node>> init_long_rptr(
-    int v, const std::vector<std::vector<int>>& v_index) {
+    int v, const std::vector<std::vector<int>>& v_index,
+    bool adaptive = false) {
   //
   relation_pool<> pool;
+  pool.setAdaptive(adaptive);
   std::vector<relation_ptr<Node>> vertex;
   for (int i = 0; i < v; i++) {
     std::string stri = std::to_string(i);
@@ -151,16 +157,51 @@ std::pair<relation_pool<>, relation_ptr<Node>> init_long_rptr(
                                                         std::move(vertex[0])};
 }
 
-void test_main_long_rptr(int V, int E, int SEED) {
+int max_tree_height(const relation_pool<>& pool) {
+  int height = 0;
+  for (const auto& st : pool.tree_stats()) height = std::max(height, st.height);
+  return height;
+}
+
+void test_main_long_rptr(int V, int E, int SEED, bool adaptive = false) {
   std::vector<std::vector<int>> v_index = gen_experiment(V, E, SEED, false);
   // DEBUG
   // print_exp(v_index);
   //
-  auto gpair = init_long_rptr(V, v_index);
+  auto gpair = init_long_rptr(V, v_index, adaptive);
+  // tree height, before and after re-balancing (breadth-first spanning trees)
+  std::cout << "optimize: max tree height " << max_tree_height(gpair.first);
+  int moved = gpair.first.optimize();
+  std::cout << " -> " << max_tree_height(gpair.first)
+            << " (re-parented=" << moved << ")" << std::endl;
+  auto st = gpair.first.stats();
+  std::cout << "stats: nodes=" << st.nodes << " trees=" << st.trees
+            << " weak_links=" << st.weak_links
+            << " reparent_attempts=" << st.reparent_attempts
+            << " reparents=" << st.reparents
+            << " descendent_steps=" << st.descendent_steps
+            << " reclaimed=" << st.reclaimed << " collect_ms=" << st.collect_ms
+            << std::endl;
+  auto mem = gpair.first.memory_report();
+  std::cout << "memory: object_bytes=" << mem.object_bytes
+            << " overhead_bytes=" << mem.overhead_bytes
+            << " (node=" << mem.node_bytes << " tree=" << mem.tree_bytes
+            << " link=" << mem.link_bytes << ")" << std::endl;
+  if (adaptive) {
+    auto ctx = gpair.first.getContext();
+    ctx->collect();
+    std::cout << "adaptive: forest_mode="
+              << ((ctx->getForestMode() == TreeCollectMode::EAGER) ? "EAGER"
+                                                                   : "DEFERRED")
+              << " |trees|=" << gpair.first.tree_stats().size()
+              << " |nodes|=" << ctx->getNodeCount() << std::endl;
+  }
   // std::cout << "root = " << gpair.second->datum << std::endl;
   const auto& gref = *(gpair.second.get());
-  std::set<std::string> seen;
-  gref.traverse([&](const std::string& d) { std::cout << d; }, seen);
+  long reachable = 0;
+  gpair.first.for_each_reachable(gpair.second,
+                                 [&](const Node&) { reachable++; });
+  std::cout << "reachable: " << reachable << std::endl;
   if (gref.edges.size() > 0) {
     Node* f = gref.first();
     foo(*f);
@@ -207,8 +248,9 @@ void test_main_long_rptr(int V, int E, int SEED) {
   auto ptr = init_long_rptr(V, v_index, arena);
   // std::cout << "root = " << gpair.second->datum << std::endl;
   const auto& gref = *(ptr.get());
-  std::set<std::string> seen;
-  gref.traverse([&](const std::string& d) { std::cout << d; }, seen);
+  long reachable = 0;
+  arena.pool.for_each_reachable(ptr, [&](const Node&) { reachable++; });
+  std::cout << "reachable: " << reachable << std::endl;
   if (gref.edges.size() > 0) {
     Node* f = gref.first();
     foo(*f);
@@ -219,6 +261,134 @@ void test_main_long_rptr(int V, int E, int SEED) {
 
 }  // namespace cycles_example2_arena
 
+namespace cycles_example3_trace {
+// same as cycles_example1, but using tracing forest (mark-sweep)
+
+struct Node {
+  std::string datum;
+  std::vector<relation_ptr<Node, DynowForestTrace>> edges;
+
+  explicit Node(const std::string& datum) : datum{datum}, edges{} {}
+
+  Node* first() const { return this->edges.at(0).get(); }
+
+  friend std::ostream& operator<<(std::ostream& os, const Node& me) {
+    os << "Node(\"" << me.datum << "\")";
+    return os;
+  }
+};
+
+void foo(const Node& node) { std::cout << "foo: " << node.datum << std::endl; }
+
+std::pair<relation_pool<DynowForestTrace>,
+          relation_ptr<Node, DynowForestTrace>>
+init_long_rptr(int v, const std::vector<std::vector<int>>& v_index,
+               int mark_threads) {
+  //
+  relation_pool<DynowForestTrace> pool;
+  pool.getContext()->setMarkThreads(mark_threads);
+  std::vector<relation_ptr<Node, DynowForestTrace>> vertex;
+  for (int i = 0; i < v; i++) {
+    std::string stri = std::to_string(i);
+    // NOLINTNEXTLINE
+    auto* node = new Node(stri);
+    vertex.push_back(relation_ptr<Node, DynowForestTrace>{node, pool});
+  }
+  // make mirror experiment with v_index
+  for (int i = 0; i < v; i++) {
+    for (int e = 0; e < v_index[i].size(); e++) {
+      int j = v_index[i][e];
+      vertex[i]->edges.push_back(vertex[j].get_owned(vertex[i]));
+    }
+  }
+  // root is first vertex only... the rest may die automatically. let's see.
+  return std::pair<relation_pool<DynowForestTrace>,
+                   relation_ptr<Node, DynowForestTrace>>{std::move(pool),
+                                                         std::move(vertex[0])};
+}
+
+void test_main_long_rptr(int V, int E, int SEED, int mark_threads) {
+  std::vector<std::vector<int>> v_index = gen_experiment(V, E, SEED, false);
+  //
+  auto gpair = init_long_rptr(V, v_index, mark_threads);
+  const auto& gref = *(gpair.second.get());
+  long reachable = 0;
+  gpair.first.for_each_reachable(gpair.second,
+                                 [&](const Node&) { reachable++; });
+  std::cout << "reachable: " << reachable << std::endl;
+  if (gref.edges.size() > 0) {
+    Node* f = gref.first();
+    foo(*f);
+  } else {
+    std::cout << "WARNING: no edges to invoke foo()" << std::endl;
+  }
+  // explicit collection of unreachable vertices (before pool destruction)
+  gpair.first.getContext()->collect();
+}
+
+}  // namespace cycles_example3_trace
+
+namespace cycles_example4_rc {
+// same as cycles_example1, but using reference counting forest
+
+struct Node {
+  std::string datum;
+  std::vector<relation_ptr<Node, DynowForestRC>> edges;
+
+  explicit Node(const std::string& datum) : datum{datum}, edges{} {}
+
+  Node* first() const { return this->edges.at(0).get(); }
+};
+
+void foo(const Node& node) { std::cout << "foo: " << node.datum << std::endl; }
+
+std::pair<relation_pool<DynowForestRC>, relation_ptr<Node, DynowForestRC>>
+init_long_rptr(int v, const std::vector<std::vector<int>>& v_index,
+               int buffer_threshold) {
+  //
+  relation_pool<DynowForestRC> pool;
+  pool.getContext()->cycle_buffer_threshold = buffer_threshold;
+  std::vector<relation_ptr<Node, DynowForestRC>> vertex;
+  for (int i = 0; i < v; i++) {
+    std::string stri = std::to_string(i);
+    // NOLINTNEXTLINE
+    auto* node = new Node(stri);
+    vertex.push_back(relation_ptr<Node, DynowForestRC>{node, pool});
+  }
+  // make mirror experiment with v_index
+  for (int i = 0; i < v; i++) {
+    for (int e = 0; e < v_index[i].size(); e++) {
+      int j = v_index[i][e];
+      vertex[i]->edges.push_back(vertex[j].get_owned(vertex[i]));
+    }
+  }
+  // root is first vertex only... the rest may die automatically. let's see.
+  return std::pair<relation_pool<DynowForestRC>,
+                   relation_ptr<Node, DynowForestRC>>{std::move(pool),
+                                                      std::move(vertex[0])};
+}
+
+void test_main_long_rptr(int V, int E, int SEED, int buffer_threshold) {
+  std::vector<std::vector<int>> v_index = gen_experiment(V, E, SEED, false);
+  //
+  auto gpair = init_long_rptr(V, v_index, buffer_threshold);
+  const auto& gref = *(gpair.second.get());
+  long reachable = 0;
+  gpair.first.for_each_reachable(gpair.second,
+                                 [&](const Node&) { reachable++; });
+  std::cout << "reachable: " << reachable << std::endl;
+  if (gref.edges.size() > 0) {
+    Node* f = gref.first();
+    foo(*f);
+  } else {
+    std::cout << "WARNING: no edges to invoke foo()" << std::endl;
+  }
+  // trial deletion of buffered candidates (before pool destruction)
+  gpair.first.getContext()->collect();
+}
+
+}  // namespace cycles_example4_rc
+
 namespace gcpp_example1 {
 
 deferred_ptr<Node> init_long_rptr(
@@ -318,6 +488,20 @@ int main() {
 
   // =====================================
 
+  std::cout << "cycles_example3 with adaptive collection" << std::endl;
+  c = high_resolution_clock::now();
+  {
+    // many things...
+    cycles_example1::test_main_long_rptr(V, E, SEED, true);
+  }
+  // will not leak
+  std::cout
+      << "cycles example3 (adaptive) "
+      << duration<double, std::milli>(high_resolution_clock::now() - c).count()
+      << "ms" << std::endl;
+
+  // =====================================
+
   std::cout << "cycles_example4 with arena (no leaks expected (hopefully!) due "
                "to relation_ptr)"
             << std::endl;
@@ -348,6 +532,57 @@ int main() {
 
   // =====================================
 
+  std::cout << "example6 with tracing forest (DynowForestTrace)" << std::endl;
+  c = high_resolution_clock::now();
+  {
+    // many things...
+    cycles_example3_trace::test_main_long_rptr(V, E, SEED, 1);
+  }
+  // will not leak
+  std::cout
+      << "example6 (tracing forest) "
+      << duration<double, std::milli>(high_resolution_clock::now() - c).count()
+      << "ms" << std::endl;
+
+  // =====================================
+
+  int nthreads = std::max(2u, std::thread::hardware_concurrency());
+  std::cout << "example7 with tracing forest (parallel mark, threads="
+            << nthreads << ")" << std::endl;
+  c = high_resolution_clock::now();
+  {
+    // many things...
+    cycles_example3_trace::test_main_long_rptr(V, E, SEED, nthreads);
+  }
+  // will not leak
+  std::cout
+      << "example7 (tracing forest, parallel mark) "
+      << duration<double, std::milli>(high_resolution_clock::now() - c).count()
+      << "ms" << std::endl;
+
+  // =====================================
+
+  std::cout << "example8 with reference counting forest (DynowForestRC)"
+            << std::endl;
+  c = high_resolution_clock::now();
+  {
+    // many things... (trial deletion on every 1024 candidates)
+    cycles_example4_rc::test_main_long_rptr(V, E, SEED, 1024);
+  }
+  // will not leak
+  std::cout
+      << "example8 (reference counting forest) "
+      << duration<double, std::milli>(high_resolution_clock::now() - c).count()
+      << "ms" << std::endl;
+
+  // =====================================
+
+#ifdef CYCLES_TRACE_EVENTS
+  // open on chrome://tracing or https://ui.perfetto.dev
+  if (EventTraceBuffer::global().dump_json("long_bench_graph.trace.json"))
+    std::cout << "event trace: long_bench_graph.trace.json" << std::endl;
+#endif
+
   std::cout << std::endl;
   std::cout << "SHOULD LEAK ONLY ON: rust_example1::test_main1()" << std::endl;
   std::cout << "FINISHED!" << std::endl;
@@ -0,0 +1,89 @@
+// C++
+#include <iostream>
+#include <string>
+#include <vector>
+//
+#include "BenchReport.hpp"
+#include "Workloads.hpp"
+
+// ==================================================
+// macro benchmark: lists, trees and graphs (sweeps)
+// ==================================================
+// Each experiment runs a workload of Workloads.hpp (build and complete
+// teardown) on every strategy: unique_ptr, shared_ptr, arena, relation_ptr
+// on each forest and gcpp (when submodule is available).
+//
+// Examples:
+//   ./macro_bench --quick --format csv
+//   ./macro_bench --suite graph --impl relation_ptr --reps 9 --out g.json
+// Sizes run in increasing order, so a strategy is dropped from the rest of a
+// sweep once its median is over --budget-ms.
+//
+// When built with -DBENCH_COUNT_ALLOCS, every result also reports heap
+// allocations and bytes per created node (make), per extra relation (link,
+// e.g., get_owned on graphs) and per destroyed node (destroy). Timings of
+// this build include counting overhead.
+
+int main(int argc, char** argv) {
+  bench::BenchOptions opts;
+  if (!bench::parseOptions(argc, argv, opts)) return 1;
+  bench::BenchReport report{opts};
+  const bool quick = opts.quick;
+
+  // lists: 1e3 .. 1e7 nodes
+  std::vector<long> list_sizes{1'000, 10'000, 100'000, 1'000'000, 10'000'000};
+  if (quick) list_sizes = {1'000, 10'000, 100'000};
+  for (long n : list_sizes) {
+    macro_list::impls([&](const std::string& impl, auto f) {
+      if (report.selected("list", impl))
+        phase::report(report.measure("list", impl, n, n - 1, [&]() { f(n); }));
+    });
+  }
+
+  // trees: 2^10 .. 2^22 nodes
+  std::vector<int> tree_heights{10, 12, 14, 16, 18, 20, 22};
+  if (quick) tree_heights = {10, 12, 14};
+  for (int h : tree_heights) {
+    long n = (1L << h) - 1;
+    macro_tree::impls([&](const std::string& impl, auto f) {
+      if (report.selected("tree", impl))
+        phase::report(report.measure("tree", impl, n, n - 1, [&]() { f(h); }));
+    });
+  }
+
+  // graphs: V vertices and E = V*V*density random edges (before dedup)
+  std::vector<int> graph_sizes{100, 250, 500, 1000};
+  std::vector<double> densities{0.05, 0.2, 0.6};
+  if (quick) {
+    graph_sizes = {100, 250};
+    densities = {0.05, 0.2};
+  }
+  const int SEED = 999999;
+  for (int v : graph_sizes) {
+    for (double density : densities) {
+      auto v_index = gen_experiment(v, static_cast<int>(v * v * density), SEED);
+      long e = count_edges(v_index);
+      macro_graph::impls([&](const std::string& impl, auto f) {
+        if (report.selected("graph", impl))
+          phase::report(
+              report.measure("graph", impl, v, e, [&]() { f(v_index); }));
+      });
+    }
+  }
+
+  // scalars: 1e3 .. 1e7 objects (no relations among them)
+  std::vector<long> sptr_sizes{1'000, 10'000, 100'000, 1'000'000, 10'000'000};
+  if (quick) sptr_sizes = {1'000, 10'000, 100'000};
+  for (long n : sptr_sizes) {
+    macro_sptr::impls([&](const std::string& impl, auto f) {
+      if (report.selected("sptr", impl))
+        phase::report(report.measure("sptr", impl, n, 0, [&]() { f(n); }));
+    });
+  }
+
+  if (!report.write()) {
+    std::cerr << "cannot write report: " << opts.out << std::endl;
+    return 1;
+  }
+  return 0;
+}
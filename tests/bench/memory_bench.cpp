@@ -0,0 +1,179 @@
+// C++
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+//
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+//
+// heap bytes come from global operator new/delete counters
+#define BENCH_COUNT_ALLOCS 1
+#include "BenchReport.hpp"
+#include "Workloads.hpp"
+
+// ====================================================
+// memory benchmark: bytes per node and per relation
+// ====================================================
+// Each experiment runs a workload of Workloads.hpp in a forked child, so
+// peak RSS of the child (wait4) only belongs to that workload. Reported
+// columns, besides build and teardown time of the child:
+// - rss_kb: peak RSS over an idle child (page granularity, allocator slack)
+// - node_bytes: live heap per node after nodes are created (lists and trees
+//   create nodes already owned, so this includes their relation)
+// - edge_bytes: live heap per extra relation (graphs: get_owned)
+// - for DynowForestV1, breakdown per node of live heap (memory_report):
+//   obj_bytes (user objects), tnode_bytes (TNode + TNodeData), tree_bytes
+//   (Tree + forest map entry), link_bytes (children, owns and owned_by),
+//   and other_bytes (shared_ptr control blocks, containers of workload)
+//
+// Examples:
+//   ./memory_bench --quick --format csv
+//   ./memory_bench --suite graph --impl relation_ptr --out graph_mem.json
+
+// measured in child process (plain data, sent through a pipe)
+struct Footprint {
+  double elapsed_ms{0};
+  long node_bytes{0};
+  long edge_bytes{0};
+  phase::ForestBytes forest;
+};
+
+long live_bytes(int p) {
+  return phase::marks[p].allocated - phase::marks[p].freed;
+}
+
+// runs f() in a child process. Returns false if child failed.
+template <class F>
+bool run_isolated(const F& f, Footprint& fp, long& rss_kb) {
+  int fd[2];
+  if (pipe(fd) != 0) return false;
+  pid_t pid = fork();
+  if (pid < 0) return false;
+  if (pid == 0) {
+    close(fd[0]);
+    Footprint out;
+    phase::inspect_forest = true;
+    using namespace std::chrono;  // NOLINT
+    auto c = steady_clock::now();
+    f();
+    out.elapsed_ms = duration<double, std::milli>(steady_clock::now() - c)
+                         .count();
+    out.node_bytes = live_bytes(phase::MADE) - live_bytes(phase::BEGIN);
+    out.edge_bytes = live_bytes(phase::LINKED) - live_bytes(phase::MADE);
+    out.forest = phase::forest_bytes;
+    bool ok = write(fd[1], &out, sizeof(out)) == sizeof(out);
+    close(fd[1]);
+    _exit(ok ? 0 : 1);
+  }
+  close(fd[1]);
+  bool ok = read(fd[0], &fp, sizeof(fp)) == sizeof(fp);
+  close(fd[0]);
+  int status = 0;
+  struct rusage ru {};
+  if (wait4(pid, &status, 0, &ru) != pid) return false;
+  rss_kb = ru.ru_maxrss;
+  return ok && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+
+template <class F>
+void measure(bench::BenchReport& report, const std::string& suite,
+             const std::string& impl, long n, long e, const F& f) {
+  if (!report.selected(suite, impl)) return;
+  Footprint fp;
+  long rss_kb = 0;
+  long idle_kb = 0;
+  bool ok = true;
+  auto& r = report.measureTimed(suite, impl, n, e, [&]() {
+    Footprint idle;
+    ok = ok && run_isolated([]() {}, idle, idle_kb);
+    bench::PerfRegion region;  // child counts are added when it exits
+    ok = ok && run_isolated(f, fp, rss_kb);
+    return fp.elapsed_ms;
+  });
+  if (!ok) {
+    std::cerr << "child process failed: " << suite << " " << impl << std::endl;
+    return;
+  }
+  auto per = [](long v, long k) { return k > 0 ? double(v) / k : 0.0; };
+  r.extras.emplace_back("rss_kb", rss_kb - idle_kb);
+  r.extras.emplace_back("node_bytes", per(fp.node_bytes, n));
+  r.extras.emplace_back("edge_bytes", per(fp.edge_bytes, e));
+  const auto& fb = fp.forest;
+  if (fb.nodes == 0) return;
+  long other = fp.node_bytes + fp.edge_bytes -
+               (fb.objects + fb.nodes + fb.trees + fb.links);
+  r.extras.emplace_back("obj_bytes", per(fb.objects, n));
+  r.extras.emplace_back("tnode_bytes", per(fb.nodes, n));
+  r.extras.emplace_back("tree_bytes", per(fb.trees, n));
+  r.extras.emplace_back("link_bytes", per(fb.links, n));
+  r.extras.emplace_back("other_bytes", per(other, n));
+}
+
+void print_layout() {
+  std::map<std::string, std::size_t> sizes{
+      {"relation_ptr<T>", sizeof(relation_ptr<int>)},
+      {"TArrowV1", sizeof(TArrowV1<TNodeData>)},
+      {"TNode (V1)", sizeof(TNode<TNodeData>)},
+      {"TNodeData", sizeof(TNodeData)},
+      {"Tree (V1)", sizeof(Tree<TNodeData>)},
+      {"shared_ptr", sizeof(sptr<int>)},
+      {"weak_ptr", sizeof(wptr<int>)}};
+  std::cerr << "layout (bytes):";
+  for (const auto& [name, size] : sizes)
+    std::cerr << " " << name << "=" << size;
+  std::cerr << std::endl;
+}
+
+int main(int argc, char** argv) {
+  bench::BenchOptions opts;
+  // footprint is deterministic: a single run per point by default
+  opts.reps = 1;
+  opts.warmup = 0;
+  if (!bench::parseOptions(argc, argv, opts)) return 1;
+  bench::BenchReport report{opts};
+  const bool quick = opts.quick;
+  print_layout();
+
+  std::vector<long> list_sizes{100'000, 1'000'000, 10'000'000};
+  if (quick) list_sizes = {10'000, 100'000};
+  for (long n : list_sizes) {
+    macro_list::impls([&](const std::string& impl, auto f) {
+      measure(report, "list", impl, n, 0, [&]() { f(n); });
+    });
+  }
+
+  std::vector<int> tree_heights{14, 18, 22};
+  if (quick) tree_heights = {12, 14};
+  for (int h : tree_heights) {
+    long n = (1L << h) - 1;
+    macro_tree::impls([&](const std::string& impl, auto f) {
+      measure(report, "tree", impl, n, 0, [&]() { f(h); });
+    });
+  }
+
+  std::vector<int> graph_sizes{250, 500, 1000};
+  std::vector<double> densities{0.05, 0.2, 0.6};
+  if (quick) {
+    graph_sizes = {100, 250};
+    densities = {0.05, 0.2};
+  }
+  const int SEED = 999999;
+  for (int v : graph_sizes) {
+    for (double density : densities) {
+      auto v_index = gen_experiment(v, static_cast<int>(v * v * density), SEED);
+      long e = count_edges(v_index);
+      macro_graph::impls([&](const std::string& impl, auto f) {
+        measure(report, "graph", impl, v, e, [&]() { f(v_index); });
+      });
+    }
+  }
+
+  if (!report.write()) {
+    std::cerr << "cannot write report: " << opts.out << std::endl;
+    return 1;
+  }
+  return 0;
+}
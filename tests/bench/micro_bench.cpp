@@ -0,0 +1,221 @@
+// C++
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+//
+#include <cycles/detail/rc/DynowForestRC.hpp>
+#include <cycles/detail/trace/DynowForestTrace.hpp>
+#include <cycles/relation_ptr.hpp>
+//
+#include "BenchReport.hpp"
+
+// =======================================================
+// micro benchmark: each IDynowForest operation, in ns/op
+// =======================================================
+// Operations are invoked directly on a forest (no relation_ptr), around a
+// fixture: a chain of 'depth' nodes from a root, where last node (target)
+// has 'fanout' children. Only the operations are timed: setup and cleanup
+// (e.g., removing arrows created by op2) are left out.
+//
+// Any forest with IDynowForest<TArrowV1<TNodeData>> interface can be added
+// to main() with run_forest<DOF>(...).
+//
+// Examples:
+//   ./micro_bench --quick --format csv
+//   ./micro_bench --suite op4 --impl DynowForestV1 --reps 9
+
+using namespace cycles;  // NOLINT
+
+template <class F>
+double time_ms(F f) {
+  using namespace std::chrono;  // NOLINT
+  bench::PerfRegion region;
+  auto c = steady_clock::now();
+  f();
+  return duration<double, std::milli>(steady_clock::now() - c).count();
+}
+
+template <class DOF>
+class OpFixture {
+ public:
+  using Arrow = typename DOF::DynowArrowType;
+  using Data = typename DOF::DynowDataType;
+
+  sptr<DOF> forest;
+  Arrow root;
+  // owned arrows from root to target (depth - 1)
+  std::vector<Arrow> chain;
+  // owned arrows from target
+  std::vector<Arrow> children;
+
+  OpFixture(int depth, int fanout, bool adaptive) : forest{new DOF{}} {
+    if constexpr (std::is_same_v<DOF, DynowForestV1>)
+      forest->setAdaptive(adaptive);
+    root = forest->op1_addNodeToNewTree(data(0));
+    for (int i = 1; i < depth; i++)
+      chain.push_back(forest->op2_addChildStrong(target(), data(i)));
+    children = addChildren(fanout);
+  }
+
+  ~OpFixture() { forest->destroyAll(); }
+
+  const Arrow& target() const { return chain.empty() ? root : chain.back(); }
+
+  static Data data(int v) { return TNodeData::make_sptr(new int{v}); }
+
+  static std::vector<Data> makeData(int n) {
+    std::vector<Data> v;
+    v.reserve(n);
+    for (int i = 0; i < n; i++) v.push_back(data(i));
+    return v;
+  }
+
+  // new strong children of target
+  std::vector<Arrow> addChildren(int n) {
+    std::vector<Arrow> arrows;
+    arrows.reserve(n);
+    for (int i = 0; i < n; i++)
+      arrows.push_back(forest->op2_addChildStrong(target(), data(i)));
+    return arrows;
+  }
+
+  void removeAll(std::vector<Arrow>& arrows) {
+    for (auto& arrow : arrows)
+      if (!arrow.is_null()) forest->op4_remove(arrow);
+    arrows.clear();
+  }
+};
+
+// one sample of an operation: ops invocations, returns elapsed ms
+template <class DOF>
+double run_op(const std::string& op, int depth, int fanout, bool adaptive,
+              int ops) {
+  OpFixture<DOF> fx{depth, fanout, adaptive};
+  auto& forest = *fx.forest;
+  using Arrow = typename OpFixture<DOF>::Arrow;
+  std::vector<Arrow> arrows;
+  arrows.reserve(ops);
+  double elapsed = 0;
+  if (op == "op0_getSharedData") {
+    long sink = 0;
+    elapsed = time_ms([&]() {
+      for (int i = 0; i < ops; i++)
+        sink += (forest.op0_getSharedData(fx.target()) != nullptr);
+    });
+    if (sink != ops) std::cerr << "op0: unexpected null data" << std::endl;
+  } else if (op == "op1_addNodeToNewTree") {
+    auto vdata = fx.makeData(ops);
+    elapsed = time_ms([&]() {
+      for (int i = 0; i < ops; i++)
+        arrows.push_back(forest.op1_addNodeToNewTree(std::move(vdata[i])));
+    });
+  } else if (op == "op2_addChildStrong") {
+    auto vdata = fx.makeData(ops);
+    elapsed = time_ms([&]() {
+      for (int i = 0; i < ops; i++)
+        arrows.push_back(
+            forest.op2_addChildStrong(fx.target(), std::move(vdata[i])));
+    });
+  } else if (op == "op3_weakSetOwnedBy") {
+    // back links: root is (weakly) owned by target
+    elapsed = time_ms([&]() {
+      for (int i = 0; i < ops; i++)
+        arrows.push_back(forest.op3_weakSetOwnedBy(fx.root, fx.target()));
+    });
+  } else if (op == "op4_remove_root") {
+    // unowned copies of new children of target (nodes survive removals)
+    auto owned = fx.addChildren(ops);
+    for (int i = 0; i < ops; i++)
+      arrows.push_back(forest.op5_copyNodeToNewTree(owned[i]));
+    elapsed = time_ms([&]() { fx.removeAll(arrows); });
+    fx.removeAll(owned);
+  } else if (op == "op4_remove_parent") {
+    // strong links from target (each removal destroys a child)
+    arrows = fx.addChildren(ops);
+    elapsed = time_ms([&]() { fx.removeAll(arrows); });
+  } else if (op == "op4_remove_weak") {
+    for (int i = 0; i < ops; i++)
+      arrows.push_back(forest.op3_weakSetOwnedBy(fx.root, fx.target()));
+    elapsed = time_ms([&]() { fx.removeAll(arrows); });
+  } else if (op == "op5_copyNodeToNewTree") {
+    // V1 only supports a single unowned copy of each owned node
+    auto owned = fx.addChildren(ops);
+    elapsed = time_ms([&]() {
+      for (int i = 0; i < ops; i++)
+        arrows.push_back(forest.op5_copyNodeToNewTree(owned[i]));
+    });
+    fx.removeAll(arrows);
+    fx.removeAll(owned);
+  } else if (op == "collect") {
+    // ops garbage 2-cycles (a <-> b) below a dropped root, besides live
+    // fixture (V1 only holds one pending removal without auto collect)
+    forest.setAutoCollect(false);
+    Arrow garbage = forest.op1_addNodeToNewTree(fx.data(-1));
+    for (int i = 0; i < ops; i++) {
+      Arrow a = forest.op2_addChildStrong(garbage, fx.data(i));
+      Arrow b = forest.op2_addChildStrong(a, fx.data(-i));
+      forest.op3_weakSetOwnedBy(a, b);
+    }
+    forest.op4_remove(garbage);
+    elapsed = time_ms([&]() { forest.collect(); });
+    forest.setAutoCollect(true);
+    return elapsed;
+  }
+  // cleanup (not timed)
+  fx.removeAll(arrows);
+  return elapsed;
+}
+
+template <class DOF>
+void run_forest(bench::BenchReport& report, const std::string& impl,
+                const std::vector<int>& depths,
+                const std::vector<int>& fanouts, int ops,
+                bool adaptive = false) {
+  const std::vector<std::string> all_ops{
+      "op0_getSharedData",  "op1_addNodeToNewTree", "op2_addChildStrong",
+      "op3_weakSetOwnedBy", "op4_remove_root",      "op4_remove_parent",
+      "op4_remove_weak",    "op5_copyNodeToNewTree", "collect"};
+  for (const auto& op : all_ops) {
+    if (!report.selected(op, impl)) continue;
+    for (int depth : depths) {
+      for (int fanout : fanouts) {
+        auto& r = report.measureTimed(op, impl, ops, 0, [&]() {
+          return run_op<DOF>(op, depth, fanout, adaptive, ops);
+        });
+        r.extras.emplace_back("depth", depth);
+        r.extras.emplace_back("fanout", fanout);
+        r.extras.emplace_back("ns_per_op", r.median() * 1e6 / ops);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  bench::BenchOptions opts;
+  if (!bench::parseOptions(argc, argv, opts)) return 1;
+  bench::BenchReport report{opts};
+
+  std::vector<int> depths{1, 64, 1024};
+  std::vector<int> fanouts{0, 64, 1024};
+  int ops = 10'000;
+  if (opts.quick) {
+    depths = {1, 64};
+    fanouts = {0, 64};
+    ops = 1'000;
+  }
+
+  run_forest<DynowForestV1>(report, "DynowForestV1", depths, fanouts, ops);
+  run_forest<DynowForestV1>(report, "DynowForestV1_adaptive", depths, fanouts,
+                            ops, true);
+  run_forest<DynowForestTrace>(report, "DynowForestTrace", depths, fanouts,
+                               ops);
+  run_forest<DynowForestRC>(report, "DynowForestRC", depths, fanouts, ops);
+
+  if (!report.write()) {
+    std::cerr << "cannot write report: " << opts.out << std::endl;
+    return 1;
+  }
+  return 0;
+}
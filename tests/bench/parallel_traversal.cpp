@@ -0,0 +1,162 @@
+// C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+//
+#include "BenchReport.hpp"
+#include "Workloads.hpp"
+
+// ====================================================
+// parallel traversal: scaling of reachability passes
+// ====================================================
+// Random graphs of gen_experiment (V vertices, E = V * degree edges) are
+// built once per forest, with a cycle over all vertices (so all of them are
+// reachable from vertex 0). Then relation_pool::parallel_for_each_reachable
+// visits the graph from vertex 0 with 1, 2, 4, ... threads (up to --threads,
+// default is hardware concurrency). Visitor does 'work' rounds of integer
+// hashing per node (an analytics pass) and stores it on a per-node result.
+// Reported: visited nodes, nodes per second and speedup over one thread.
+//
+// Examples:
+//   ./parallel_traversal --quick --format csv
+//   ./parallel_traversal --threads 16 --work 0 --impl DynowForestV1
+
+using namespace cycles;  // NOLINT
+
+struct ParallelConfig {
+  int max_threads{1};
+  int work{100};  // hashing rounds per visited node
+  std::vector<long> vertices{100'000, 1'000'000};
+  std::vector<int> degrees{2, 8};
+};
+
+template <class DOF>
+struct Node {
+  long v;
+  std::vector<relation_ptr<Node, DOF>> edges;
+  explicit Node(long _v) : v{_v} {}
+};
+
+// per-node work of visitor
+inline std::uint64_t hash_rounds(std::uint64_t x, int rounds) {
+  for (int r = 0; r < rounds; r++) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 29;
+  }
+  return x;
+}
+
+// 1, 2, 4, ... and max_threads
+inline std::vector<int> thread_counts(int max_threads) {
+  std::vector<int> counts;
+  for (int t = 1; t < max_threads; t *= 2) counts.push_back(t);
+  counts.push_back(max_threads);
+  return counts;
+}
+
+template <class DOF>
+void run_forest(bench::BenchReport& report, const ParallelConfig& cfg,
+                const std::string& impl) {
+  if (!report.selected("parallel", impl)) return;
+  for (long v : cfg.vertices) {
+    for (int degree : cfg.degrees) {
+      using Ptr = relation_ptr<Node<DOF>, DOF>;
+      auto v_index = gen_experiment(static_cast<int>(v),
+                                    static_cast<int>(v * degree), 999999);
+      relation_pool<DOF> pool;
+      std::vector<Ptr> vertex;
+      for (long i = 0; i < v; i++)
+        vertex.push_back(pool.template make<Node<DOF>>(i));
+      for (long i = 0; i < v; i++) {
+        vertex[i]->edges.push_back(vertex[(i + 1) % v].get_owned(vertex[i]));
+        for (int j : v_index[i])
+          vertex[i]->edges.push_back(vertex[j].get_owned(vertex[i]));
+      }
+      long e = v + count_edges(v_index);
+      std::cerr << impl << ": V=" << v << " E=" << e << std::endl;
+      // per-node results of visitor (no shared counters on timed region)
+      std::vector<std::uint64_t> result(v, 0);
+      long visited = 0;
+      pool.for_each_reachable(vertex[0], [&](const Node<DOF>&) { visited++; });
+      double base_ms = 0;
+      for (int threads : thread_counts(cfg.max_threads)) {
+        std::string name = impl + "_t" + std::to_string(threads);
+        if (!report.selected("parallel", name)) continue;
+        auto& r = report.measureTimed("parallel", name, v, e, [&]() {
+          using namespace std::chrono;  // NOLINT
+          bench::PerfRegion region;
+          auto c = steady_clock::now();
+          pool.parallel_for_each_reachable(
+              vertex[0],
+              [&](const Node<DOF>& node) {
+                result[node.v] = hash_rounds(node.v, cfg.work);
+              },
+              threads);
+          return duration<double, std::milli>(steady_clock::now() - c)
+              .count();
+        });
+        if (threads == 1) base_ms = r.median();
+        r.extras.emplace_back("threads", threads);
+        r.extras.emplace_back("visited", visited);
+        r.extras.emplace_back("nodes_per_s", visited / (r.median() / 1000.0));
+        r.extras.emplace_back("speedup",
+                              base_ms > 0 ? base_ms / r.median() : 0.0);
+      }
+      // teardown: one collection for whole graph
+      pool.setAutoCollect(false);
+      vertex.clear();
+      pool.getContext()->collect();
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  // own arguments: traversal configuration
+  ParallelConfig cfg;
+  cfg.max_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  std::vector<char*> args{argv[0]};
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = (i + 1 < argc);
+    if (arg == "--threads" && has_value)
+      cfg.max_threads = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "--work" && has_value)
+      cfg.work = std::max(0, std::atoi(argv[++i]));
+    else if (arg == "--vertices" && has_value)
+      cfg.vertices = {std::max(1L, std::atol(argv[++i]))};
+    else
+      args.push_back(argv[i]);
+  }
+  bench::BenchOptions opts;
+  if (!bench::parseOptions(static_cast<int>(args.size()), args.data(),
+                           opts)) {
+    std::cerr << "traversal options: [--threads MAX] [--work ROUNDS]"
+              << " [--vertices N]" << std::endl;
+    return 1;
+  }
+  if (opts.quick) {
+    cfg.vertices = {20'000};
+    cfg.degrees = {4};
+  }
+  std::cerr << "parallel traversal: threads<=" << cfg.max_threads
+            << " work=" << cfg.work << std::endl;
+
+  bench::BenchReport report{opts};
+  run_forest<DynowForestV1>(report, cfg, "DynowForestV1");
+  run_forest<DynowForestTrace>(report, cfg, "DynowForestTrace");
+  run_forest<DynowForestRC>(report, cfg, "DynowForestRC");
+
+  if (!report.write()) {
+    std::cerr << "cannot write report: " << opts.out << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -15,6 +15,26 @@
 
 // inspired from random bench for gcpp and tracked_ptr discussions
 
+// summary of adaptive per-tree statistics
+template <class Pool>
+void print_tree_stats(const Pool& pool) {
+  int n_eager = 0;
+  int n_deferred = 0;
+  int removals = 0;
+  int deferred_removals = 0;
+  for (const auto& st : pool.tree_stats()) {
+    if (st.mode == cycles::detail::TreeCollectMode::EAGER)
+      n_eager++;
+    else
+      n_deferred++;
+    removals += st.removals;
+    deferred_removals += st.deferred_removals;
+  }
+  std::cout << "tree_stats: EAGER=" << n_eager << " DEFERRED=" << n_deferred
+            << " removals=" << removals
+            << " deferred_removals=" << deferred_removals << std::endl;
+}
+
 int main() {
   using namespace std::chrono;  // NOLINT
   using namespace cycles;       // NOLINT
@@ -121,6 +141,36 @@ int main() {
 
   // ================================
 
+  std::cout << "populate CList with relation_ptr. adaptive collection!"
+            << std::endl;
+  c = high_resolution_clock::now();
+  if (true) {
+    CList list;
+    list.pool.setAdaptive(true);
+    //
+    int n = 0;
+    // initialize root
+    {
+      auto* node = new CListNode{.v = n++};  // NOLINT
+      list.entry = cycles::relation_ptr<CListNode>{node, list.pool};
+    }
+    //
+    cycles::relation_ptr<CListNode>* current = &list.entry;
+    //
+    while (n < nMaxList) {
+      auto* node_next = new CListNode{.v = n++};  // NOLINT
+      (*current)->next = cycles::relation_ptr<CListNode>{node_next, *current};
+      current = &((*current)->next);
+    }
+    print_tree_stats(list.pool);
+  }
+  std::cout
+      << "CList adaptive relation_ptr: "
+      << duration<double, std::milli>(high_resolution_clock::now() - c).count()
+      << "ms" << std::endl;
+
+  // ================================
+
   std::cout << "populate CList with relation_ptr. no auto_collect!"
             << std::endl;
   c = high_resolution_clock::now();
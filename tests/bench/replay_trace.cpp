@@ -0,0 +1,163 @@
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+//
+#include <cycles/detail/OpTrace.hpp>
+#include <cycles/detail/rc/DynowForestRC.hpp>
+#include <cycles/detail/trace/DynowForestTrace.hpp>
+#include <cycles/relation_ptr.hpp>
+//
+#include "AllocTracker.hpp"
+#include "BenchReport.hpp"
+
+// =================================================
+// replay of recorded relation_ptr workloads
+// =================================================
+// Traces come from relation_pool::start_recording(path), on any program.
+// Each forest re-executes trace (see OpTraceReplayer), reporting throughput
+// (replayed operations per second) and peak of heap bytes during replay.
+//
+// Examples:
+//   ./replay_trace --record churn.bin    (records built-in workload)
+//   ./replay_trace churn.bin --format csv
+//   ./replay_trace churn.bin --impl DynowForestRC --reps 9
+
+using namespace cycles;  // NOLINT
+
+// ========= built-in workload: edge churn on a random graph =========
+
+namespace churn {
+
+struct Node {
+  int v;
+  std::vector<relation_ptr<Node>> edges;
+  explicit Node(int _v) : v{_v} {}
+};
+
+// 'v' live vertices (unowned), with 'steps' random edge insertions and
+// removals, and occasional replacement of a vertex
+bool record(const std::string& path, int v, int steps, int seed) {
+  relation_pool<> pool;
+  if (!pool.start_recording(path)) return false;
+  srand(seed);
+  std::vector<relation_ptr<Node>> vertex;
+  for (int i = 0; i < v; i++) vertex.push_back(pool.make<Node>(i));
+  for (int s = 0; s < steps; s++) {
+    int i = ::rand() % v;
+    int j = ::rand() % v;
+    int action = ::rand() % 10;
+    if (action < 5) {
+      vertex[i]->edges.push_back(vertex[j].get_owned(vertex[i]));
+    } else if (action < 9) {
+      auto& edges = vertex[i]->edges;
+      if (!edges.empty()) {
+        std::swap(edges[::rand() % edges.size()], edges.back());
+        edges.pop_back();
+      }
+    } else {
+      vertex[i] = pool.make<Node>(v + s);
+    }
+  }
+  vertex.clear();
+  pool.getContext()->collect();
+  pool.stop_recording();
+  return true;
+}
+
+}  // namespace churn
+
+template <class DOF>
+void replay_forest(bench::BenchReport& report, const std::string& impl,
+                   const std::vector<OpRecord>& records,
+                   bool adaptive = false) {
+  if (!report.selected("replay", impl)) return;
+  long peak_bytes = 0;
+  ReplayStats stats;
+  auto& r = report.measureTimed("replay", impl, records.size(), 0, [&]() {
+    sptr<DOF> forest{new DOF{}};
+    if constexpr (std::is_same_v<DOF, DynowForestV1>)
+      forest->setAdaptive(adaptive);
+    double elapsed = 0;
+    {
+      OpTraceReplayer<DOF> replayer{forest};
+      long base = bench::AllocTracker::current().load();
+      bench::AllocTracker::resetPeak();
+      using namespace std::chrono;  // NOLINT
+      bench::PerfRegion region;
+      auto c = steady_clock::now();
+      stats = replayer.replay(records);
+      replayer.finish();
+      elapsed = duration<double, std::milli>(steady_clock::now() - c).count();
+      peak_bytes = std::max(peak_bytes,
+                            bench::AllocTracker::peak().load() - base);
+    }
+    return elapsed;
+  });
+  r.extras.emplace_back("ops_per_s", stats.ops / (r.median() / 1000.0));
+  r.extras.emplace_back("peak_bytes", peak_bytes);
+  r.extras.emplace_back("skipped", stats.skipped);
+  r.extras.emplace_back("mismatches", stats.mismatches);
+}
+
+int main(int argc, char** argv) {
+  // own arguments: trace file (first) and --record FILE
+  std::string trace_path;
+  std::string record_path;
+  std::vector<char*> args{argv[0]};
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (i == 1 && arg[0] != '-')
+      trace_path = arg;
+    else if (arg == "--record" && i + 1 < argc)
+      record_path = argv[++i];
+    else
+      args.push_back(argv[i]);
+  }
+  bench::BenchOptions opts;
+  if (!bench::parseOptions(static_cast<int>(args.size()), args.data(), opts))
+    return 1;
+
+  if (!record_path.empty()) {
+    int v = opts.quick ? 100 : 1000;
+    int steps = opts.quick ? 10'000 : 100'000;
+    if (!churn::record(record_path, v, steps, 999999)) {
+      std::cerr << "cannot record trace: " << record_path << std::endl;
+      return 1;
+    }
+    std::cerr << "recorded churn workload (V=" << v << " steps=" << steps
+              << ") on " << record_path << std::endl;
+    if (trace_path.empty()) return 0;
+  }
+  if (trace_path.empty()) {
+    std::cerr << "usage: " << argv[0] << " TRACE_FILE [options]" << std::endl
+              << "       " << argv[0] << " --record TRACE_FILE [--quick]"
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<OpRecord> records;
+  if (!OpTraceReader::read(trace_path, records)) {
+    std::cerr << "invalid trace file: " << trace_path << std::endl;
+    return 1;
+  }
+  std::cerr << "trace " << trace_path << ": " << records.size() << " records"
+            << std::endl;
+
+  bench::BenchReport report{opts};
+  replay_forest<DynowForestV1>(report, "DynowForestV1", records);
+  replay_forest<DynowForestV1>(report, "DynowForestV1_adaptive", records,
+                               true);
+  replay_forest<DynowForestTrace>(report, "DynowForestTrace", records);
+  replay_forest<DynowForestRC>(report, "DynowForestRC", records);
+
+  if (!report.write()) {
+    std::cerr << "cannot write report: " << opts.out << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,208 @@
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+//
+#include "BenchReport.hpp"
+#include "Workloads.hpp"
+
+// ====================================================
+// snapshot: startup from binary snapshot vs rebuild
+// ====================================================
+// Random graphs of gen_experiment (V vertices, E = V * degree edges, plus a
+// cycle over all vertices, so all of them are reachable from vertex 0) are
+// built on each forest by make and one get_owned per edge ('rebuild'), saved
+// with relation_pool::save_snapshot ('save') and loaded back into an empty
+// pool with relation_pool::load_snapshot ('load'). Teardown is not timed.
+// With change tracking, 1% of objects are marked changed and written with
+// relation_pool::checkpoint_delta ('checkpoint'), and that delta is folded
+// into base snapshot with compactSnapshot ('compact').
+// Reported: file size and objects per second of each phase.
+//
+// Examples:
+//   ./snapshot_bench --quick --format csv
+//   ./snapshot_bench --vertices 10000000 --impl DynowForestV1 --reps 1
+
+using namespace cycles;  // NOLINT
+
+struct SnapshotConfig {
+  std::string path{"snapshot_bench.bin"};
+  std::vector<long> vertices{100'000, 1'000'000};
+  std::vector<int> degrees{2, 8};
+};
+
+template <class DOF>
+struct Node {
+  long v;
+  std::vector<relation_ptr<Node, DOF>> edges;
+  explicit Node(long _v) : v{_v} {}
+};
+
+// payload of a node (edges are saved as relations)
+struct NodeImage {
+  long v;
+};
+
+inline double file_mb(const std::string& path) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  return in ? static_cast<double>(in.tellg()) / (1024.0 * 1024.0) : 0.0;
+}
+
+template <class DOF>
+void run_forest(bench::BenchReport& report, const SnapshotConfig& cfg,
+                const std::string& impl) {
+  if (!report.selected("snapshot", impl)) return;
+  using namespace std::chrono;  // NOLINT
+  using Ptr = relation_ptr<Node<DOF>, DOF>;
+  auto elapsed_ms = [](steady_clock::time_point c) {
+    return duration<double, std::milli>(steady_clock::now() - c).count();
+  };
+  auto teardown = [](relation_pool<DOF>& pool, auto& ptrs) {
+    pool.setAutoCollect(false);
+    ptrs.clear();
+    pool.getContext()->collect();
+  };
+  for (long v : cfg.vertices) {
+    for (int degree : cfg.degrees) {
+      auto v_index = gen_experiment(static_cast<int>(v),
+                                    static_cast<int>(v * degree), 999999);
+      long e = v + count_edges(v_index);
+      std::cerr << impl << ": V=" << v << " E=" << e << std::endl;
+      relation_pool<DOF> pool;
+      std::vector<Ptr> vertex;
+      auto build = [&]() {
+        for (long i = 0; i < v; i++)
+          vertex.push_back(pool.template make<Node<DOF>>(i));
+        for (long i = 0; i < v; i++) {
+          vertex[i]->edges.push_back(vertex[(i + 1) % v].get_owned(vertex[i]));
+          for (int j : v_index[i])
+            vertex[i]->edges.push_back(vertex[j].get_owned(vertex[i]));
+        }
+      };
+      auto& rb =
+          report.measureTimed("snapshot", impl + "_rebuild", v, e, [&]() {
+            auto c = steady_clock::now();
+            build();
+            double ms = elapsed_ms(c);
+            teardown(pool, vertex);
+            return ms;
+          });
+      rb.extras.emplace_back("nodes_per_s", v / (rb.median() / 1000.0));
+      build();
+      auto project = [](const Node<DOF>& n, const auto& link) {
+        for (auto& edge : n.edges) link(edge);
+        return NodeImage{n.v};
+      };
+      bool saved = true;
+      auto& sv = report.measureTimed("snapshot", impl + "_save", v, e, [&]() {
+        auto c = steady_clock::now();
+        saved = pool.save_snapshot(vertex[0], cfg.path, project) && saved;
+        return elapsed_ms(c);
+      });
+      sv.extras.emplace_back("file_mb", file_mb(cfg.path));
+      sv.extras.emplace_back("nodes_per_s", v / (sv.median() / 1000.0));
+      // checkpoint: 1% of objects changed since base snapshot
+      std::string delta_path = cfg.path + ".delta";
+      std::string compact_path = cfg.path + ".compact";
+      long changed = std::max(1L, v / 100);
+      pool.track_changes();
+      saved = pool.save_snapshot(vertex[0], cfg.path, project) && saved;
+      auto& cp =
+          report.measureTimed("snapshot", impl + "_checkpoint", v, e, [&]() {
+            for (long k = 0; k < changed; k++)
+              pool.mark_changed(vertex[(k * 7919) % v]);
+            std::ofstream out(delta_path, std::ios::binary | std::ios::trunc);
+            auto c = steady_clock::now();
+            saved = pool.checkpoint_delta(vertex[0], out, project) && saved;
+            out.close();
+            return elapsed_ms(c);
+          });
+      cp.extras.emplace_back("changed", changed);
+      cp.extras.emplace_back("file_mb", file_mb(delta_path));
+      pool.track_changes(false);
+      auto& cm =
+          report.measureTimed("snapshot", impl + "_compact", v, e, [&]() {
+            SnapshotImage base;
+            SnapshotDelta delta;
+            std::ifstream in(delta_path, std::ios::binary);
+            bool ok = base.open(cfg.path) && delta.read(in);
+            auto c = steady_clock::now();
+            saved = ok && compactSnapshot(base, {delta}, compact_path) && saved;
+            return elapsed_ms(c);
+          });
+      cm.extras.emplace_back("nodes_per_s", v / (cm.median() / 1000.0));
+      std::remove(delta_path.c_str());
+      std::remove(compact_path.c_str());
+      teardown(pool, vertex);
+      if (!saved) {
+        std::cerr << "cannot write snapshot: " << cfg.path << std::endl;
+        continue;
+      }
+      auto restore = [](const NodeImage& img, const auto& links) {
+        auto* n = new Node<DOF>(img.v);  // NOLINT
+        n->edges.reserve(links.size());
+        for (std::size_t k = 0; k < links.size(); k++)
+          n->edges.push_back(links(k));
+        return n;
+      };
+      std::vector<Ptr> loaded;
+      auto& ld = report.measureTimed("snapshot", impl + "_load", v, e, [&]() {
+        relation_pool<DOF> target;
+        auto c = steady_clock::now();
+        loaded.push_back(
+            target.template load_snapshot<Node<DOF>, NodeImage>(cfg.path,
+                                                                restore));
+        double ms = elapsed_ms(c);
+        teardown(target, loaded);
+        return ms;
+      });
+      ld.extras.emplace_back("nodes_per_s", v / (ld.median() / 1000.0));
+      std::remove(cfg.path.c_str());
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  // own arguments: graph sizes and snapshot file
+  SnapshotConfig cfg;
+  std::vector<char*> args{argv[0]};
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    bool has_value = (i + 1 < argc);
+    if (arg == "--vertices" && has_value)
+      cfg.vertices = {std::max(1L, std::atol(argv[++i]))};
+    else if (arg == "--degree" && has_value)
+      cfg.degrees = {std::max(0, std::atoi(argv[++i]))};
+    else if (arg == "--file" && has_value)
+      cfg.path = argv[++i];
+    else
+      args.push_back(argv[i]);
+  }
+  bench::BenchOptions opts;
+  if (!bench::parseOptions(static_cast<int>(args.size()), args.data(),
+                           opts)) {
+    std::cerr << "snapshot options: [--vertices N] [--degree D]"
+              << " [--file PATH]" << std::endl;
+    return 1;
+  }
+  if (opts.quick) {
+    cfg.vertices = {20'000};
+    cfg.degrees = {4};
+  }
+
+  bench::BenchReport report{opts};
+  run_forest<DynowForestV1>(report, cfg, "DynowForestV1");
+  run_forest<DynowForestTrace>(report, cfg, "DynowForestTrace");
+  run_forest<DynowForestRC>(report, cfg, "DynowForestRC");
+
+  if (!report.write()) {
+    std::cerr << "cannot write report: " << opts.out << std::endl;
+    return 1;
+  }
+  return 0;
+}